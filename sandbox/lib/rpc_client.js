@@ -0,0 +1,79 @@
+const net = require('net');
+
+// Connection, model loading and request helpers shared by the sandbox tests
+const SOCKET_PATH = '/tmp/rkllm.sock';
+const MODEL_PATH = './models/qwen2vl2b/Qwen2-VL-2B-Instruct.rkllm';
+
+function connect() {
+    const client = net.createConnection(SOCKET_PATH);
+    const waiters = [];
+    let buffer = '';
+
+    client.on('data', data => {
+        buffer += data.toString('utf8');
+        let newline;
+        while ((newline = buffer.indexOf('\n')) >= 0) {
+            const line = buffer.slice(0, newline);
+            buffer = buffer.slice(newline + 1);
+            if (!line.trim()) continue;
+            let message;
+            try { message = JSON.parse(line); } catch (e) { continue; }
+            waiters.slice().forEach(w => w(message));
+        }
+    });
+
+    const on = fn => {
+        waiters.push(fn);
+        return () => waiters.splice(waiters.indexOf(fn), 1);
+    };
+    return new Promise(r => client.on('connect', () => r({ client, on })));
+}
+
+// Loads the model with request id 1 and waits for its final init status
+async function waitForModel(conn, param = { max_new_tokens: 64 }) {
+    return new Promise((resolve, reject) => {
+        const off = conn.on(message => {
+            if (message.method === 'rkllm.init_status' && message.params.done) {
+                off();
+                message.params.state === 'ready' ? resolve() : reject(new Error(message.params.message));
+            } else if (message.id === 1 && message.error) {
+                off();
+                reject(new Error(message.error.message));
+            }
+        });
+        conn.client.write(JSON.stringify({
+            jsonrpc: '2.0', id: 1, method: 'rkllm.init',
+            params: { model_path: MODEL_PATH, param }
+        }) + '\n');
+    });
+}
+
+// Sends a request; rkllm.run resolves with the streamed text once the
+// final frame arrives, other methods with their result
+function send(conn, id, method, params) {
+    return new Promise(resolve => {
+        let text = '';
+        const off = conn.on(message => {
+            if (message.id !== id) return;
+            if (message.error) {
+                off();
+                resolve({ text, error: message.error });
+                return;
+            }
+            const result = message.result || {};
+            if (method !== 'rkllm.run') {
+                off();
+                resolve({ result });
+                return;
+            }
+            text += result.text || '';
+            if (result._callback_state >= 2) {
+                off();
+                resolve({ text, finish_reason: result.finish_reason });
+            }
+        });
+        conn.client.write(JSON.stringify({ jsonrpc: '2.0', id, method, params }) + '\n');
+    });
+}
+
+module.exports = { connect, waitForModel, send };
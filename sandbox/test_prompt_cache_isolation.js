@@ -0,0 +1,60 @@
+const { connect, waitForModel, send } = require('./lib/rpc_client');
+
+// Two runs with different user prompts share one chat template prefix and
+// therefore one automatic prompt cache: the second run must start from the
+// template alone and never see the first run's prompt. With greedy decoding
+// its answer must also match the same prompt run before any cache existed,
+// so the cache holds nothing beyond the system prompt and prefix
+
+async function testPromptCacheIsolation() {
+    const conn = await connect();
+    await waitForModel(conn, { max_new_tokens: 64, top_k: 1 });
+    console.log('✅ Model ready');
+
+    const template = await send(conn, 2, 'rkllm.set_chat_template', {
+        template_config: {
+            system_prompt: '<|im_start|>system\nYou are a helpful assistant. Answer in one short sentence.<|im_end|>\n',
+            prompt_prefix: '<|im_start|>user\n',
+            prompt_postfix: '<|im_end|>\n<|im_start|>assistant\n'
+        }
+    });
+    if (template.error) throw new Error(template.error.message);
+    console.log('✅ Chat template set');
+
+    // Setting the template released any cache, and this run loads none
+    const question = 'Did I tell you a password earlier? Repeat it if so, otherwise say NONE.';
+    const uncached = await send(conn, 3, 'rkllm.run', { prompt: question, prompt_cache: false });
+    console.log(`\n📤 before any cache → ${JSON.stringify(uncached.text)}`);
+
+    const secret = 'PAPAYA';
+    const first = await send(conn, 4, 'rkllm.run', {
+        prompt: `Remember the password ${secret} and repeat it back to me.`
+    });
+    console.log(`📤 first run → ${JSON.stringify(first.text)}`);
+
+    const second = await send(conn, 5, 'rkllm.run', { prompt: question });
+    console.log(`📤 second run → ${JSON.stringify(second.text)}`);
+
+    let failures = 0;
+    const error = uncached.error || first.error || second.error;
+    if (error) {
+        failures++;
+        console.log(`❌ ${error.message}`);
+    } else if (second.text.toUpperCase().includes(secret)) {
+        failures++;
+        console.log('❌ The second run saw the first run\'s prompt through the prompt cache');
+    } else if (second.text !== uncached.text) {
+        failures++;
+        console.log('❌ The cached prefix changed the answer; it holds more than the system prompt and prefix');
+    } else {
+        console.log('✅ The second run started from the chat template alone');
+    }
+
+    conn.client.end();
+    process.exit(failures ? 1 : 0);
+}
+
+testPromptCacheIsolation().catch(e => {
+    console.error('❌', e.message);
+    process.exit(1);
+});
@@ -0,0 +1,43 @@
+const { connect, waitForModel, send } = require('./lib/rpc_client');
+
+// Stop sequences made of multibyte characters: the runtime may deliver
+// such a character over several callbacks (RKLLM_RUN_WAITING), and the
+// stop sequence must still be found and never reach the client
+
+async function testStopSequences() {
+    const conn = await connect();
+    await waitForModel(conn);
+    console.log('✅ Model ready');
+
+    const cases = [
+        { prompt: '请用中文从一数到十，用顿号分隔。', stop: ['五'] },
+        { prompt: '请用中文从一数到十，用顿号分隔。', stop: ['、六'] },
+        { prompt: 'Reply with three smiling face emoji and nothing else.', stop: ['😊'] },
+    ];
+
+    let failures = 0;
+    let id = 2;
+    for (const c of cases) {
+        const reply = await send(conn, id++, 'rkllm.run', { prompt: c.prompt, stop: c.stop });
+        console.log(`\n📤 stop=${JSON.stringify(c.stop)} → ${JSON.stringify(reply.text)} (${reply.finish_reason || 'no finish_reason'})`);
+
+        const leaked = c.stop.some(s => reply.text.includes(s));
+        const broken = reply.text.includes('�');
+        if (reply.error || leaked || broken) {
+            failures++;
+            console.log(`❌ ${reply.error ? reply.error.message : leaked ? 'stop sequence reached the client' : 'split character in output'}`);
+        } else if (reply.finish_reason !== 'stop') {
+            console.log('⚠️  Model never produced the stop sequence');
+        } else {
+            console.log('✅ Stopped before the stop sequence');
+        }
+    }
+
+    conn.client.end();
+    process.exit(failures ? 1 : 0);
+}
+
+testStopSequences().catch(e => {
+    console.error('❌', e.message);
+    process.exit(1);
+});
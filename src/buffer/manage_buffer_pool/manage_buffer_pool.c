@@ -0,0 +1,113 @@
+#include "manage_buffer_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define MIN_CLASS_SHIFT 12   // 4 KiB
+#define MAX_CLASS_SHIFT 20   // 1 MiB
+#define CLASS_COUNT (MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1)
+#define DEFAULT_MAX_CACHED_BYTES (16 * 1024 * 1024)
+
+typedef struct PoolBlock {
+    struct PoolBlock* next;
+} PoolBlock;
+
+static PoolBlock* free_lists[CLASS_COUNT];
+static BufferPoolStats pool_stats = {0, DEFAULT_MAX_CACHED_BYTES, 0, 0};
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Gets the smallest size class holding size bytes
+ * @return Class index or -1 if size is above the largest class
+ */
+static int get_size_class(size_t size) {
+    int shift = MIN_CLASS_SHIFT;
+    while (shift <= MAX_CLASS_SHIFT && ((size_t)1 << shift) < size) {
+        shift++;
+    }
+    return shift <= MAX_CLASS_SHIFT ? shift - MIN_CLASS_SHIFT : -1;
+}
+
+void init_buffer_pool(size_t max_cached_bytes) {
+    pthread_mutex_lock(&pool_lock);
+    pool_stats.max_cached_bytes = max_cached_bytes;
+    pthread_mutex_unlock(&pool_lock);
+}
+
+void* acquire_pool_buffer(size_t min_size, size_t* block_size) {
+    int size_class = get_size_class(min_size);
+    if (size_class < 0) {
+        // Large payloads are rare; borrow them straight from the heap
+        if (block_size) {
+            *block_size = min_size;
+        }
+        return malloc(min_size);
+    }
+    
+    size_t size = (size_t)1 << (size_class + MIN_CLASS_SHIFT);
+    if (block_size) {
+        *block_size = size;
+    }
+    
+    pthread_mutex_lock(&pool_lock);
+    PoolBlock* block = free_lists[size_class];
+    if (block) {
+        free_lists[size_class] = block->next;
+        pool_stats.cached_bytes -= size;
+        pool_stats.hits++;
+    } else {
+        pool_stats.misses++;
+    }
+    pthread_mutex_unlock(&pool_lock);
+    
+    return block ? (void*)block : malloc(size);
+}
+
+void release_pool_buffer(void* data, size_t block_size) {
+    if (!data) {
+        return;
+    }
+    
+    int size_class = get_size_class(block_size);
+    if (size_class < 0 || ((size_t)1 << (size_class + MIN_CLASS_SHIFT)) != block_size) {
+        free(data);
+        return;
+    }
+    
+    pthread_mutex_lock(&pool_lock);
+    if (pool_stats.cached_bytes + block_size <= pool_stats.max_cached_bytes) {
+        PoolBlock* block = (PoolBlock*)data;
+        block->next = free_lists[size_class];
+        free_lists[size_class] = block;
+        pool_stats.cached_bytes += block_size;
+        data = NULL;
+    }
+    pthread_mutex_unlock(&pool_lock);
+    
+    free(data);
+}
+
+void get_buffer_pool_stats(BufferPoolStats* stats) {
+    if (!stats) {
+        return;
+    }
+    
+    pthread_mutex_lock(&pool_lock);
+    *stats = pool_stats;
+    pthread_mutex_unlock(&pool_lock);
+}
+
+void destroy_buffer_pool(void) {
+    pthread_mutex_lock(&pool_lock);
+    for (int i = 0; i < CLASS_COUNT; i++) {
+        PoolBlock* block = free_lists[i];
+        while (block) {
+            PoolBlock* next = block->next;
+            free(block);
+            block = next;
+        }
+        free_lists[i] = NULL;
+    }
+    pool_stats.cached_bytes = 0;
+    pthread_mutex_unlock(&pool_lock);
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef MANAGE_BUFFER_POOL_H
+#define MANAGE_BUFFER_POOL_H
+
+#include <stddef.h>
+
+/**
+ * Buffer pool statistics
+ */
+typedef struct {
+    size_t cached_bytes;       // Bytes held in free lists
+    size_t max_cached_bytes;   // Cap on cached bytes
+    unsigned long hits;        // Acquisitions served from a free list
+    unsigned long misses;      // Acquisitions that had to allocate
+} BufferPoolStats;
+
+/**
+ * Sets how many bytes of released buffers the pool may keep for reuse.
+ * Buffers come in power-of-two size classes from 4 KiB to 1 MiB; larger
+ * requests are allocated exactly and freed on release.
+ * @param max_cached_bytes Cap on bytes kept in the free lists
+ */
+void init_buffer_pool(size_t max_cached_bytes);
+
+/**
+ * Takes a buffer of at least min_size bytes from the pool
+ * @param min_size Minimum usable size
+ * @param block_size Receives the actual size of the buffer
+ * @return Buffer pointer or NULL on allocation failure
+ */
+void* acquire_pool_buffer(size_t min_size, size_t* block_size);
+
+/**
+ * Returns a buffer to the pool
+ * @param data Buffer from acquire_pool_buffer (NULL is ignored)
+ * @param block_size Size reported by acquire_pool_buffer
+ */
+void release_pool_buffer(void* data, size_t block_size);
+
+/**
+ * Gets pool statistics
+ * @param stats Receives the current counters
+ */
+void get_buffer_pool_stats(BufferPoolStats* stats);
+
+/**
+ * Frees every cached buffer
+ */
+void destroy_buffer_pool(void);
+
+#endif
\ No newline at end of file
@@ -19,6 +19,18 @@
 #define DEFAULT_METHOD_NAME_LENGTH 128
 #define DEFAULT_INIT_TIMEOUT 5000
 #define DEFAULT_ASYNC_TIMEOUT 3000
+#define DEFAULT_IO_THREADS 2
+#define DEFAULT_MAX_REQUEST_SIZE (64 * 1024 * 1024)
+#define DEFAULT_OUTPUT_HIGH_WATER (1024 * 1024)
+#define DEFAULT_OUTPUT_STALL_TIMEOUT_MS 30000
+#define DEFAULT_BUFFER_POOL_SIZE (16 * 1024 * 1024)
+#define DEFAULT_NPU_QUEUE_SIZE 64
+#define DEFAULT_NPU_QUANTUM_MS 1000
+#define DEFAULT_MAX_MODELS 4
+#define DEFAULT_MODEL_MEMORY_BUDGET_MB 0
+#define DEFAULT_PROMPT_CACHE_MAX_MB 1024
+#define DEFAULT_IMAGE_CACHE_MB 64
+#define DEFAULT_IMAGE_CACHE_DISK_MB 1024
 
 /**
  * Gets integer value from environment variable with default fallback
@@ -58,6 +70,34 @@ static char* get_env_string(const char* env_name, const char* default_value) {
     return result;
 }
 
+/**
+ * Gets a JSON array from an environment variable: the value itself when it
+ * starts with '[', otherwise the path of a file holding the array
+ * @return 0 if unset or valid, -1 if the value is not a JSON array
+ */
+static int get_env_json_array(const char* env_name, json_object** out) {
+    *out = NULL;
+    const char* env_value = getenv(env_name);
+    if (!env_value || env_value[0] == '\0') {
+        return 0;
+    }
+    
+    const char* start = env_value;
+    while (*start == ' ' || *start == '\t' || *start == '\n') {
+        start++;
+    }
+    json_object* value = *start == '[' ? json_tokener_parse(start) : json_object_from_file(env_value);
+    if (!value || !json_object_is_type(value, json_type_array)) {
+        if (value) {
+            json_object_put(value);
+        }
+        return -1;
+    }
+    
+    *out = value;
+    return 0;
+}
+
 ServerConfig* get_server_config(void) {
     ServerConfig* config = malloc(sizeof(ServerConfig));
     if (!config) {
@@ -80,9 +120,56 @@ ServerConfig* get_server_config(void) {
     config->method_name_length = get_env_int("RKLLM_METHOD_NAME_LENGTH", DEFAULT_METHOD_NAME_LENGTH);
     config->init_timeout = get_env_int("RKLLM_INIT_TIMEOUT", DEFAULT_INIT_TIMEOUT);
     config->async_timeout = get_env_int("RKLLM_ASYNC_TIMEOUT", DEFAULT_ASYNC_TIMEOUT);
+    config->io_threads = get_env_int("RKLLM_IO_THREADS", DEFAULT_IO_THREADS);
+    config->max_request_size = get_env_int("RKLLM_MAX_REQUEST_SIZE", DEFAULT_MAX_REQUEST_SIZE);
+    config->output_high_water = get_env_int("RKLLM_OUTPUT_HIGH_WATER", DEFAULT_OUTPUT_HIGH_WATER);
+    config->output_stall_timeout_ms = get_env_int("RKLLM_OUTPUT_STALL_TIMEOUT_MS", DEFAULT_OUTPUT_STALL_TIMEOUT_MS);
+    config->buffer_pool_size = get_env_int("RKLLM_BUFFER_POOL_SIZE", DEFAULT_BUFFER_POOL_SIZE);
+    config->npu_queue_size = get_env_int("RKLLM_NPU_QUEUE_SIZE", DEFAULT_NPU_QUEUE_SIZE);
+    config->npu_quantum_ms = get_env_int("RKLLM_NPU_QUANTUM_MS", DEFAULT_NPU_QUANTUM_MS);
+    config->max_models = get_env_int("RKLLM_MAX_MODELS", DEFAULT_MAX_MODELS);
+    config->model_memory_budget_mb = get_env_int("RKLLM_MODEL_MEMORY_BUDGET_MB", DEFAULT_MODEL_MEMORY_BUDGET_MB);
+    config->prompt_cache_max_mb = get_env_int("RKLLM_PROMPT_CACHE_MAX_MB", DEFAULT_PROMPT_CACHE_MAX_MB);
+    config->image_cache_mb = get_env_int("RKLLM_IMAGE_CACHE_MB", DEFAULT_IMAGE_CACHE_MB);
+    config->image_cache_disk_mb = get_env_int("RKLLM_IMAGE_CACHE_DISK_MB", DEFAULT_IMAGE_CACHE_DISK_MB);
+    
+    config->prefetch_models = get_env_string("RKLLM_PREFETCH_MODELS", "");
+    config->prompt_cache_dir = get_env_string("RKLLM_PROMPT_CACHE_DIR", "");
+    config->image_cache_dir = get_env_string("RKLLM_IMAGE_CACHE_DIR", "");
+    
+    // A preload list that does not parse is a deployment error, not a default
+    if (get_env_json_array("RKLLM_PRELOAD_MODELS", &config->preload_models) != 0) {
+        free(config->socket_path);
+        free(config->prefetch_models);
+        free(config->prompt_cache_dir);
+        free(config->image_cache_dir);
+        free(config);
+        return NULL;
+    }
+    
+    // At least one I/O worker loop is required to serve clients
+    if (config->io_threads < 1) {
+        config->io_threads = 1;
+    }
+    
+    // Reads are offered at least buffer_size bytes of free space
+    if (config->buffer_size < 1) {
+        config->buffer_size = DEFAULT_BUFFER_SIZE;
+    }
+    if (config->max_request_size < config->buffer_size) {
+        config->max_request_size = config->buffer_size;
+    }
     
     // Validate socket_path allocation
-    if (!config->socket_path) {
+    if (!config->socket_path || !config->prefetch_models || !config->prompt_cache_dir ||
+        !config->image_cache_dir) {
+        if (config->preload_models) {
+            json_object_put(config->preload_models);
+        }
+        free(config->socket_path);
+        free(config->prefetch_models);
+        free(config->prompt_cache_dir);
+        free(config->image_cache_dir);
         free(config);
         return NULL;
     }
@@ -99,5 +186,21 @@ void free_server_config(ServerConfig* config) {
         free(config->socket_path);
     }
     
+    if (config->preload_models) {
+        json_object_put(config->preload_models);
+    }
+    
+    if (config->prefetch_models) {
+        free(config->prefetch_models);
+    }
+    
+    if (config->prompt_cache_dir) {
+        free(config->prompt_cache_dir);
+    }
+    
+    if (config->image_cache_dir) {
+        free(config->image_cache_dir);
+    }
+    
     free(config);
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef GET_SERVER_CONFIG_H
 #define GET_SERVER_CONFIG_H
 
+#include <json-c/json.h>
+
 /**
  * Server configuration structure
  */
@@ -20,6 +22,22 @@ typedef struct {
     int method_name_length;    // Maximum method name length
     int init_timeout;          // Initialization timeout
     int async_timeout;         // Async operation timeout
+    int io_threads;            // Number of epoll I/O worker threads
+    int max_request_size;      // Largest accepted request message in bytes
+    int output_high_water;     // Queued output bytes that pause token generation
+    int output_stall_timeout_ms; // How long generation waits for a stalled client
+    int buffer_pool_size;      // Bytes of released I/O buffers kept for reuse
+    int npu_queue_size;        // Requests that may wait for the NPU worker
+    int npu_quantum_ms;        // NPU time each connection gets per scheduling round
+    int max_models;            // Resident RKLLM models before the least recently used is evicted
+    int model_memory_budget_mb; // Estimated size of resident models in MiB (0 = no limit)
+    json_object* preload_models; // rkllm.init params of models loaded before serving (array or NULL)
+    char* prefetch_models;     // Colon-separated model files read into the page cache at startup
+    char* prompt_cache_dir;    // Directory of automatic prompt cache files ("" = disabled)
+    int prompt_cache_max_mb;   // Size of the prompt cache directory in MiB (0 = no limit)
+    int image_cache_mb;        // Image embeddings kept in memory in MiB (0 = table slots only)
+    char* image_cache_dir;     // Directory of image embedding cache files ("" = memory only)
+    int image_cache_disk_mb;   // Size of the image cache directory in MiB (0 = no limit)
 } ServerConfig;
 
 /**
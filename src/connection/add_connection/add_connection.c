@@ -1,18 +1,55 @@
 #include "add_connection.h"
-#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Grows the fd-indexed table so that fd has a slot; caller holds the lock
+ */
+static int reserve_slot(ConnectionManager* manager, int fd) {
+    if (fd < manager->table_size) {
+        return 0;
+    }
+    
+    int new_size = manager->table_size > 0 ? manager->table_size : 64;
+    while (new_size <= fd) {
+        new_size *= 2;
+    }
+    
+    Connection** table = realloc(manager->connections, (size_t)new_size * sizeof(Connection*));
+    if (!table) {
+        return -1;
+    }
+    
+    memset(table + manager->table_size, 0, (size_t)(new_size - manager->table_size) * sizeof(Connection*));
+    manager->connections = table;
+    manager->table_size = new_size;
+    return 0;
+}
 
 int add_connection(ConnectionManager* manager, Connection* conn) {
-    if (!manager || !conn || manager->count >= manager->max_connections) {
+    if (!manager || !conn || conn->fd < 0) {
+        return -1;
+    }
+    
+    pthread_mutex_lock(&manager->lock);
+    
+    if (manager->count >= manager->max_connections ||
+        reserve_slot(manager, conn->fd) != 0 ||
+        manager->connections[conn->fd] != NULL) {
+        pthread_mutex_unlock(&manager->lock);
         return -1;
     }
     
-    for (int i = 0; i < manager->max_connections; i++) {
-        if (manager->connections[i] == NULL) {
-            manager->connections[i] = conn;
-            manager->count++;
-            return 0;
-        }
+    // Generation 0 is never used so a zeroed event key matches nothing
+    manager->next_generation++;
+    if (manager->next_generation == 0) {
+        manager->next_generation = 1;
     }
+    conn->generation = manager->next_generation;
+    
+    manager->connections[conn->fd] = conn;
+    manager->count++;
     
-    return -1;
+    pthread_mutex_unlock(&manager->lock);
+    return 0;
 }
\ No newline at end of file
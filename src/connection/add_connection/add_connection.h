@@ -2,18 +2,23 @@
 #define ADD_CONNECTION_H
 
 #include "../create_connection/create_connection.h"
+#include <pthread.h>
 
 /**
  * Connection manager structure
  */
 typedef struct {
-    Connection** connections;   // Array of connection pointers
+    Connection** connections;   // Connection table indexed by fd
+    int table_size;            // Slots in the table (grows with the highest fd)
     int max_connections;       // Maximum connections
     int count;                 // Current connection count
+    unsigned int next_generation; // Last generation handed out
+    pthread_mutex_t lock;      // Guards the table across accept and I/O threads
 } ConnectionManager;
 
 /**
- * Adds connection to manager
+ * Adds connection to manager in the slot of its fd and tags it with a
+ * fresh generation
  * @param manager Connection manager
  * @param conn Connection to add
  * @return 0 on success, -1 on error
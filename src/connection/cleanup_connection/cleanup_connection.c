@@ -1,4 +1,7 @@
 #include "cleanup_connection.h"
+#include "../manage_output_queue/manage_output_queue.h"
+#include "../manage_connection_pool/manage_connection_pool.h"
+#include "../../buffer/manage_buffer_pool/manage_buffer_pool.h"
 #include <unistd.h>
 #include <stdlib.h>
 
@@ -11,5 +14,15 @@ void cleanup_connection(Connection* conn) {
         close(conn->fd);
     }
     
-    free(conn);
+    if (conn->tokener) {
+        json_tokener_free(conn->tokener);
+    }
+    release_pool_buffer(conn->buffer, conn->buffer_size);
+    
+    // Output nobody will flush any more
+    cancel_output(conn);
+    
+    pthread_cond_destroy(&conn->out_drained);
+    pthread_mutex_destroy(&conn->write_lock);
+    release_connection_slot(conn);
 }
\ No newline at end of file
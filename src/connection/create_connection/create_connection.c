@@ -1,17 +1,39 @@
 #include "create_connection.h"
+#include "../manage_connection_pool/manage_connection_pool.h"
 #include <stdlib.h>
-#include <string.h>
 
 Connection* create_connection(int fd) {
-    Connection* conn = malloc(sizeof(Connection));
+    Connection* conn = acquire_connection_slot();
     if (!conn) {
         return NULL;
     }
     
     conn->fd = fd;
+    conn->generation = 0;      // Assigned by add_connection
+    conn->buffer = NULL;       // Borrowed from the buffer pool while data is pending
+    conn->buffer_size = 0;
     conn->buffer_len = 0;
+    conn->frame_length = 0;
+    conn->message_bytes = 0;
+    conn->tokener = NULL;
     conn->is_active = 1;
-    memset(conn->buffer, 0, sizeof(conn->buffer));
+    conn->epoll_fd = -1;
+    conn->refcount = 1;  // Owned by the connection manager
+    conn->out_head = NULL;
+    conn->out_tail = NULL;
+    conn->out_bytes = 0;
+    conn->want_write = 0;
+    
+    if (pthread_mutex_init(&conn->write_lock, NULL) != 0) {
+        release_connection_slot(conn);
+        return NULL;
+    }
+    
+    if (pthread_cond_init(&conn->out_drained, NULL) != 0) {
+        pthread_mutex_destroy(&conn->write_lock);
+        release_connection_slot(conn);
+        return NULL;
+    }
     
     return conn;
 }
\ No newline at end of file
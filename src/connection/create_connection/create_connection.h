@@ -2,16 +2,42 @@
 #define CREATE_CONNECTION_H
 
 #include <stddef.h>
-#include "../../utils/constants/constants.h"
+#include <pthread.h>
+#include <json-c/json.h>
+
+/**
+ * Pending output bytes; chunks are flushed oldest first with one
+ * gather write per pass
+ */
+typedef struct OutputChunk {
+    struct OutputChunk* next;  // Next chunk in the queue
+    size_t capacity;           // Allocated bytes in data
+    size_t len;                // Bytes stored in data
+    size_t offset;             // Bytes already written to the socket
+    char data[];               // Chunk payload
+} OutputChunk;
 
 /**
  * Connection structure for managing client connections
  */
 typedef struct {
     int fd;                    // File descriptor
-    char buffer[CONNECTION_BUFFER_SIZE];  // Read buffer
-    size_t buffer_len;         // Current buffer length
-    int is_active;             // Connection active flag
+    unsigned int generation;   // Tag telling reuses of the same fd apart
+    char* buffer;              // Read buffer, grows for large frames
+    size_t buffer_size;        // Allocated read buffer size
+    size_t buffer_len;         // Received bytes not yet consumed by the framer
+    size_t frame_length;       // Pending length-prefixed payload size (0 = JSON stream)
+    size_t message_bytes;      // Bytes fed to the tokener for the current message
+    json_tokener* tokener;     // Incremental parser for the JSON stream
+    volatile int is_active;    // Connection active flag
+    int epoll_fd;              // Epoll instance of the owning I/O worker
+    int refcount;              // References held by workers and pending jobs
+    pthread_mutex_t write_lock; // Serializes writes from I/O and NPU threads
+    OutputChunk* out_head;     // Oldest queued output chunk
+    OutputChunk* out_tail;     // Newest queued output chunk
+    size_t out_bytes;          // Queued bytes not yet written
+    int want_write;            // EPOLLOUT armed on the worker epoll
+    pthread_cond_t out_drained; // Signalled when queued output shrinks or the peer goes away
 } Connection;
 
 /**
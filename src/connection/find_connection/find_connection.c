@@ -2,15 +2,29 @@
 #include <stddef.h>
 
 Connection* find_connection(ConnectionManager* manager, int fd) {
-    if (!manager) {
+    if (!manager || fd < 0) {
         return NULL;
     }
     
-    for (int i = 0; i < manager->max_connections; i++) {
-        if (manager->connections[i] && manager->connections[i]->fd == fd) {
-            return manager->connections[i];
-        }
+    Connection* found = NULL;
+    pthread_mutex_lock(&manager->lock);
+    
+    if (fd < manager->table_size) {
+        found = manager->connections[fd];
+    }
+    
+    pthread_mutex_unlock(&manager->lock);
+    return found;
+}
+
+Connection* find_connection_by_key(ConnectionManager* manager, uint64_t key) {
+    int fd = (int)(uint32_t)key;
+    unsigned int generation = (unsigned int)(key >> 32);
+    
+    Connection* found = find_connection(manager, fd);
+    if (found && found->generation != generation) {
+        return NULL;
     }
     
-    return NULL;
+    return found;
 }
\ No newline at end of file
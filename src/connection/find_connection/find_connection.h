@@ -2,6 +2,13 @@
 #define FIND_CONNECTION_H
 
 #include "../add_connection/add_connection.h"
+#include <stdint.h>
+
+/**
+ * Epoll event key for a connection: generation in the high half and fd
+ * in the low half, so a stale event for a reused fd matches nothing
+ */
+#define CONNECTION_EVENT_KEY(conn) (((uint64_t)(conn)->generation << 32) | (uint32_t)(conn)->fd)
 
 /**
  * Finds connection by file descriptor
@@ -11,4 +18,12 @@
  */
 Connection* find_connection(ConnectionManager* manager, int fd);
 
+/**
+ * Finds connection by epoll event key
+ * @param manager Connection manager
+ * @param key Key built with CONNECTION_EVENT_KEY
+ * @return Connection pointer or NULL if the fd is free or was reused
+ */
+Connection* find_connection_by_key(ConnectionManager* manager, uint64_t key);
+
 #endif
\ No newline at end of file
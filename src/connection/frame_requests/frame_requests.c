@@ -0,0 +1,293 @@
+#include "frame_requests.h"
+#include "../../buffer/manage_buffer_pool/manage_buffer_pool.h"
+#include "../../utils/log_message/log_message.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+#define CONTENT_LENGTH_PREFIX "Content-Length:"
+#define MAX_HEADER_LENGTH 64
+// Bounds the work done per readiness event so one client cannot starve
+// the others on the same loop; level-triggered epoll reports the rest
+#define MAX_READS_PER_EVENT 16
+
+typedef enum {
+    FRAME_NEED_MORE = 0,
+    FRAME_HEADER_OK = 1,
+    FRAME_HEADER_BAD = -1
+} FrameHeaderStatus;
+
+/**
+ * Parses a Content-Length header at the start of data
+ */
+static FrameHeaderStatus parse_frame_header(const char* data, size_t len,
+                                            size_t* payload_length, size_t* header_length) {
+    size_t prefix_len = strlen(CONTENT_LENGTH_PREFIX);
+    size_t cmp_len = len < prefix_len ? len : prefix_len;
+    if (strncasecmp(data, CONTENT_LENGTH_PREFIX, cmp_len) != 0) {
+        return FRAME_HEADER_BAD;
+    }
+    if (len < prefix_len) {
+        return FRAME_NEED_MORE;
+    }
+    
+    // Header ends at the first blank line ("\r\n\r\n" or "\n\n")
+    size_t end = 0;
+    for (size_t i = prefix_len; i < len && i < MAX_HEADER_LENGTH; i++) {
+        if (data[i] != '\n') {
+            continue;
+        }
+        if (i + 1 < len && data[i + 1] == '\n') {
+            end = i + 2;
+            break;
+        }
+        if (i + 2 < len && data[i + 1] == '\r' && data[i + 2] == '\n') {
+            end = i + 3;
+            break;
+        }
+    }
+    if (end == 0) {
+        return len < MAX_HEADER_LENGTH ? FRAME_NEED_MORE : FRAME_HEADER_BAD;
+    }
+    
+    size_t i = prefix_len;
+    while (data[i] == ' ' || data[i] == '\t') {
+        i++;
+    }
+    if (!isdigit((unsigned char)data[i])) {
+        return FRAME_HEADER_BAD;
+    }
+    
+    size_t value = 0;
+    while (isdigit((unsigned char)data[i])) {
+        value = value * 10 + (size_t)(data[i] - '0');
+        if (value > (size_t)1 << 40) {
+            return FRAME_HEADER_BAD;
+        }
+        i++;
+    }
+    
+    *payload_length = value;
+    *header_length = end;
+    return FRAME_HEADER_OK;
+}
+
+/**
+ * Skips to the byte after the next newline so a corrupt line does not
+ * poison the rest of a newline-delimited stream
+ */
+static size_t resync_after_error(const char* data, size_t pos, size_t len) {
+    const char* newline = memchr(data + pos, '\n', len - pos);
+    return newline ? (size_t)(newline - data) + 1 : len;
+}
+
+/**
+ * Dispatches every complete message in the buffer and compacts it
+ * @return 0 on success, -1 if the stream must be dropped
+ */
+static int process_buffer(Connection* conn, size_t max_message_size,
+                          FrameHandler handler, void* userdata) {
+    char* data = conn->buffer;
+    size_t len = conn->buffer_len;
+    size_t pos = 0;
+    
+    while (pos < len) {
+        if (conn->frame_length > 0) {
+            // Length-prefixed payload: wait until it is fully buffered
+            if (len - pos < conn->frame_length) {
+                break;
+            }
+            
+            json_tokener_reset(conn->tokener);
+            json_object* message = json_tokener_parse_ex(conn->tokener, data + pos, (int)conn->frame_length);
+            if (json_tokener_get_error(conn->tokener) != json_tokener_success) {
+                json_object_put(message);
+                message = NULL;
+            }
+            json_tokener_reset(conn->tokener);
+            
+            pos += conn->frame_length;
+            conn->frame_length = 0;
+            handler(conn, message, userdata);
+            json_object_put(message);
+            continue;
+        }
+        
+        if (conn->message_bytes == 0) {
+            // At a message boundary: skip separators and pick the framing
+            while (pos < len && isspace((unsigned char)data[pos])) {
+                pos++;
+            }
+            if (pos == len) {
+                break;
+            }
+            
+            if (data[pos] == 'C' || data[pos] == 'c') {
+                size_t payload_length = 0;
+                size_t header_length = 0;
+                FrameHeaderStatus status = parse_frame_header(data + pos, len - pos,
+                                                              &payload_length, &header_length);
+                if (status == FRAME_NEED_MORE) {
+                    break;
+                }
+                if (status == FRAME_HEADER_BAD) {
+                    LOG_WARN_MSG("Malformed frame header on fd=%d", conn->fd);
+                    handler(conn, NULL, userdata);
+                    pos = resync_after_error(data, pos, len);
+                    continue;
+                }
+                if (payload_length == 0 || payload_length > max_message_size) {
+                    LOG_ERROR_MSG("Rejecting %zu byte frame on fd=%d (limit %zu)",
+                                  payload_length, conn->fd, max_message_size);
+                    return -1;
+                }
+                
+                conn->frame_length = payload_length;
+                pos += header_length;
+                continue;
+            }
+        }
+        
+        // JSON stream: feed only the new bytes; the tokener keeps its state
+        // across calls so a multi-megabyte value is scanned exactly once
+        size_t chunk = len - pos;
+        if (conn->message_bytes + chunk > max_message_size) {
+            LOG_ERROR_MSG("Message on fd=%d exceeds %zu bytes", conn->fd, max_message_size);
+            return -1;
+        }
+        
+        json_object* message = json_tokener_parse_ex(conn->tokener, data + pos, (int)chunk);
+        enum json_tokener_error error = json_tokener_get_error(conn->tokener);
+        
+        if (error == json_tokener_continue) {
+            conn->message_bytes += chunk;
+            pos = len;
+            break;
+        }
+        
+        if (error != json_tokener_success) {
+            LOG_WARN_MSG("JSON parse error on fd=%d: %s", conn->fd, json_tokener_error_desc(error));
+            json_tokener_reset(conn->tokener);
+            conn->message_bytes = 0;
+            handler(conn, NULL, userdata);
+            pos = resync_after_error(data, pos, len);
+            continue;
+        }
+        
+        size_t consumed = json_tokener_get_parse_end(conn->tokener);
+        json_tokener_reset(conn->tokener);
+        conn->message_bytes = 0;
+        pos += consumed;
+        
+        handler(conn, message, userdata);
+        json_object_put(message);
+    }
+    
+    // Keep only unconsumed bytes (partial header or length-prefixed payload)
+    if (pos > 0) {
+        memmove(data, data + pos, len - pos);
+        conn->buffer_len = len - pos;
+    }
+    
+    return 0;
+}
+
+/**
+ * Makes room for the next recv; grows the buffer to hold a whole
+ * length-prefixed payload once its size is known
+ */
+static int reserve_buffer(Connection* conn, size_t read_size) {
+    size_t needed = conn->buffer_len + read_size;
+    if (conn->frame_length > 0 && conn->frame_length > needed) {
+        needed = conn->frame_length;
+    }
+    if (needed <= conn->buffer_size) {
+        return 0;
+    }
+    
+    size_t new_size = conn->buffer_size ? conn->buffer_size : read_size;
+    while (new_size < needed) {
+        new_size *= 2;
+    }
+    
+    char* new_buffer = acquire_pool_buffer(new_size, &new_size);
+    if (!new_buffer) {
+        return -1;
+    }
+    
+    if (conn->buffer_len > 0) {
+        memcpy(new_buffer, conn->buffer, conn->buffer_len);
+    }
+    release_pool_buffer(conn->buffer, conn->buffer_size);
+    
+    conn->buffer = new_buffer;
+    conn->buffer_size = new_size;
+    return 0;
+}
+
+/**
+ * Hands the read buffer back to the pool once everything in it has been
+ * consumed, so idle clients hold no buffer (and a big payload does not
+ * pin a big one)
+ */
+static void release_idle_buffer(Connection* conn) {
+    if (conn->buffer && conn->buffer_len == 0) {
+        release_pool_buffer(conn->buffer, conn->buffer_size);
+        conn->buffer = NULL;
+        conn->buffer_size = 0;
+    }
+}
+
+int frame_requests(Connection* conn, size_t read_size, size_t max_message_size,
+                   FrameHandler handler, void* userdata) {
+    if (!conn || !handler || read_size == 0) {
+        return -1;
+    }
+    
+    if (!conn->tokener) {
+        conn->tokener = json_tokener_new();
+        if (!conn->tokener) {
+            return -1;
+        }
+    }
+    
+    for (int reads = 0; reads < MAX_READS_PER_EVENT; reads++) {
+        if (reserve_buffer(conn, read_size) != 0) {
+            LOG_ERROR_MSG("Failed to grow read buffer for fd=%d", conn->fd);
+            return -1;
+        }
+        
+        ssize_t bytes_read = recv(conn->fd, conn->buffer + conn->buffer_len,
+                                  conn->buffer_size - conn->buffer_len, 0);
+        if (bytes_read == 0) {
+            LOG_INFO_MSG("Client disconnected: fd=%d", conn->fd);
+            return -1;
+        }
+        if (bytes_read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                release_idle_buffer(conn);
+                return 0;
+            }
+            LOG_ERROR_MSG("Read error on fd=%d: %s", conn->fd, strerror(errno));
+            return -1;
+        }
+        
+        conn->buffer_len += (size_t)bytes_read;
+        if (process_buffer(conn, max_message_size, handler, userdata) != 0) {
+            return -1;
+        }
+        
+        if (!conn->is_active) {
+            return -1;
+        }
+    }
+    
+    release_idle_buffer(conn);
+    return 0;
+}
\ No newline at end of file
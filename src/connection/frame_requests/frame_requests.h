@@ -0,0 +1,29 @@
+#ifndef FRAME_REQUESTS_H
+#define FRAME_REQUESTS_H
+
+#include "../create_connection/create_connection.h"
+#include <json-c/json.h>
+
+/**
+ * Called once per complete message; message is NULL for a frame
+ * that failed to parse. The framer releases the message afterwards.
+ */
+typedef void (*FrameHandler)(Connection* conn, json_object* message, void* userdata);
+
+/**
+ * Reads available bytes into the connection buffer and dispatches every
+ * complete message. Two framings are accepted on the same stream:
+ *   - JSON values back to back (newline-delimited or not), parsed
+ *     incrementally so partial data is never re-scanned
+ *   - "Content-Length: <n>\r\n\r\n" followed by an n-byte JSON payload
+ * @param conn Connection to read from (non-blocking fd)
+ * @param read_size Minimum free space offered to each recv call
+ * @param max_message_size Largest accepted message in bytes
+ * @param handler Message callback
+ * @param userdata Passed through to the handler
+ * @return 0 if the connection stays open, -1 on EOF, read error or oversized message
+ */
+int frame_requests(Connection* conn, size_t read_size, size_t max_message_size,
+                   FrameHandler handler, void* userdata);
+
+#endif
\ No newline at end of file
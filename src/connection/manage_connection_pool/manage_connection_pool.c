@@ -0,0 +1,80 @@
+#include "manage_connection_pool.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+static Connection* slab = NULL;
+static Connection** free_slots = NULL;
+static int slab_capacity = 0;
+static int free_count = 0;
+static pthread_mutex_t slab_lock = PTHREAD_MUTEX_INITIALIZER;
+
+int init_connection_pool(int capacity) {
+    if (capacity <= 0) {
+        return -1;
+    }
+    
+    Connection* objects = calloc((size_t)capacity, sizeof(Connection));
+    Connection** slots = malloc((size_t)capacity * sizeof(Connection*));
+    if (!objects || !slots) {
+        free(objects);
+        free(slots);
+        return -1;
+    }
+    
+    // Hand out low addresses first so a small server touches few pages
+    for (int i = 0; i < capacity; i++) {
+        slots[i] = &objects[capacity - 1 - i];
+    }
+    
+    pthread_mutex_lock(&slab_lock);
+    slab = objects;
+    free_slots = slots;
+    slab_capacity = capacity;
+    free_count = capacity;
+    pthread_mutex_unlock(&slab_lock);
+    
+    return 0;
+}
+
+Connection* acquire_connection_slot(void) {
+    Connection* conn = NULL;
+    
+    pthread_mutex_lock(&slab_lock);
+    if (free_count > 0) {
+        conn = free_slots[--free_count];
+    }
+    pthread_mutex_unlock(&slab_lock);
+    
+    return conn ? conn : malloc(sizeof(Connection));
+}
+
+void release_connection_slot(Connection* conn) {
+    if (!conn) {
+        return;
+    }
+    
+    pthread_mutex_lock(&slab_lock);
+    if (slab && conn >= slab && conn < slab + slab_capacity) {
+        free_slots[free_count++] = conn;
+        conn = NULL;
+    }
+    pthread_mutex_unlock(&slab_lock);
+    
+    free(conn);
+}
+
+void destroy_connection_pool(void) {
+    pthread_mutex_lock(&slab_lock);
+    // A connection still referenced at exit keeps the slab alive
+    if (free_count != slab_capacity) {
+        pthread_mutex_unlock(&slab_lock);
+        return;
+    }
+    free(slab);
+    free(free_slots);
+    slab = NULL;
+    free_slots = NULL;
+    slab_capacity = 0;
+    free_count = 0;
+    pthread_mutex_unlock(&slab_lock);
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef MANAGE_CONNECTION_POOL_H
+#define MANAGE_CONNECTION_POOL_H
+
+#include "../create_connection/create_connection.h"
+
+/**
+ * Preallocates a slab of connection objects
+ * @param capacity Number of objects in the slab
+ * @return 0 on success, -1 on error
+ */
+int init_connection_pool(int capacity);
+
+/**
+ * Takes an uninitialized connection object from the slab, falling back
+ * to the heap when the slab is exhausted or was never set up
+ * @return Connection pointer or NULL on allocation failure
+ */
+Connection* acquire_connection_slot(void);
+
+/**
+ * Returns a connection object to the slab (or the heap)
+ * @param conn Object from acquire_connection_slot
+ */
+void release_connection_slot(Connection* conn);
+
+/**
+ * Frees the slab; left in place if any object is still in use
+ */
+void destroy_connection_pool(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include "manage_output_queue.h"
+#include "../find_connection/find_connection.h"
+#include "../../buffer/manage_buffer_pool/manage_buffer_pool.h"
+#include "../../utils/log_message/log_message.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#define MAX_FLUSH_IOV 64
+
+/**
+ * Arms or disarms EPOLLOUT on the owning worker; caller holds write_lock
+ */
+static void set_write_interest(Connection* conn, int enable) {
+    if (conn->want_write == enable || conn->epoll_fd < 0) {
+        return;
+    }
+    
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = enable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    event.data.u64 = CONNECTION_EVENT_KEY(conn);
+    if (epoll_ctl(conn->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event) < 0) {
+        LOG_WARN_MSG("Failed to update write interest for fd=%d: %s", conn->fd, strerror(errno));
+        return;
+    }
+    
+    conn->want_write = enable;
+}
+
+/**
+ * Frees every queued chunk and wakes drain waiters; caller holds write_lock
+ */
+static void drop_queued_output(Connection* conn) {
+    OutputChunk* chunk = conn->out_head;
+    while (chunk) {
+        OutputChunk* next = chunk->next;
+        release_pool_buffer(chunk, sizeof(OutputChunk) + chunk->capacity);
+        chunk = next;
+    }
+    
+    conn->out_head = NULL;
+    conn->out_tail = NULL;
+    conn->out_bytes = 0;
+    pthread_cond_broadcast(&conn->out_drained);
+}
+
+/**
+ * Copies bytes to the end of the queue; caller holds write_lock
+ */
+static int append_output(Connection* conn, const char* data, size_t len) {
+    OutputChunk* tail = conn->out_tail;
+    if (tail && tail->capacity - tail->len >= len) {
+        memcpy(tail->data + tail->len, data, len);
+        tail->len += len;
+        conn->out_bytes += len;
+        return 0;
+    }
+    
+    // Chunks come from the buffer pool, so small frames share one block
+    // with the frames queued after them
+    size_t block_size = 0;
+    OutputChunk* chunk = acquire_pool_buffer(sizeof(OutputChunk) + len, &block_size);
+    if (!chunk) {
+        return -1;
+    }
+    
+    chunk->next = NULL;
+    chunk->capacity = block_size - sizeof(OutputChunk);
+    chunk->len = len;
+    chunk->offset = 0;
+    memcpy(chunk->data, data, len);
+    
+    if (tail) {
+        tail->next = chunk;
+    } else {
+        conn->out_head = chunk;
+    }
+    conn->out_tail = chunk;
+    conn->out_bytes += len;
+    return 0;
+}
+
+/**
+ * Gather-writes queued chunks until the queue is empty or the socket
+ * is full; caller holds write_lock
+ */
+static int flush_locked(Connection* conn) {
+    while (conn->out_head) {
+        struct iovec iov[MAX_FLUSH_IOV];
+        int iovcnt = 0;
+        for (OutputChunk* chunk = conn->out_head; chunk && iovcnt < MAX_FLUSH_IOV; chunk = chunk->next) {
+            iov[iovcnt].iov_base = chunk->data + chunk->offset;
+            iov[iovcnt].iov_len = chunk->len - chunk->offset;
+            iovcnt++;
+        }
+        
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+        
+        ssize_t written = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                set_write_interest(conn, 1);
+                return 0;
+            }
+            LOG_ERROR_MSG("Write error on fd=%d: %s", conn->fd, strerror(errno));
+            drop_queued_output(conn);
+            set_write_interest(conn, 0);
+            return -1;
+        }
+        
+        size_t remaining = (size_t)written;
+        conn->out_bytes -= remaining;
+        while (remaining > 0) {
+            OutputChunk* chunk = conn->out_head;
+            size_t pending = chunk->len - chunk->offset;
+            if (remaining < pending) {
+                chunk->offset += remaining;
+                break;
+            }
+            remaining -= pending;
+            conn->out_head = chunk->next;
+            release_pool_buffer(chunk, sizeof(OutputChunk) + chunk->capacity);
+        }
+        if (!conn->out_head) {
+            conn->out_tail = NULL;
+        }
+        
+        pthread_cond_broadcast(&conn->out_drained);
+    }
+    
+    set_write_interest(conn, 0);
+    return 0;
+}
+
+int queue_output(Connection* conn, const struct iovec* iov, int iovcnt) {
+    if (!conn || !iov || iovcnt <= 0 || !conn->is_active) {
+        return -1;
+    }
+    
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        total += iov[i].iov_len;
+    }
+    
+    pthread_mutex_lock(&conn->write_lock);
+    
+    // Write straight from the caller's buffers when nothing is queued
+    // ahead; only the part the socket does not take gets copied
+    size_t written = 0;
+    if (!conn->out_head) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = (struct iovec*)iov;
+        msg.msg_iovlen = iovcnt;
+        
+        ssize_t result;
+        do {
+            result = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+        } while (result < 0 && errno == EINTR);
+        
+        if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            pthread_mutex_unlock(&conn->write_lock);
+            return -1;
+        }
+        written = result > 0 ? (size_t)result : 0;
+    }
+    
+    size_t skip = written;
+    for (int i = 0; i < iovcnt && written < total; i++) {
+        if (skip >= iov[i].iov_len) {
+            skip -= iov[i].iov_len;
+            continue;
+        }
+        
+        if (append_output(conn, (const char*)iov[i].iov_base + skip, iov[i].iov_len - skip) != 0) {
+            LOG_ERROR_MSG("Failed to queue output for fd=%d", conn->fd);
+            pthread_mutex_unlock(&conn->write_lock);
+            return -1;
+        }
+        skip = 0;
+    }
+    
+    if (conn->out_head) {
+        set_write_interest(conn, 1);
+    }
+    
+    pthread_mutex_unlock(&conn->write_lock);
+    return (int)total;
+}
+
+int flush_output(Connection* conn) {
+    if (!conn) {
+        return -1;
+    }
+    
+    pthread_mutex_lock(&conn->write_lock);
+    int result = flush_locked(conn);
+    pthread_mutex_unlock(&conn->write_lock);
+    
+    return result;
+}
+
+size_t get_queued_output(Connection* conn) {
+    if (!conn) {
+        return 0;
+    }
+    
+    pthread_mutex_lock(&conn->write_lock);
+    size_t queued = conn->out_bytes;
+    pthread_mutex_unlock(&conn->write_lock);
+    
+    return queued;
+}
+
+int wait_for_output_drain(Connection* conn, size_t low_water, int timeout_ms) {
+    if (!conn) {
+        return -1;
+    }
+    
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    
+    pthread_mutex_lock(&conn->write_lock);
+    
+    int result = 0;
+    while (conn->out_bytes > low_water) {
+        if (!conn->is_active ||
+            pthread_cond_timedwait(&conn->out_drained, &conn->write_lock, &deadline) == ETIMEDOUT) {
+            result = -1;
+            break;
+        }
+    }
+    
+    if (!conn->is_active) {
+        result = -1;
+    }
+    
+    pthread_mutex_unlock(&conn->write_lock);
+    return result;
+}
+
+void cancel_output(Connection* conn) {
+    if (!conn) {
+        return;
+    }
+    
+    pthread_mutex_lock(&conn->write_lock);
+    drop_queued_output(conn);
+    pthread_mutex_unlock(&conn->write_lock);
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef MANAGE_OUTPUT_QUEUE_H
+#define MANAGE_OUTPUT_QUEUE_H
+
+#include "../create_connection/create_connection.h"
+#include <stddef.h>
+#include <sys/uio.h>
+
+/**
+ * Writes data to the connection without blocking. Whatever the socket
+ * does not take right away is copied to the connection's output queue
+ * and flushed by the owning I/O worker on EPOLLOUT, in order.
+ * @param conn Connection to write to
+ * @param iov Buffers to write, in order
+ * @param iovcnt Number of buffers
+ * @return Number of bytes accepted or -1 if the connection is gone
+ */
+int queue_output(Connection* conn, const struct iovec* iov, int iovcnt);
+
+/**
+ * Writes as much queued output as the socket accepts; keeps EPOLLOUT
+ * armed while output remains and disarms it once the queue is empty
+ * @param conn Connection to flush
+ * @return 0 on success, -1 on write error (queued output is dropped)
+ */
+int flush_output(Connection* conn);
+
+/**
+ * Gets the number of queued bytes not yet written
+ * @param conn Connection to inspect
+ * @return Queued bytes
+ */
+size_t get_queued_output(Connection* conn);
+
+/**
+ * Blocks until queued output drops to low_water, the connection goes
+ * away or the timeout expires
+ * @param conn Connection to wait on
+ * @param low_water Queued byte count to wait for
+ * @param timeout_ms Maximum wait in milliseconds
+ * @return 0 once drained, -1 on timeout or closed connection
+ */
+int wait_for_output_drain(Connection* conn, size_t low_water, int timeout_ms);
+
+/**
+ * Drops queued output and wakes writers waiting for it to drain
+ * @param conn Connection being closed
+ */
+void cancel_output(Connection* conn);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,12 @@
+#include "release_connection.h"
+#include "../cleanup_connection/cleanup_connection.h"
+
+void release_connection(Connection* conn) {
+    if (!conn) {
+        return;
+    }
+    
+    if (__sync_sub_and_fetch(&conn->refcount, 1) == 0) {
+        cleanup_connection(conn);
+    }
+}
\ No newline at end of file
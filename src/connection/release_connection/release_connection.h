@@ -0,0 +1,13 @@
+#ifndef RELEASE_CONNECTION_H
+#define RELEASE_CONNECTION_H
+
+#include "../create_connection/create_connection.h"
+
+/**
+ * Drops a reference on a connection; the last reference closes
+ * the file descriptor and frees the connection
+ * @param conn Connection to release
+ */
+void release_connection(Connection* conn);
+
+#endif
\ No newline at end of file
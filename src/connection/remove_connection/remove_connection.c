@@ -1,5 +1,6 @@
 #include "remove_connection.h"
-#include <stdlib.h>
+#include "../release_connection/release_connection.h"
+#include "../manage_output_queue/manage_output_queue.h"
 #include <stddef.h>
 
 int remove_connection(ConnectionManager* manager, int fd) {
@@ -7,14 +8,26 @@ int remove_connection(ConnectionManager* manager, int fd) {
         return -1;
     }
     
-    for (int i = 0; i < manager->max_connections; i++) {
-        if (manager->connections[i] && manager->connections[i]->fd == fd) {
-            free(manager->connections[i]);
-            manager->connections[i] = NULL;
-            manager->count--;
-            return 0;
-        }
+    Connection* removed = NULL;
+    pthread_mutex_lock(&manager->lock);
+    
+    if (fd >= 0 && fd < manager->table_size && manager->connections[fd]) {
+        removed = manager->connections[fd];
+        manager->connections[fd] = NULL;
+        manager->count--;
+    }
+    
+    pthread_mutex_unlock(&manager->lock);
+    
+    if (!removed) {
+        return -1;
     }
     
-    return -1;
+    // Mark inactive so in-flight jobs stop writing (and stop waiting for
+    // their output to drain), then drop the manager's
+    // reference; the fd is closed once the last job releases it
+    removed->is_active = 0;
+    cancel_output(removed);
+    release_connection(removed);
+    return 0;
 }
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include "../add_connection/add_connection.h"
 
 /**
- * Removes connection from manager
+ * Removes connection from manager and releases the manager's reference
  * @param manager Connection manager
  * @param fd File descriptor to remove
  * @return 0 on success, -1 on error
@@ -0,0 +1,11 @@
+#include "retain_connection.h"
+#include <stddef.h>
+
+Connection* retain_connection(Connection* conn) {
+    if (!conn) {
+        return NULL;
+    }
+    
+    __sync_add_and_fetch(&conn->refcount, 1);
+    return conn;
+}
\ No newline at end of file
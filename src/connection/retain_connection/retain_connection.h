@@ -0,0 +1,14 @@
+#ifndef RETAIN_CONNECTION_H
+#define RETAIN_CONNECTION_H
+
+#include "../create_connection/create_connection.h"
+
+/**
+ * Takes an additional reference on a connection so it outlives
+ * its removal from the connection manager (e.g. while a queued job uses it)
+ * @param conn Connection to retain
+ * @return The same connection pointer
+ */
+Connection* retain_connection(Connection* conn);
+
+#endif
\ No newline at end of file
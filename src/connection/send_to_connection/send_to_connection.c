@@ -1,11 +1,16 @@
 #include "send_to_connection.h"
-#include <sys/socket.h>
-#include <unistd.h>
+#include "../manage_output_queue/manage_output_queue.h"
+#include <sys/uio.h>
 
 int send_to_connection(Connection* conn, const void* data, size_t len) {
     if (!conn || !data || !conn->is_active) {
         return -1;
     }
     
-    return send(conn->fd, data, len, MSG_NOSIGNAL);
+    // I/O workers and the NPU worker may answer on the same connection;
+    // the output queue keeps their frames whole and in order
+    struct iovec iov;
+    iov.iov_base = (void*)data;
+    iov.iov_len = len;
+    return queue_output(conn, &iov, 1);
 }
\ No newline at end of file
@@ -5,11 +5,12 @@
 #include <stddef.h>
 
 /**
- * Sends data to specific connection
+ * Sends data to specific connection; bytes the socket cannot take yet
+ * are queued and flushed when it becomes writable
  * @param conn Connection to send to
  * @param data Data to send
  * @param len Length of data
- * @return Number of bytes sent or -1 on error
+ * @return Number of bytes accepted or -1 on error
  */
 int send_to_connection(Connection* conn, const void* data, size_t len);
 
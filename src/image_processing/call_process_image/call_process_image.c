@@ -1,5 +1,9 @@
 #include "call_process_image.h"
 #include "../process_image/process_image.h"
+#include "../manage_image_embeddings/manage_image_embeddings.h"
+#include "../../jsonrpc/extract_bool_param/extract_bool_param.h"
+#include "../../jsonrpc/extract_int_param/extract_int_param.h"
+#include "../../jsonrpc/extract_string_param/extract_string_param.h"
 #include "../../utils/log_message/log_message.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -76,6 +80,37 @@ json_object* call_init_image_processor(json_object* params) {
     return response;
 }
 
+/**
+ * Builds the image.process result for a stored embedding
+ * @param params Request params ("return_embeddings" adds the values as JSON)
+ * @param embedding Stored embedding
+ * @param tier Where the embedding came from
+ */
+static json_object* describe_embedding(json_object* params, const ImageEmbedding* embedding, ImageCacheTier tier) {
+    static const char* const tier_names[] = { "miss", "memory", "disk" };
+    size_t embedding_size = (size_t)embedding->n_image_tokens * (size_t)embedding->embed_dim;
+    json_object* result = json_object_new_object();
+    
+    // The values stay in server memory; rkllm.run references them by
+    // handle instead of receiving them back as JSON
+    if (extract_bool_param(params, "return_embeddings", 0)) {
+        json_object* embeddings_array = json_object_new_array();
+        for (size_t i = 0; i < embedding_size; i++) {
+            json_object_array_add(embeddings_array, json_object_new_double(embedding->data[i]));
+        }
+        json_object_object_add(result, "embeddings", embeddings_array);
+    }
+    
+    char handle[IMAGE_HANDLE_LENGTH + 1];
+    format_image_handle(embedding->handle, handle);
+    json_object_object_add(result, "image_handle", json_object_new_string(handle));
+    json_object_object_add(result, "embedding_size", json_object_new_int64(embedding_size));
+    json_object_object_add(result, "n_image_tokens", json_object_new_int(embedding->n_image_tokens));
+    json_object_object_add(result, "embed_dim", json_object_new_int(embedding->embed_dim));
+    json_object_object_add(result, "cache", json_object_new_string(tier_names[tier]));
+    return result;
+}
+
 json_object* call_process_image(json_object* params) {
     json_object* response = json_object_new_object();
     
@@ -107,10 +142,62 @@ json_object* call_process_image(json_object* params) {
     
     const char* image_data = json_object_get_string(image_data_obj);
     
+    // Camera frames name their layout and size; files carry their own
+    YuvFormat format = YUV_FORMAT_NONE;
+    json_object* color_format_obj;
+    if (json_object_object_get_ex(params, "color_format", &color_format_obj)) {
+        format = parse_yuv_format(json_object_get_string(color_format_obj));
+        if (format == YUV_FORMAT_NONE) {
+            json_object* error = json_object_new_object();
+            json_object_object_add(error, "code", json_object_new_int(-32602));
+            json_object_object_add(error, "message", json_object_new_string("Unsupported color_format"));
+            json_object_object_add(response, "error", error);
+            return response;
+        }
+    }
+    
+    uint8_t* pixels;
+    int width, height, channels;
+    int decode_ret;
+    if (format != YUV_FORMAT_NONE) {
+        width = extract_int_param(params, "width", 0);
+        height = extract_int_param(params, "height", 0);
+        channels = 0;
+        decode_ret = decode_frame_base64(image_data, format, width, height, &pixels);
+    } else {
+        decode_ret = decode_image_base64(image_data, &pixels, &width, &height, &channels);
+    }
+    if (decode_ret != 0) {
+        json_object* error = json_object_new_object();
+        json_object_object_add(error, "code", json_object_new_int(-32602));
+        json_object_object_add(error, "message", json_object_new_string("Invalid image_data"));
+        json_object_object_add(response, "error", error);
+        return response;
+    }
+    
+    // Repeats of an image for the same encoder skip the NPU entirely; frames
+    // are keyed by their layout in place of a channel count
+    int shape[3] = { width, height, format != YUV_FORMAT_NONE ? -(int)format : channels };
+    size_t pixel_bytes = format != YUV_FORMAT_NONE ? yuv_frame_size(format, width, height)
+                                                   : (size_t)width * (size_t)height * (size_t)channels;
+    unsigned long long key = hash_image_bytes(global_processor->model_key, shape, sizeof(shape));
+    key = hash_image_bytes(key, pixels, pixel_bytes);
+    
+    ImageCacheTier tier;
+    ImageEmbedding* cached = lookup_image_embedding(key, &tier);
+    if (cached) {
+        free(pixels);
+        LOG_DEBUG_MSG("Image cache hit (%s): image_handle %016llx", tier == IMAGE_CACHE_DISK ? "disk" : "memory", cached->handle);
+        json_object_object_add(response, "result",
+                               describe_embedding(params, cached, tier));
+        return response;
+    }
+    
     // Allocate embeddings buffer
     size_t max_embedding_size = 196 * 1536; // Qwen2-VL dimensions
     float* embeddings = (float*)malloc(max_embedding_size * sizeof(float));
     if (!embeddings) {
+        free(pixels);
         json_object* error = json_object_new_object();
         json_object_object_add(error, "code", json_object_new_int(-32603));
         json_object_object_add(error, "message", json_object_new_string("Memory allocation failed"));
@@ -119,7 +206,13 @@ json_object* call_process_image(json_object* params) {
     }
     
     size_t embedding_size;
-    int ret = process_image_base64(global_processor, image_data, embeddings, &embedding_size);
+    int ret;
+    if (format != YUV_FORMAT_NONE) {
+        ret = process_yuv_data(global_processor, pixels, format, width, height, embeddings, &embedding_size);
+    } else {
+        ret = process_image_data(global_processor, pixels, width, height, channels, embeddings, &embedding_size);
+    }
+    free(pixels);
     
     if (ret != 0) {
         free(embeddings);
@@ -130,21 +223,44 @@ json_object* call_process_image(json_object* params) {
         return response;
     }
     
-    // Convert embeddings to JSON array
-    json_object* embeddings_array = json_object_new_array();
-    for (size_t i = 0; i < embedding_size; i++) {
-        json_object_array_add(embeddings_array, json_object_new_double(embeddings[i]));
+    int n_image_tokens = 196;
+    int embed_dim = (int)(embedding_size / (size_t)n_image_tokens);
+    unsigned long long handle = store_image_embedding(embeddings, n_image_tokens, embed_dim, key);
+    if (!handle) {
+        // Every cached image is still held; the client has to release some
+        free(embeddings);
+        json_object* error = json_object_new_object();
+        json_object_object_add(error, "code", json_object_new_int(-32000));
+        json_object_object_add(error, "message", json_object_new_string("Image cache full"));
+        json_object_object_add(response, "error", error);
+        return response;
+    }
+    json_object_object_add(response, "result",
+                           describe_embedding(params, find_image_embedding(handle), IMAGE_CACHE_MISS));
+    
+    LOG_INFO_MSG("Processed image, generated %zu embeddings as image_handle %016llx", embedding_size, handle);
+    
+    return response;
+}
+
+json_object* call_release_image(json_object* params) {
+    json_object* response = json_object_new_object();
+    
+    char* handle = extract_string_param(params, "image_handle", NULL);
+    if (release_image_embedding(parse_image_handle(handle)) != 0) {
+        free(handle);
+        json_object* error = json_object_new_object();
+        json_object_object_add(error, "code", json_object_new_int(-32602));
+        json_object_object_add(error, "message", json_object_new_string("Unknown image_handle"));
+        json_object_object_add(response, "error", error);
+        return response;
     }
     
     json_object* result = json_object_new_object();
-    json_object_object_add(result, "embeddings", embeddings_array);
-    json_object_object_add(result, "embedding_size", json_object_new_int64(embedding_size));
-    json_object_object_add(result, "n_image_tokens", json_object_new_int(196));
-    json_object_object_add(result, "embed_dim", json_object_new_int(1536));
+    json_object_object_add(result, "status", json_object_new_string("released"));
+    json_object_object_add(result, "image_handle", json_object_new_string(handle));
     json_object_object_add(response, "result", result);
-    
-    free(embeddings);
-    LOG_INFO_MSG("Processed image, generated %zu embeddings", embedding_size);
+    free(handle);
     
     return response;
 }
@@ -163,5 +279,11 @@ json_object* call_cleanup_image_processor(void) {
     json_object_object_add(result, "status", json_object_new_string("cleaned_up"));
     json_object_object_add(response, "result", result);
     
+    return response;
+}
+
+json_object* call_image_cache_stats(void) {
+    json_object* response = json_object_new_object();
+    json_object_object_add(response, "result", get_image_cache_stats());
     return response;
 }
\ No newline at end of file
@@ -3,9 +3,16 @@
 
 #include <json-c/json.h>
 
-// Process image and return embeddings as JSON
+// Process image, or find it in the image cache, and store its embeddings;
+// returns their image_handle (and the values as JSON with "return_embeddings": true)
 json_object* call_process_image(json_object* params);
 
+// Release an image_handle; its embeddings stay cached until evicted
+json_object* call_release_image(json_object* params);
+
+// Report image cache hits, misses and usage
+json_object* call_image_cache_stats(void);
+
 // Initialize image processor
 json_object* call_init_image_processor(json_object* params);
 
@@ -0,0 +1,167 @@
+#include "decode_image.h"
+#include "../../utils/log_message/log_message.h"
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <jpeglib.h>
+#include <png.h>
+
+// Size of the raw RGB frames clients sent before images were decoded
+#define RAW_IMAGE_SIZE 224
+
+// Gray the letterbox pads with; transparent PNG pixels are blended onto it
+#define BACKGROUND_GRAY 127
+
+// libjpeg reports fatal errors through a longjmp back into decode_jpeg
+typedef struct {
+    struct jpeg_error_mgr base;
+    jmp_buf escape;
+} JpegErrorManager;
+
+static void jpeg_error_exit(j_common_ptr cinfo) {
+    JpegErrorManager* errors = (JpegErrorManager*)cinfo->err;
+    char message[JMSG_LENGTH_MAX];
+    (*cinfo->err->format_message)(cinfo, message);
+    LOG_ERROR_MSG("JPEG decode failed: %s", message);
+    longjmp(errors->escape, 1);
+}
+
+// Warnings about slightly damaged files are not worth a log line per image
+static void jpeg_output_message(j_common_ptr cinfo) {
+    (void)cinfo;
+}
+
+/**
+ * Picks the largest IDCT reduction whose output still covers target_size,
+ * so downscaling happens in the DCT domain instead of on full pixels
+ */
+static int choose_scale_denom(int width, int height, int target_size) {
+    int longer = width > height ? width : height;
+    int denom = 1;
+    while (target_size > 0 && denom < 8 && (longer + denom * 2 - 1) / (denom * 2) >= target_size) {
+        denom *= 2;
+    }
+    return denom;
+}
+
+static int decode_jpeg(const uint8_t* data, size_t size, int target_size, DecodedImage* image) {
+    struct jpeg_decompress_struct cinfo;
+    JpegErrorManager errors;
+    uint8_t* volatile pixels = NULL;
+    
+    cinfo.err = jpeg_std_error(&errors.base);
+    errors.base.error_exit = jpeg_error_exit;
+    errors.base.output_message = jpeg_output_message;
+    if (setjmp(errors.escape)) {
+        jpeg_destroy_decompress(&cinfo);
+        free(pixels);
+        return -1;
+    }
+    
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, (unsigned char*)data, (unsigned long)size);
+    jpeg_read_header(&cinfo, TRUE);
+    if (cinfo.image_width > MAX_IMAGE_DIMENSION || cinfo.image_height > MAX_IMAGE_DIMENSION) {
+        LOG_ERROR_MSG("JPEG too large: %ux%u", cinfo.image_width, cinfo.image_height);
+        jpeg_destroy_decompress(&cinfo);
+        return -1;
+    }
+    
+    // Grayscale and YCbCr convert to RGB; CMYK makes libjpeg fail here
+    cinfo.out_color_space = JCS_RGB;
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = choose_scale_denom((int)cinfo.image_width, (int)cinfo.image_height, target_size);
+    jpeg_start_decompress(&cinfo);
+    
+    size_t row_bytes = (size_t)cinfo.output_width * (size_t)cinfo.output_components;
+    pixels = malloc(row_bytes * cinfo.output_height);
+    if (!pixels) {
+        jpeg_destroy_decompress(&cinfo);
+        return -1;
+    }
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = pixels + row_bytes * cinfo.output_scanline;
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+    
+    LOG_DEBUG_MSG("Decoded JPEG %ux%u at 1/%u: %ux%u", cinfo.image_width, cinfo.image_height,
+                  cinfo.scale_denom, cinfo.output_width, cinfo.output_height);
+    image->pixels = pixels;
+    image->width = (int)cinfo.output_width;
+    image->height = (int)cinfo.output_height;
+    image->channels = cinfo.output_components;
+    
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return 0;
+}
+
+static int decode_png(const uint8_t* data, size_t size, DecodedImage* image) {
+    png_image png;
+    memset(&png, 0, sizeof(png));
+    png.version = PNG_IMAGE_VERSION;
+    
+    if (!png_image_begin_read_from_memory(&png, data, size)) {
+        LOG_ERROR_MSG("PNG decode failed: %s", png.message);
+        return -1;
+    }
+    if (png.width > MAX_IMAGE_DIMENSION || png.height > MAX_IMAGE_DIMENSION ||
+        (unsigned long long)png.width * png.height > MAX_PNG_PIXELS) {
+        LOG_ERROR_MSG("PNG too large: %ux%u", png.width, png.height);
+        png_image_free(&png);
+        return -1;
+    }
+    
+    // Any bit depth, palette or gray format comes out as 8-bit RGB, with
+    // alpha composed onto the letterbox gray
+    png.format = PNG_FORMAT_RGB;
+    png_color background = { BACKGROUND_GRAY, BACKGROUND_GRAY, BACKGROUND_GRAY };
+    uint8_t* pixels = malloc(PNG_IMAGE_SIZE(png));
+    if (!pixels) {
+        png_image_free(&png);
+        return -1;
+    }
+    if (!png_image_finish_read(&png, &background, pixels, 0, NULL)) {
+        LOG_ERROR_MSG("PNG decode failed: %s", png.message);
+        free(pixels);
+        return -1;
+    }
+    
+    image->pixels = pixels;
+    image->width = (int)png.width;
+    image->height = (int)png.height;
+    image->channels = 3;
+    return 0;
+}
+
+int decode_image(const uint8_t* data, size_t size, int target_size, DecodedImage* image) {
+    if (!data || !image) {
+        return -1;
+    }
+    memset(image, 0, sizeof(DecodedImage));
+    
+    static const uint8_t png_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    if (size >= 3 && data[0] == 0xff && data[1] == 0xd8 && data[2] == 0xff) {
+        return decode_jpeg(data, size, target_size, image);
+    }
+    if (size >= sizeof(png_signature) && memcmp(data, png_signature, sizeof(png_signature)) == 0) {
+        return decode_png(data, size, image);
+    }
+    
+    // Raw RGB as sent by older clients
+    size_t raw_size = (size_t)RAW_IMAGE_SIZE * RAW_IMAGE_SIZE * 3;
+    if (size < raw_size) {
+        LOG_ERROR_MSG("Unrecognized image data (%zu bytes)", size);
+        return -1;
+    }
+    image->pixels = malloc(raw_size);
+    if (!image->pixels) {
+        return -1;
+    }
+    memcpy(image->pixels, data, raw_size);
+    image->width = RAW_IMAGE_SIZE;
+    image->height = RAW_IMAGE_SIZE;
+    image->channels = 3;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef DECODE_IMAGE_H
+#define DECODE_IMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest accepted width or height of an encoded image
+#define MAX_IMAGE_DIMENSION 16384
+
+// Largest accepted PNG in pixels (4096 x 4096, 48 MiB of RGB); PNGs have
+// no reduced-size decode like the JPEG scaled IDCT, so the full image is
+// always allocated
+#define MAX_PNG_PIXELS (4096 * 4096)
+
+// Interleaved 8-bit pixels
+typedef struct {
+    uint8_t* pixels;            // width x height x channels, row-major (caller frees)
+    int width;
+    int height;
+    int channels;
+} DecodedImage;
+
+/**
+ * Decodes a JPEG or PNG file, or passes through raw RGB of the legacy
+ * 224x224 size. JPEGs are decoded with a scaled IDCT (1/2, 1/4 or 1/8) to
+ * the smallest size whose longer side still covers target_size; PNGs
+ * above MAX_PNG_PIXELS are rejected
+ * @param data Encoded bytes
+ * @param size Number of bytes
+ * @param target_size Longer side the caller will resize to (0 = full size)
+ * @param image Receives RGB pixels
+ * @return 0 on success, -1 if the data is not a supported image
+ */
+int decode_image(const uint8_t* data, size_t size, int target_size, DecodedImage* image);
+
+#endif
\ No newline at end of file
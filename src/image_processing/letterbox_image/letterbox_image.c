@@ -0,0 +1,467 @@
+#include "letterbox_image.h"
+#include "../decode_image/decode_image.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Filter weights are Q14 fixed point; every output sums to exactly 1 << 14
+#define WEIGHT_BITS 14
+#define WEIGHT_ONE (1 << WEIGHT_BITS)
+
+// Vertically filtered rows keep 7 fractional bits, so they fit 16 bits
+#define ROW_BITS 7
+
+// Chroma of the letterbox gray
+#define NEUTRAL_CHROMA 128
+
+// Taps of one output row or column; positions are in source pixels, the
+// part of the footprint that falls on the padding is a single weight
+typedef struct {
+    int first;                  // First source row or column
+    int count;                  // Number of source taps
+    int pad_weight;             // Weight of the padding value
+    const uint16_t* weights;    // count weights
+} FilterSpan;
+
+/**
+ * Computes the taps of every output position along one axis of the
+ * padded square. The square is square_size long and the image covers
+ * [offset, offset + image_size) of it; with shift 1 the taps address a
+ * plane subsampled by two, each of its samples standing for two pixels
+ */
+static void build_spans(int image_size, int offset, int square_size, int out_size, int shift,
+                        int max_taps, FilterSpan* spans, uint16_t* weights) {
+    double scale = (double)square_size / out_size;
+    double taps[max_taps];
+    double source_taps[max_taps];
+    
+    for (int o = 0; o < out_size; o++) {
+        int first;
+        int count = 0;
+        
+        if (scale >= 1.0) {
+            // Area: average the square pixels under the output pixel
+            double lo = o * scale;
+            double hi = (o + 1) * scale;
+            first = (int)floor(lo);
+            for (int c = first; c < square_size && c < hi && count < max_taps; c++) {
+                double covered = (c + 1 < hi ? c + 1 : hi) - (c > lo ? c : lo);
+                taps[count++] = covered > 0 ? covered / scale : 0;
+            }
+        } else {
+            // Bilinear between the two nearest square pixels
+            double center = (o + 0.5) * scale - 0.5;
+            if (center < 0) {
+                center = 0;
+            }
+            if (center > square_size - 1) {
+                center = square_size - 1;
+            }
+            first = (int)floor(center);
+            double fraction = center - first;
+            taps[count++] = 1.0 - fraction;
+            if (first + 1 < square_size) {
+                taps[count++] = fraction;
+            } else {
+                taps[0] = 1.0;
+            }
+        }
+        
+        // Split the footprint into image taps and padding
+        FilterSpan* span = &spans[o];
+        uint16_t* span_weights = weights + (size_t)o * max_taps;
+        double pad = 0;
+        span->first = -1;
+        span->count = 0;
+        for (int k = 0; k < count; k++) {
+            int source = first + k - offset;
+            if (source < 0 || source >= image_size) {
+                pad += taps[k];
+                continue;
+            }
+            source >>= shift;
+            if (span->first < 0) {
+                span->first = source;
+            }
+            if (source < span->first + span->count) {
+                source_taps[span->count - 1] += taps[k];
+            } else {
+                source_taps[span->count++] = taps[k];
+            }
+        }
+        for (int k = 0; k < span->count; k++) {
+            span_weights[k] = (uint16_t)lround(source_taps[k] * WEIGHT_ONE);
+        }
+        span->pad_weight = (int)lround(pad * WEIGHT_ONE);
+        span->weights = span_weights;
+        if (span->first < 0) {
+            span->first = 0;
+        }
+        
+        // Rounding leftovers go to the heaviest tap, so flat areas stay exact
+        int total = span->pad_weight;
+        int heaviest = -1;
+        for (int k = 0; k < span->count; k++) {
+            total += span_weights[k];
+            if (heaviest < 0 || span_weights[k] > span_weights[heaviest]) {
+                heaviest = k;
+            }
+        }
+        if (heaviest >= 0) {
+            span_weights[heaviest] = (uint16_t)(span_weights[heaviest] + WEIGHT_ONE - total);
+        } else {
+            span->pad_weight = WEIGHT_ONE;
+        }
+    }
+}
+
+// acc[i] += row[i] * weight over one source row; the first row of an
+// output row starts from the padding term, which repeats every four
+// values, instead of the previous sums
+static void accumulate_row(uint32_t* acc, const uint8_t* row, int length, uint16_t weight,
+                           int first_row, const uint32_t pad[4]) {
+    int i = 0;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    uint32x4_t start = vld1q_u32(pad);
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t values = vld1q_u8(row + i);
+        uint16x8_t low = vmovl_u8(vget_low_u8(values));
+        uint16x8_t high = vmovl_u8(vget_high_u8(values));
+        uint16x4_t parts[4] = { vget_low_u16(low), vget_high_u16(low), vget_low_u16(high), vget_high_u16(high) };
+        for (int q = 0; q < 4; q++) {
+            uint32x4_t sum = first_row ? start : vld1q_u32(acc + i + q * 4);
+            vst1q_u32(acc + i + q * 4, vmlal_n_u16(sum, parts[q], weight));
+        }
+    }
+#elif defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+    __m128i weights = _mm_set1_epi16((short)weight);
+    __m128i start = _mm_loadu_si128((const __m128i*)pad);
+    for (; i + 16 <= length; i += 16) {
+        __m128i values = _mm_loadu_si128((const __m128i*)(row + i));
+        __m128i halves[2] = { _mm_unpacklo_epi8(values, zero), _mm_unpackhi_epi8(values, zero) };
+        for (int h = 0; h < 2; h++) {
+            // 16 x 16 -> 32 bit products from their low and high halves
+            __m128i product_low = _mm_mullo_epi16(halves[h], weights);
+            __m128i product_high = _mm_mulhi_epu16(halves[h], weights);
+            __m128i* out = (__m128i*)(acc + i + h * 8);
+            __m128i sum_low = first_row ? start : _mm_loadu_si128(out);
+            __m128i sum_high = first_row ? start : _mm_loadu_si128(out + 1);
+            _mm_storeu_si128(out, _mm_add_epi32(sum_low, _mm_unpacklo_epi16(product_low, product_high)));
+            _mm_storeu_si128(out + 1, _mm_add_epi32(sum_high, _mm_unpackhi_epi16(product_low, product_high)));
+        }
+    }
+#endif
+    for (; i < length; i++) {
+        acc[i] = (first_row ? pad[i & 3] : acc[i]) + (uint32_t)row[i] * weight;
+    }
+}
+
+// Drops the accumulated rows to ROW_BITS fractional bits
+static void narrow_row(uint16_t* out, const uint32_t* acc, int length) {
+    int i = 0;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 8 <= length; i += 8) {
+        uint16x4_t low = vrshrn_n_u32(vld1q_u32(acc + i), WEIGHT_BITS - ROW_BITS);
+        uint16x4_t high = vrshrn_n_u32(vld1q_u32(acc + i + 4), WEIGHT_BITS - ROW_BITS);
+        vst1q_u16(out + i, vcombine_u16(low, high));
+    }
+#elif defined(__SSE2__)
+    __m128i round = _mm_set1_epi32(1 << (WEIGHT_BITS - ROW_BITS - 1));
+    for (; i + 8 <= length; i += 8) {
+        __m128i low = _mm_srli_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i*)(acc + i)), round), WEIGHT_BITS - ROW_BITS);
+        __m128i high = _mm_srli_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i*)(acc + i + 4)), round), WEIGHT_BITS - ROW_BITS);
+        // Values stay below 1 << 15, so the signed pack is exact
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(low, high));
+    }
+#endif
+    for (; i < length; i++) {
+        out[i] = (uint16_t)((acc[i] + (1u << (WEIGHT_BITS - ROW_BITS - 1))) >> (WEIGHT_BITS - ROW_BITS));
+    }
+}
+
+// Sums the source rows under one output row into row
+static void filter_rows(uint16_t* row, uint32_t* acc, const uint8_t* plane, size_t stride,
+                        int length, const FilterSpan* span, const uint8_t pad_values[4]) {
+    uint32_t pad[4];
+    for (int i = 0; i < 4; i++) {
+        pad[i] = (uint32_t)span->pad_weight * pad_values[i];
+    }
+    for (int k = 0; k < span->count; k++) {
+        accumulate_row(acc, plane + (size_t)(span->first + k) * stride, length, span->weights[k], k == 0, pad);
+    }
+    narrow_row(row, acc, length);
+}
+
+/**
+ * Filters one vertically filtered row horizontally into output pixels.
+ * Pixels are channels values every pixel_stride values of row and are
+ * written out_stride bytes apart
+ */
+static void filter_columns(uint8_t* out, int out_stride, const uint16_t* row, int pixel_stride,
+                           const FilterSpan* columns, int out_size, int channels, uint8_t pad_value) {
+    const int shift = WEIGHT_BITS + ROW_BITS;
+    for (int x = 0; x < out_size; x++) {
+        const FilterSpan* span = &columns[x];
+        uint32_t pad = (uint32_t)span->pad_weight * ((uint32_t)pad_value << ROW_BITS) + (1u << (shift - 1));
+        const uint16_t* pixel = row + (size_t)span->first * pixel_stride;
+        uint8_t* target = out + (size_t)x * out_stride;
+        if (span->count == 0) {
+            memset(target, pad_value, (size_t)channels);
+            continue;
+        }
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        // One pixel per vector
+        uint32x4_t sum = vdupq_n_u32(pad);
+        for (int k = 0; k < span->count; k++) {
+            sum = vmlal_n_u16(sum, vld1_u16(pixel + k * pixel_stride), span->weights[k]);
+        }
+        uint16_t lanes[4];
+        vst1_u16(lanes, vmovn_u32(vshrq_n_u32(sum, WEIGHT_BITS + ROW_BITS)));
+        for (int c = 0; c < channels; c++) {
+            target[c] = (uint8_t)lanes[c];
+        }
+#elif defined(__SSE2__)
+        // One pixel per vector, two taps per multiply-add: the values of both
+        // taps are interleaved against their packed weights. Values and
+        // weights stay below 1 << 15, so the signed multiply is exact
+        __m128i zero = _mm_setzero_si128();
+        __m128i sum = _mm_set1_epi32((int)pad);
+        int k = 0;
+        for (; k + 2 <= span->count; k += 2) {
+            __m128i pair = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(pixel + k * pixel_stride)),
+                                              _mm_loadl_epi64((const __m128i*)(pixel + (k + 1) * pixel_stride)));
+            __m128i weights = _mm_set1_epi32((int)(span->weights[k] | ((uint32_t)span->weights[k + 1] << 16)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pair, weights));
+        }
+        if (k < span->count) {
+            __m128i single = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(pixel + k * pixel_stride)), zero);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(single, _mm_set1_epi32(span->weights[k])));
+        }
+        __m128i result = _mm_srli_epi32(sum, WEIGHT_BITS + ROW_BITS);
+        result = _mm_packus_epi16(_mm_packs_epi32(result, zero), zero);
+        uint32_t lanes = (uint32_t)_mm_cvtsi128_si32(result);
+        memcpy(target, &lanes, (size_t)channels);
+#else
+        uint32_t sum[4] = { pad, pad, pad, pad };
+        for (int k = 0; k < span->count; k++) {
+            uint32_t weight = span->weights[k];
+            for (int c = 0; c < channels; c++) {
+                sum[c] += weight * pixel[k * pixel_stride + c];
+            }
+        }
+        for (int c = 0; c < channels; c++) {
+            target[c] = (uint8_t)(sum[c] >> shift);
+        }
+#endif
+    }
+}
+
+static inline uint8_t clamp_channel(int value) {
+    value >>= 8;
+    return (uint8_t)(value < 0 ? 0 : value > 255 ? 255 : value);
+}
+
+// BT.601 limited range, 8 fractional bits
+static inline void yuv_to_rgb(int y, int u, int v, uint8_t* rgb) {
+    int luma = 298 * (y - 16) + 128;
+    rgb[0] = clamp_channel(luma + 409 * (v - 128));
+    rgb[1] = clamp_channel(luma - 100 * (u - 128) - 208 * (v - 128));
+    rgb[2] = clamp_channel(luma + 516 * (u - 128));
+}
+
+// Luma of a gray level, so padding converts back to the same gray
+static uint8_t gray_to_luma(uint8_t gray) {
+    return (uint8_t)(16 + (219 * gray + 127) / 255);
+}
+
+int letterbox_image(const uint8_t* src, int width, int height, int channels,
+                    uint8_t* dst, int dst_size, uint8_t pad_value) {
+    if (!src || !dst || width <= 0 || height <= 0 || dst_size <= 0 || channels < 1 || channels > 4) {
+        return -1;
+    }
+    
+    // Same placement as padding to a square and then resizing
+    int square_size = width > height ? width : height;
+    int x_offset = (square_size - width) / 2;
+    int y_offset = (square_size - height) / 2;
+    int max_taps = square_size / dst_size + 3;
+    size_t row_length = (size_t)width * channels;
+    
+    FilterSpan* spans = malloc(2 * (size_t)dst_size * sizeof(FilterSpan));
+    uint16_t* weights = malloc(2 * (size_t)dst_size * max_taps * sizeof(uint16_t));
+    uint32_t* acc = malloc(row_length * sizeof(uint32_t));
+    // A spare pixel lets the SIMD paths load four lanes at the last column
+    uint16_t* row = calloc(row_length + 4, sizeof(uint16_t));
+    if (!spans || !weights || !acc || !row) {
+        free(spans);
+        free(weights);
+        free(acc);
+        free(row);
+        return -1;
+    }
+    FilterSpan* columns = spans;
+    FilterSpan* rows = spans + dst_size;
+    build_spans(width, x_offset, square_size, dst_size, 0, max_taps, columns, weights);
+    build_spans(height, y_offset, square_size, dst_size, 0, max_taps, rows, weights + (size_t)dst_size * max_taps);
+    
+    const uint8_t pad_values[4] = { pad_value, pad_value, pad_value, pad_value };
+    size_t out_row_length = (size_t)dst_size * channels;
+    for (int y = 0; y < dst_size; y++) {
+        uint8_t* out = dst + (size_t)y * out_row_length;
+        if (rows[y].count == 0) {
+            memset(out, pad_value, out_row_length);
+            continue;
+        }
+        
+        // Vertical pass over the source rows under this output row, then
+        // the horizontal pass over their weighted sum
+        filter_rows(row, acc, src, row_length, (int)row_length, &rows[y], pad_values);
+        filter_columns(out, channels, row, channels, columns, dst_size, channels, pad_value);
+    }
+    
+    free(spans);
+    free(weights);
+    free(acc);
+    free(row);
+    return 0;
+}
+
+int letterbox_yuv_image(const uint8_t* src, YuvFormat format, int width, int height,
+                        uint8_t* dst, int dst_size, uint8_t pad_value) {
+    if (!src || !dst || dst_size <= 0 || yuv_frame_size(format, width, height) == 0) {
+        return -1;
+    }
+    
+    int square_size = width > height ? width : height;
+    int x_offset = (square_size - width) / 2;
+    int y_offset = (square_size - height) / 2;
+    int max_taps = square_size / dst_size + 3;
+    // NV12 filters its two planes one after the other; YUYV rows hold both
+    size_t row_length = (size_t)width * (format == YUV_FORMAT_YUYV ? 2 : 1);
+    
+    FilterSpan* spans = malloc(4 * (size_t)dst_size * sizeof(FilterSpan));
+    uint16_t* weights = malloc(4 * (size_t)dst_size * max_taps * sizeof(uint16_t));
+    uint32_t* acc = malloc(row_length * sizeof(uint32_t));
+    uint16_t* row = calloc(row_length + 4, sizeof(uint16_t));
+    uint8_t* planes = malloc(3 * (size_t)dst_size);
+    if (!spans || !weights || !acc || !row || !planes) {
+        free(spans);
+        free(weights);
+        free(acc);
+        free(row);
+        free(planes);
+        return -1;
+    }
+    
+    // Chroma taps cover the same footprint as luma, on the subsampled plane
+    FilterSpan* luma_columns = spans;
+    FilterSpan* luma_rows = spans + dst_size;
+    FilterSpan* chroma_columns = spans + 2 * dst_size;
+    FilterSpan* chroma_rows = spans + 3 * dst_size;
+    size_t span_weights = (size_t)dst_size * max_taps;
+    build_spans(width, x_offset, square_size, dst_size, 0, max_taps, luma_columns, weights);
+    build_spans(height, y_offset, square_size, dst_size, 0, max_taps, luma_rows, weights + span_weights);
+    build_spans(width, x_offset, square_size, dst_size, 1, max_taps, chroma_columns, weights + 2 * span_weights);
+    build_spans(height, y_offset, square_size, dst_size, 1, max_taps, chroma_rows, weights + 3 * span_weights);
+    
+    // Filtered luma of one output row, then its interleaved U and V
+    uint8_t* luma = planes;
+    uint8_t* chroma = planes + dst_size;
+    uint8_t pad_luma = gray_to_luma(pad_value);
+    const uint8_t luma_pad[4] = { pad_luma, pad_luma, pad_luma, pad_luma };
+    const uint8_t chroma_pad[4] = { NEUTRAL_CHROMA, NEUTRAL_CHROMA, NEUTRAL_CHROMA, NEUTRAL_CHROMA };
+    const uint8_t packed_pad[4] = { pad_luma, NEUTRAL_CHROMA, pad_luma, NEUTRAL_CHROMA };
+    size_t out_row_length = (size_t)dst_size * 3;
+    
+    for (int y = 0; y < dst_size; y++) {
+        uint8_t* out = dst + (size_t)y * out_row_length;
+        if (luma_rows[y].count == 0) {
+            memset(out, pad_value, out_row_length);
+            continue;
+        }
+        
+        if (format == YUV_FORMAT_NV12) {
+            const uint8_t* uv_plane = src + (size_t)width * height;
+            filter_rows(row, acc, src, (size_t)width, width, &luma_rows[y], luma_pad);
+            filter_columns(luma, 1, row, 1, luma_columns, dst_size, 1, pad_luma);
+            filter_rows(row, acc, uv_plane, (size_t)width, width, &chroma_rows[y], chroma_pad);
+            filter_columns(chroma, 2, row, 2, chroma_columns, dst_size, 2, NEUTRAL_CHROMA);
+        } else {
+            filter_rows(row, acc, src, row_length, (int)row_length, &luma_rows[y], packed_pad);
+            filter_columns(luma, 1, row, 2, luma_columns, dst_size, 1, pad_luma);
+            filter_columns(chroma, 2, row + 1, 4, chroma_columns, dst_size, 1, NEUTRAL_CHROMA);
+            filter_columns(chroma + 1, 2, row + 3, 4, chroma_columns, dst_size, 1, NEUTRAL_CHROMA);
+        }
+        
+        // Only the output pixels are converted
+        for (int x = 0; x < dst_size; x++) {
+            yuv_to_rgb(luma[x], chroma[2 * x], chroma[2 * x + 1], out + (size_t)x * 3);
+        }
+    }
+    
+    free(spans);
+    free(weights);
+    free(acc);
+    free(row);
+    free(planes);
+    return 0;
+}
+
+int convert_yuv_image(const uint8_t* src, YuvFormat format, int width, int height, uint8_t* dst) {
+    if (!src || !dst || yuv_frame_size(format, width, height) == 0) {
+        return -1;
+    }
+    
+    for (int y = 0; y < height; y++) {
+        uint8_t* out = dst + (size_t)y * width * 3;
+        if (format == YUV_FORMAT_NV12) {
+            const uint8_t* luma = src + (size_t)y * width;
+            const uint8_t* chroma = src + (size_t)width * height + (size_t)(y / 2) * width;
+            for (int x = 0; x < width; x++) {
+                yuv_to_rgb(luma[x], chroma[x & ~1], chroma[x | 1], out + (size_t)x * 3);
+            }
+        } else {
+            const uint8_t* packed = src + (size_t)y * width * 2;
+            for (int x = 0; x < width; x++) {
+                const uint8_t* pair = packed + (size_t)(x / 2) * 4;
+                yuv_to_rgb(packed[2 * x], pair[1], pair[3], out + (size_t)x * 3);
+            }
+        }
+    }
+    return 0;
+}
+
+YuvFormat parse_yuv_format(const char* name) {
+    if (!name) {
+        return YUV_FORMAT_NONE;
+    }
+    if (strcasecmp(name, "nv12") == 0) {
+        return YUV_FORMAT_NV12;
+    }
+    if (strcasecmp(name, "yuyv") == 0) {
+        return YUV_FORMAT_YUYV;
+    }
+    return YUV_FORMAT_NONE;
+}
+
+size_t yuv_frame_size(YuvFormat format, int width, int height) {
+    if (width <= 0 || height <= 0 || width > MAX_IMAGE_DIMENSION || height > MAX_IMAGE_DIMENSION || width % 2 != 0) {
+        return 0;
+    }
+    switch (format) {
+        case YUV_FORMAT_NV12:
+            return height % 2 == 0 ? (size_t)width * height * 3 / 2 : 0;
+        case YUV_FORMAT_YUYV:
+            return (size_t)width * height * 2;
+        default:
+            return 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef LETTERBOX_IMAGE_H
+#define LETTERBOX_IMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Camera frame layouts accepted besides RGB; BT.601 limited range
+typedef enum {
+    YUV_FORMAT_NONE = 0,
+    YUV_FORMAT_NV12,            // Y plane, then interleaved U/V at half width and height
+    YUV_FORMAT_YUYV             // Y0 U Y1 V per pixel pair
+} YuvFormat;
+
+/**
+ * Pads an image to a centered square and resizes it in one pass, without
+ * building the padded copy. Downscaling averages the covered area, so no
+ * source pixel is skipped; upscaling is bilinear
+ * @param src Interleaved 8-bit pixels, width x height x channels
+ * @param width Source width
+ * @param height Source height
+ * @param channels Values per pixel (1 to 4)
+ * @param dst Receives dst_size x dst_size x channels pixels
+ * @param dst_size Output width and height
+ * @param pad_value Value of the letterbox padding
+ * @return 0 on success, -1 on invalid arguments or allocation failure
+ */
+int letterbox_image(const uint8_t* src, int width, int height, int channels,
+                    uint8_t* dst, int dst_size, uint8_t pad_value);
+
+/**
+ * Same as letterbox_image for a YUV frame; the planes are filtered as
+ * they are and only the dst_size x dst_size result is converted to RGB
+ * @param src Frame of yuv_frame_size bytes
+ * @param format Frame layout
+ * @param width Frame width
+ * @param height Frame height
+ * @param dst Receives dst_size x dst_size x 3 RGB pixels
+ * @param dst_size Output width and height
+ * @param pad_value Gray of the letterbox padding
+ * @return 0 on success, -1 on invalid arguments or allocation failure
+ */
+int letterbox_yuv_image(const uint8_t* src, YuvFormat format, int width, int height,
+                        uint8_t* dst, int dst_size, uint8_t pad_value);
+
+/**
+ * Converts a YUV frame to RGB at its own size
+ * @param src Frame of yuv_frame_size bytes
+ * @param format Frame layout
+ * @param width Frame width
+ * @param height Frame height
+ * @param dst Receives width x height x 3 RGB pixels
+ * @return 0 on success, -1 on invalid arguments
+ */
+int convert_yuv_image(const uint8_t* src, YuvFormat format, int width, int height, uint8_t* dst);
+
+/**
+ * Looks up a frame layout by name ("nv12" or "yuyv")
+ * @param name Layout name
+ * @return Layout, or YUV_FORMAT_NONE if unknown
+ */
+YuvFormat parse_yuv_format(const char* name);
+
+/**
+ * Size of a frame; widths (and NV12 heights) must be even
+ * @param format Frame layout
+ * @param width Frame width
+ * @param height Frame height
+ * @return Bytes, or 0 if the dimensions do not fit the layout
+ */
+size_t yuv_frame_size(YuvFormat format, int width, int height);
+
+#endif
\ No newline at end of file
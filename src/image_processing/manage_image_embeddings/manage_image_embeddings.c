@@ -0,0 +1,530 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "manage_image_embeddings.h"
+#include "../../utils/log_message/log_message.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_BUDGET_BYTES (64 * 1024 * 1024)
+
+// xxHash64 primes
+#define PRIME_1 11400714785074694791ULL
+#define PRIME_2 14029467366897019727ULL
+#define PRIME_3 1609587929392839161ULL
+#define PRIME_4 9650029242287828579ULL
+
+// Cache files are named <16 hex digits of the key><suffix>
+#define IMAGE_CACHE_SUFFIX ".imgemb"
+#define IMAGE_CACHE_MAGIC "RKIMGEMB"
+
+// Start of a cache file; the values follow as host-order floats
+typedef struct {
+    char magic[8];
+    unsigned long long key;
+    int n_image_tokens;
+    int embed_dim;
+} ImageCacheHeader;
+
+// One cache file on disk
+typedef struct {
+    unsigned long long key;
+    size_t size;
+    time_t last_used;           // Mirrors the file mtime, so LRU order survives restarts
+} ImageCacheFile;
+
+// Only the NPU worker processes images and runs models, so none of this
+// needs a lock
+static ImageEmbedding embeddings[MAX_IMAGE_EMBEDDINGS];
+static unsigned long long embedding_clock = 0;
+static size_t memory_budget = DEFAULT_BUDGET_BYTES;
+static size_t memory_bytes = 0;
+
+static char* cache_directory = NULL;
+static size_t disk_budget = 0;
+static ImageCacheFile* cache_files = NULL;
+static int cache_count = 0;
+static int cache_capacity = 0;
+static size_t disk_bytes = 0;
+
+static unsigned long long memory_hits = 0;
+static unsigned long long disk_hits = 0;
+static unsigned long long misses = 0;
+static unsigned long long evictions = 0;
+
+static inline unsigned long long rotate_left(unsigned long long value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline unsigned long long read_word(const unsigned char* p) {
+    unsigned long long word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+static inline unsigned long long hash_round(unsigned long long lane, unsigned long long word) {
+    return rotate_left(lane + word * PRIME_2, 31) * PRIME_1;
+}
+
+unsigned long long hash_image_bytes(unsigned long long seed, const void* data, size_t length) {
+    const unsigned char* p = (const unsigned char*)data;
+    const unsigned char* end = p + length;
+    unsigned long long hash;
+    
+    // Four independent lanes keep the multipliers busy on large images
+    if (length >= 32) {
+        unsigned long long lanes[4] = {
+            seed + PRIME_1 + PRIME_2, seed + PRIME_2, seed, seed - PRIME_1
+        };
+        for (; p + 32 <= end; p += 32) {
+            lanes[0] = hash_round(lanes[0], read_word(p));
+            lanes[1] = hash_round(lanes[1], read_word(p + 8));
+            lanes[2] = hash_round(lanes[2], read_word(p + 16));
+            lanes[3] = hash_round(lanes[3], read_word(p + 24));
+        }
+        hash = rotate_left(lanes[0], 1) + rotate_left(lanes[1], 7) +
+               rotate_left(lanes[2], 12) + rotate_left(lanes[3], 18);
+        for (int i = 0; i < 4; i++) {
+            hash = (hash ^ hash_round(0, lanes[i])) * PRIME_1 + PRIME_4;
+        }
+    } else {
+        hash = seed + PRIME_1 * PRIME_3;
+    }
+    hash += (unsigned long long)length;
+    
+    for (; p + 8 <= end; p += 8) {
+        hash = rotate_left(hash ^ hash_round(0, read_word(p)), 27) * PRIME_1 + PRIME_4;
+    }
+    for (; p < end; p++) {
+        hash = rotate_left(hash ^ (*p * PRIME_3), 11) * PRIME_1;
+    }
+    
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+    return hash ? hash : 1;
+}
+
+static size_t get_embedding_bytes(int n_image_tokens, int embed_dim) {
+    return (size_t)n_image_tokens * (size_t)embed_dim * sizeof(float);
+}
+
+static char* format_cache_path(unsigned long long key, const char* extension) {
+    size_t length = strlen(cache_directory) + 1 + 16 + strlen(IMAGE_CACHE_SUFFIX) + strlen(extension) + 1;
+    char* path = malloc(length);
+    if (path) {
+        snprintf(path, length, "%s/%016llx%s%s", cache_directory, key, IMAGE_CACHE_SUFFIX, extension);
+    }
+    return path;
+}
+
+static ImageCacheFile* find_cache_file(unsigned long long key) {
+    for (int i = 0; i < cache_count; i++) {
+        if (cache_files[i].key == key) {
+            return &cache_files[i];
+        }
+    }
+    return NULL;
+}
+
+static ImageCacheFile* add_cache_file(unsigned long long key, size_t size, time_t last_used) {
+    if (cache_count == cache_capacity) {
+        int capacity = cache_capacity ? cache_capacity * 2 : 64;
+        ImageCacheFile* files = realloc(cache_files, (size_t)capacity * sizeof(ImageCacheFile));
+        if (!files) {
+            return NULL;
+        }
+        cache_files = files;
+        cache_capacity = capacity;
+    }
+    
+    ImageCacheFile* file = &cache_files[cache_count++];
+    file->key = key;
+    file->size = size;
+    file->last_used = last_used;
+    disk_bytes += size;
+    return file;
+}
+
+static void remove_cache_file(int index) {
+    char* path = format_cache_path(cache_files[index].key, "");
+    if (path) {
+        unlink(path);
+        free(path);
+    }
+    disk_bytes -= cache_files[index].size;
+    cache_files[index] = cache_files[--cache_count];
+}
+
+// Deletes least recently used files until the directory fits its budget
+static void evict_cache_files(unsigned long long keep_key) {
+    while (disk_budget > 0 && disk_bytes > disk_budget) {
+        int victim = -1;
+        for (int i = 0; i < cache_count; i++) {
+            if (cache_files[i].key != keep_key &&
+                (victim < 0 || cache_files[i].last_used < cache_files[victim].last_used)) {
+                victim = i;
+            }
+        }
+        if (victim < 0) {
+            break;
+        }
+        remove_cache_file(victim);
+    }
+}
+
+/**
+ * Saves an embedding as <key>.imgemb; the file is written under a
+ * temporary name first, so a crash never leaves a partial file behind
+ */
+static void write_cache_file(const ImageEmbedding* embedding) {
+    if (!cache_directory || find_cache_file(embedding->key)) {
+        return;
+    }
+    char* path = format_cache_path(embedding->key, "");
+    char* temp_path = format_cache_path(embedding->key, ".tmp");
+    if (!path || !temp_path) {
+        free(path);
+        free(temp_path);
+        return;
+    }
+    
+    ImageCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, IMAGE_CACHE_MAGIC, sizeof(header.magic));
+    header.key = embedding->key;
+    header.n_image_tokens = embedding->n_image_tokens;
+    header.embed_dim = embedding->embed_dim;
+    size_t data_bytes = get_embedding_bytes(embedding->n_image_tokens, embedding->embed_dim);
+    
+    int saved = 0;
+    FILE* file = fopen(temp_path, "wb");
+    if (file) {
+        saved = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                fwrite(embedding->data, 1, data_bytes, file) == data_bytes;
+        saved = fclose(file) == 0 && saved;
+    }
+    if (saved && rename(temp_path, path) == 0) {
+        add_cache_file(embedding->key, sizeof(header) + data_bytes, time(NULL));
+        evict_cache_files(embedding->key);
+    } else {
+        LOG_WARN_MSG("Failed to write image cache file %s: %s", path, strerror(errno));
+        unlink(temp_path);
+    }
+    free(path);
+    free(temp_path);
+}
+
+/**
+ * Maps a cache file copy-on-write, so the runtime may even write to the
+ * values without touching the file
+ * @return 0 on success, -1 if the file is missing or does not match its key
+ */
+static int map_cache_file(unsigned long long key, ImageEmbedding* embedding) {
+    ImageCacheFile* file = find_cache_file(key);
+    char* path = file ? format_cache_path(key, "") : NULL;
+    if (!path) {
+        return -1;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        free(path);
+        return -1;
+    }
+    
+    void* mapping = mmap(NULL, file->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    const ImageCacheHeader* header = mapping != MAP_FAILED ? (const ImageCacheHeader*)mapping : NULL;
+    if (!header || file->size < sizeof(ImageCacheHeader) ||
+        memcmp(header->magic, IMAGE_CACHE_MAGIC, sizeof(header->magic)) != 0 || header->key != key ||
+        header->n_image_tokens <= 0 || header->embed_dim <= 0 ||
+        file->size != sizeof(ImageCacheHeader) + get_embedding_bytes(header->n_image_tokens, header->embed_dim)) {
+        LOG_WARN_MSG("Discarding invalid image cache file %s", path);
+        if (header) {
+            munmap(mapping, file->size);
+        }
+        remove_cache_file((int)(file - cache_files));
+        free(path);
+        return -1;
+    }
+    madvise(mapping, file->size, MADV_WILLNEED);
+    
+    file->last_used = time(NULL);
+    utimensat(AT_FDCWD, path, NULL, 0);
+    free(path);
+    
+    embedding->mapping = mapping;
+    embedding->mapping_size = file->size;
+    embedding->data = (float*)((char*)mapping + sizeof(ImageCacheHeader));
+    embedding->n_image_tokens = header->n_image_tokens;
+    embedding->embed_dim = header->embed_dim;
+    return 0;
+}
+
+static void clear_embedding(ImageEmbedding* embedding) {
+    if (embedding->mapping) {
+        munmap(embedding->mapping, embedding->mapping_size);
+    } else {
+        free(embedding->data);
+    }
+    memory_bytes -= get_embedding_bytes(embedding->n_image_tokens, embedding->embed_dim);
+    memset(embedding, 0, sizeof(ImageEmbedding));
+}
+
+/**
+ * Picks the least recently used released embedding; held embeddings are
+ * still in use by a client and are never dropped
+ */
+static ImageEmbedding* find_victim(void) {
+    ImageEmbedding* victim = NULL;
+    for (int i = 0; i < MAX_IMAGE_EMBEDDINGS; i++) {
+        ImageEmbedding* embedding = &embeddings[i];
+        if (embedding->handle == 0 || embedding->holders > 0) {
+            continue;
+        }
+        if (!victim || embedding->last_used < victim->last_used) {
+            victim = embedding;
+        }
+    }
+    return victim;
+}
+
+static void evict_embedding(ImageEmbedding* victim) {
+    LOG_DEBUG_MSG("Dropping image embedding %016llx", victim->handle);
+    evictions++;
+    clear_embedding(victim);
+}
+
+/**
+ * Makes room for an embedding of the given size and returns a free slot
+ * @return Slot, or NULL if only held embeddings are in the way
+ */
+static ImageEmbedding* claim_slot(size_t bytes) {
+    while (memory_budget > 0 && memory_bytes > 0 && memory_bytes + bytes > memory_budget) {
+        ImageEmbedding* victim = find_victim();
+        if (!victim) {
+            return NULL;
+        }
+        evict_embedding(victim);
+    }
+    for (int i = 0; i < MAX_IMAGE_EMBEDDINGS; i++) {
+        if (embeddings[i].handle == 0) {
+            return &embeddings[i];
+        }
+    }
+    ImageEmbedding* victim = find_victim();
+    if (victim) {
+        evict_embedding(victim);
+    }
+    return victim;
+}
+
+/**
+ * Draws a handle nobody can guess from their own, so one client cannot
+ * use or release another client's images
+ */
+static unsigned long long new_handle(void) {
+    unsigned long long handle = 0;
+    while (handle == 0 || find_image_embedding(handle)) {
+        if (getrandom(&handle, sizeof(handle), 0) != (ssize_t)sizeof(handle)) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            handle = hash_image_bytes(handle ^ embedding_clock, &now, sizeof(now));
+        }
+    }
+    return handle;
+}
+
+static void fill_slot(ImageEmbedding* slot, unsigned long long key) {
+    slot->handle = new_handle();
+    slot->key = key;
+    slot->holders = 1;
+    slot->last_used = ++embedding_clock;
+    memory_bytes += get_embedding_bytes(slot->n_image_tokens, slot->embed_dim);
+}
+
+int init_image_embeddings(size_t budget_bytes, const char* directory, size_t disk_budget_bytes) {
+    memory_budget = budget_bytes;
+    if (!directory || directory[0] == '\0') {
+        return 0;
+    }
+    
+    if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+        LOG_ERROR_MSG("Cannot create image cache directory %s: %s", directory, strerror(errno));
+        return -1;
+    }
+    DIR* dir = opendir(directory);
+    if (!dir) {
+        LOG_ERROR_MSG("Cannot open image cache directory %s: %s", directory, strerror(errno));
+        return -1;
+    }
+    cache_directory = strdup(directory);
+    disk_budget = disk_budget_bytes;
+    
+    // Embeddings saved by earlier runs stay usable
+    struct dirent* entry;
+    while (cache_directory && (entry = readdir(dir)) != NULL) {
+        unsigned long long key = 0;
+        char suffix[16] = "";
+        if (strlen(entry->d_name) != 16 + strlen(IMAGE_CACHE_SUFFIX) ||
+            sscanf(entry->d_name, "%16llx%15s", &key, suffix) != 2 ||
+            strcmp(suffix, IMAGE_CACHE_SUFFIX) != 0) {
+            continue;
+        }
+        
+        char* path = format_cache_path(key, "");
+        struct stat file_stat;
+        if (path && stat(path, &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
+            add_cache_file(key, (size_t)file_stat.st_size, file_stat.st_mtime);
+        }
+        free(path);
+    }
+    closedir(dir);
+    
+    if (!cache_directory) {
+        return -1;
+    }
+    evict_cache_files(0);
+    LOG_INFO_MSG("Image cache in %s: %d files, %zu bytes", cache_directory, cache_count, disk_bytes);
+    return 0;
+}
+
+ImageEmbedding* lookup_image_embedding(unsigned long long key, ImageCacheTier* tier) {
+    for (int i = 0; i < MAX_IMAGE_EMBEDDINGS; i++) {
+        if (embeddings[i].handle != 0 && embeddings[i].key == key) {
+            embeddings[i].holders++;
+            embeddings[i].last_used = ++embedding_clock;
+            memory_hits++;
+            *tier = IMAGE_CACHE_MEMORY;
+            return &embeddings[i];
+        }
+    }
+    
+    ImageEmbedding loaded;
+    memset(&loaded, 0, sizeof(loaded));
+    if (cache_directory && map_cache_file(key, &loaded) == 0) {
+        ImageEmbedding* slot = claim_slot(get_embedding_bytes(loaded.n_image_tokens, loaded.embed_dim));
+        if (!slot) {
+            munmap(loaded.mapping, loaded.mapping_size);
+            *tier = IMAGE_CACHE_MISS;
+            return NULL;
+        }
+        *slot = loaded;
+        fill_slot(slot, key);
+        disk_hits++;
+        *tier = IMAGE_CACHE_DISK;
+        return slot;
+    }
+    
+    misses++;
+    *tier = IMAGE_CACHE_MISS;
+    return NULL;
+}
+
+unsigned long long store_image_embedding(float* data, int n_image_tokens, int embed_dim, unsigned long long key) {
+    ImageEmbedding* slot = claim_slot(get_embedding_bytes(n_image_tokens, embed_dim));
+    if (!slot) {
+        LOG_WARN_MSG("Image cache full: all %zu bytes are held", memory_bytes);
+        return 0;
+    }
+    slot->data = data;
+    slot->n_image_tokens = n_image_tokens;
+    slot->embed_dim = embed_dim;
+    fill_slot(slot, key);
+    write_cache_file(slot);
+    return slot->handle;
+}
+
+ImageEmbedding* find_image_embedding(unsigned long long handle) {
+    for (int i = 0; i < MAX_IMAGE_EMBEDDINGS; i++) {
+        if (handle != 0 && embeddings[i].handle == handle) {
+            embeddings[i].last_used = ++embedding_clock;
+            return &embeddings[i];
+        }
+    }
+    return NULL;
+}
+
+int release_image_embedding(unsigned long long handle) {
+    for (int i = 0; i < MAX_IMAGE_EMBEDDINGS; i++) {
+        if (handle != 0 && embeddings[i].handle == handle) {
+            if (embeddings[i].holders > 0) {
+                embeddings[i].holders--;
+            }
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void format_image_handle(unsigned long long handle, char* text) {
+    snprintf(text, IMAGE_HANDLE_LENGTH + 1, "%016llx", handle);
+}
+
+unsigned long long parse_image_handle(const char* text) {
+    unsigned long long handle = 0;
+    if (!text || strlen(text) != IMAGE_HANDLE_LENGTH) {
+        return 0;
+    }
+    for (const char* p = text; *p; p++) {
+        int digit;
+        if (*p >= '0' && *p <= '9') {
+            digit = *p - '0';
+        } else if (*p >= 'a' && *p <= 'f') {
+            digit = *p - 'a' + 10;
+        } else {
+            return 0;
+        }
+        handle = (handle << 4) | (unsigned long long)digit;
+    }
+    return handle;
+}
+
+json_object* get_image_cache_stats(void) {
+    int count = 0;
+    for (int i = 0; i < MAX_IMAGE_EMBEDDINGS; i++) {
+        if (embeddings[i].handle != 0) {
+            count++;
+        }
+    }
+    
+    json_object* result = json_object_new_object();
+    json_object_object_add(result, "memory_hits", json_object_new_int64((int64_t)memory_hits));
+    json_object_object_add(result, "disk_hits", json_object_new_int64((int64_t)disk_hits));
+    json_object_object_add(result, "misses", json_object_new_int64((int64_t)misses));
+    json_object_object_add(result, "evictions", json_object_new_int64((int64_t)evictions));
+    json_object_object_add(result, "entries", json_object_new_int(count));
+    json_object_object_add(result, "memory_bytes", json_object_new_int64((int64_t)memory_bytes));
+    json_object_object_add(result, "memory_budget_bytes", json_object_new_int64((int64_t)memory_budget));
+    if (cache_directory) {
+        json_object_object_add(result, "disk_files", json_object_new_int(cache_count));
+        json_object_object_add(result, "disk_bytes", json_object_new_int64((int64_t)disk_bytes));
+    }
+    return result;
+}
+
+void destroy_image_embeddings(void) {
+    for (int i = 0; i < MAX_IMAGE_EMBEDDINGS; i++) {
+        if (embeddings[i].handle != 0) {
+            clear_embedding(&embeddings[i]);
+        }
+    }
+    free(cache_files);
+    cache_files = NULL;
+    cache_count = 0;
+    cache_capacity = 0;
+    disk_bytes = 0;
+    free(cache_directory);
+    cache_directory = NULL;
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#ifndef MANAGE_IMAGE_EMBEDDINGS_H
+#define MANAGE_IMAGE_EMBEDDINGS_H
+
+#include <stddef.h>
+#include <json-c/json.h>
+
+// Table slots; the memory budget normally limits the table first
+#define MAX_IMAGE_EMBEDDINGS 256
+
+// Where image.process found an embedding
+typedef enum {
+    IMAGE_CACHE_MISS = 0,       // Computed by the vision encoder
+    IMAGE_CACHE_MEMORY,         // Still in the table
+    IMAGE_CACHE_DISK            // Mapped from the cache directory
+} ImageCacheTier;
+
+// Length of a handle written as text, without the terminator
+#define IMAGE_HANDLE_LENGTH 16
+
+// Output of the vision encoder, kept for rkllm.run to reference by handle
+// and for repeats of the same image to reuse
+typedef struct {
+    unsigned long long handle;  // Random handle returned by image.process (0 = free slot)
+    unsigned long long key;     // Hash of encoder model and pixels
+    float* data;                // n_image_tokens x embed_dim, row-major
+    int n_image_tokens;
+    int embed_dim;
+    int holders;                // image.process results not released yet
+    void* mapping;              // Cache file mapping data points into (NULL = heap buffer)
+    size_t mapping_size;
+    unsigned long long last_used;
+} ImageEmbedding;
+
+/**
+ * Sets the cache limits; without a call embeddings are kept up to the
+ * default budget and never written to disk
+ * @param budget_bytes Size of embeddings kept in memory (0 = table slots only)
+ * @param directory Cache directory, created if missing (NULL or "" = memory only)
+ * @param disk_budget_bytes Size of cache files (0 = no limit)
+ * @return 0 on success, -1 if the directory cannot be used
+ */
+int init_image_embeddings(size_t budget_bytes, const char* directory, size_t disk_budget_bytes);
+
+/**
+ * Extends a cache key with a block of bytes
+ * @param seed Key so far (0 to start)
+ * @param data Bytes to add
+ * @param length Number of bytes
+ * @return Non-zero key
+ */
+unsigned long long hash_image_bytes(unsigned long long seed, const void* data, size_t length);
+
+/**
+ * Looks up an embedding by content, in memory first and then on disk,
+ * and counts the result as one more holder
+ * @param key Key built with hash_image_bytes
+ * @param tier Receives where the embedding was found
+ * @return Embedding or NULL on a miss
+ */
+ImageEmbedding* lookup_image_embedding(unsigned long long key, ImageCacheTier* tier);
+
+/**
+ * Stores an encoder result and writes it to the cache directory;
+ * embeddings are only used from the NPU worker
+ * @param data Embedding values (owned by the store on success)
+ * @param n_image_tokens Number of image tokens
+ * @param embed_dim Values per token
+ * @param key Key built with hash_image_bytes
+ * @return Handle, or 0 if the cache is full of held embeddings
+ */
+unsigned long long store_image_embedding(float* data, int n_image_tokens, int embed_dim, unsigned long long key);
+
+/**
+ * Looks up an embedding and marks it as used
+ * @param handle Handle from store_image_embedding
+ * @return Embedding or NULL if unknown or dropped
+ */
+ImageEmbedding* find_image_embedding(unsigned long long handle);
+
+/**
+ * Gives up one holder's claim on an embedding; released embeddings stay
+ * cached and are dropped before held ones
+ * @param handle Handle from store_image_embedding
+ * @return 0 on success, -1 if the handle is unknown
+ */
+int release_image_embedding(unsigned long long handle);
+
+/**
+ * Writes a handle as the hex string clients send back; handles are
+ * random 64-bit values, which JSON numbers cannot carry exactly
+ * @param handle Handle from store_image_embedding
+ * @param text Receives IMAGE_HANDLE_LENGTH hex digits and a terminator
+ */
+void format_image_handle(unsigned long long handle, char* text);
+
+/**
+ * Reads a handle written by format_image_handle
+ * @param text Hex string from a request (NULL allowed)
+ * @return Handle, or 0 if text is not a handle
+ */
+unsigned long long parse_image_handle(const char* text);
+
+/**
+ * Describes the cache
+ * @return JSON object with hit and miss counters and memory and disk usage
+ */
+json_object* get_image_cache_stats(void);
+
+/**
+ * Frees every embedding; cache files stay on disk for the next start
+ */
+void destroy_image_embeddings(void);
+
+#endif
\ No newline at end of file
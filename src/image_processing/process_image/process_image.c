@@ -1,5 +1,9 @@
 #include "process_image.h"
+#include "../decode_image/decode_image.h"
+#include "../manage_image_embeddings/manage_image_embeddings.h"
 #include "../../utils/base64_decode.h"
+#include "../../utils/log_message/log_message.h"
+#include <sys/stat.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,55 +14,15 @@
 #define IMAGE_TOKEN_NUM 196
 #define EMBED_SIZE 1536
 
+// Part of every image cache key; bump it when preprocessing changes what
+// the encoder sees for the same pixels
+#define PREPROCESS_VERSION 2
+
 // Forward declaration
 int process_image_data(ImageProcessor* processor, uint8_t* image_data, 
                       int width, int height, int channels,
                       float* embeddings, size_t* embedding_size);
 
-// Simple image resizing function (nearest neighbor)
-static void resize_image(uint8_t* src, int src_w, int src_h, int channels,
-                        uint8_t* dst, int dst_w, int dst_h) {
-    float x_ratio = (float)src_w / dst_w;
-    float y_ratio = (float)src_h / dst_h;
-    
-    for (int y = 0; y < dst_h; y++) {
-        for (int x = 0; x < dst_w; x++) {
-            int src_x = (int)(x * x_ratio);
-            int src_y = (int)(y * y_ratio);
-            
-            for (int c = 0; c < channels; c++) {
-                dst[(y * dst_w + x) * channels + c] = 
-                    src[(src_y * src_w + src_x) * channels + c];
-            }
-        }
-    }
-}
-
-// Expand image to square with padding
-static void expand_to_square(uint8_t* src, int width, int height, int channels,
-                           uint8_t** dst, int* new_size) {
-    int size = (width > height) ? width : height;
-    *new_size = size;
-    *dst = (uint8_t*)malloc(size * size * channels);
-    
-    // Fill with gray background (127.5)
-    memset(*dst, 127, size * size * channels);
-    
-    // Calculate padding
-    int x_offset = (size - width) / 2;
-    int y_offset = (size - height) / 2;
-    
-    // Copy original image to center
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            for (int c = 0; c < channels; c++) {
-                (*dst)[((y + y_offset) * size + (x + x_offset)) * channels + c] = 
-                    src[(y * width + x) * channels + c];
-            }
-        }
-    }
-}
-
 int init_image_processor(ImageProcessor* processor, const char* model_path, int core_num) {
     if (!processor || !model_path) {
         return -1;
@@ -74,13 +38,24 @@ int init_image_processor(ImageProcessor* processor, const char* model_path, int
         return ret;
     }
     
+    // Path, size and mtime identify the model, so a replaced file never
+    // reuses embeddings cached for the old one
+    struct stat model_stat;
+    long long identity[3] = { 0, 0, PREPROCESS_VERSION };
+    if (stat(model_path, &model_stat) == 0) {
+        identity[0] = (long long)model_stat.st_size;
+        identity[1] = (long long)model_stat.st_mtime;
+    }
+    processor->model_key = hash_image_bytes(0, model_path, strlen(model_path));
+    processor->model_key = hash_image_bytes(processor->model_key, identity, sizeof(identity));
+    
     processor->initialized = 1;
     return 0;
 }
 
-int process_image_base64(ImageProcessor* processor, const char* base64_data, 
-                        float* embeddings, size_t* embedding_size) {
-    if (!processor || !processor->initialized || !base64_data || !embeddings) {
+int decode_image_base64(const char* base64_data, uint8_t** pixels,
+                        int* width, int* height, int* channels) {
+    if (!base64_data || !pixels) {
         return -1;
     }
     
@@ -93,16 +68,64 @@ int process_image_base64(ImageProcessor* processor, const char* base64_data,
         return -1;
     }
     
-    // For now, assume this is raw RGB data - in practice you'd use a proper image decoder
-    // This is a simplified implementation
-    int width = 224;  // Default assumption
-    int height = 224;
-    int channels = 3;
+    // JPEG and PNG are decoded close to the encoder size; raw RGB passes through
+    DecodedImage image;
+    int ret = decode_image(decoded_data, decoded_size, IMAGE_WIDTH, &image);
+    free(decoded_data);
+    if (ret != 0) {
+        return -1;
+    }
+    *pixels = image.pixels;
+    *width = image.width;
+    *height = image.height;
+    *channels = image.channels;
+    return 0;
+}
+
+int decode_frame_base64(const char* base64_data, YuvFormat format, int width, int height,
+                        uint8_t** frame) {
+    if (!base64_data || !frame) {
+        return -1;
+    }
+    
+    size_t frame_size = yuv_frame_size(format, width, height);
+    if (frame_size == 0) {
+        LOG_ERROR_MSG("Invalid %dx%d frame size", width, height);
+        return -1;
+    }
+    
+    unsigned char* decoded_data;
+    size_t decoded_size;
+    if (base64_decode(base64_data, &decoded_data, &decoded_size) != 0 || !decoded_data) {
+        LOG_ERROR_MSG("Failed to decode base64 frame data");
+        return -1;
+    }
+    if (decoded_size < frame_size) {
+        LOG_ERROR_MSG("Frame data too short: %zu of %zu bytes", decoded_size, frame_size);
+        free(decoded_data);
+        return -1;
+    }
     
-    int ret = process_image_data(processor, decoded_data, width, height, channels, 
+    *frame = decoded_data;
+    return 0;
+}
+
+int process_image_base64(ImageProcessor* processor, const char* base64_data, 
+                        float* embeddings, size_t* embedding_size) {
+    if (!processor || !processor->initialized || !base64_data || !embeddings) {
+        return -1;
+    }
+    
+    uint8_t* pixels;
+    int width, height, channels;
+    if (decode_image_base64(base64_data, &pixels, &width, &height, &channels) != 0) {
+        return -1;
+    }
+    
+    int ret = process_image_data(processor, pixels, width, height, channels, 
                                 embeddings, embedding_size);
     
-    free(decoded_data);
+    free(pixels);
     return ret;
 }
 
@@ -113,31 +136,53 @@ int process_image_data(ImageProcessor* processor, uint8_t* image_data,
         return -1;
     }
     
-    // Expand to square
-    uint8_t* square_data;
-    int square_size;
-    expand_to_square(image_data, width, height, channels, &square_data, &square_size);
-    
-    // Resize to target size
+    // Pad to a square and resize in one pass
     uint8_t* resized_data = (uint8_t*)malloc(IMAGE_WIDTH * IMAGE_HEIGHT * channels);
-    resize_image(square_data, square_size, square_size, channels,
-                resized_data, IMAGE_WIDTH, IMAGE_HEIGHT);
+    if (!resized_data) {
+        return -1;
+    }
+    if (letterbox_image(image_data, width, height, channels, resized_data, IMAGE_WIDTH, 127) != 0) {
+        free(resized_data);
+        return -1;
+    }
     
-    // Run image encoder
-    float img_vec[IMAGE_TOKEN_NUM * EMBED_SIZE];
-    int ret = run_imgenc(&processor->encoder_ctx, resized_data, img_vec);
+    // Run image encoder straight into the caller's buffer
+    int ret = run_imgenc(&processor->encoder_ctx, resized_data, embeddings);
     
     if (ret == 0) {
-        memcpy(embeddings, img_vec, sizeof(img_vec));
         *embedding_size = IMAGE_TOKEN_NUM * EMBED_SIZE;
     }
     
-    free(square_data);
     free(resized_data);
     
     return ret;
 }
 
+int process_yuv_data(ImageProcessor* processor, const uint8_t* frame, YuvFormat format,
+                     int width, int height, float* embeddings, size_t* embedding_size) {
+    if (!processor || !processor->initialized || !frame || !embeddings) {
+        return -1;
+    }
+    
+    // Color conversion happens inside the letterbox pass, on output pixels only
+    uint8_t* resized_data = (uint8_t*)malloc(IMAGE_WIDTH * IMAGE_HEIGHT * 3);
+    if (!resized_data) {
+        return -1;
+    }
+    if (letterbox_yuv_image(frame, format, width, height, resized_data, IMAGE_WIDTH, 127) != 0) {
+        free(resized_data);
+        return -1;
+    }
+    
+    int ret = run_imgenc(&processor->encoder_ctx, resized_data, embeddings);
+    if (ret == 0) {
+        *embedding_size = IMAGE_TOKEN_NUM * EMBED_SIZE;
+    }
+    
+    free(resized_data);
+    return ret;
+}
+
 int cleanup_image_processor(ImageProcessor* processor) {
     if (!processor || !processor->initialized) {
         return -1;
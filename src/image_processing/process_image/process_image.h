@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "../../utils/image_enc.h"
+#include "../letterbox_image/letterbox_image.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -12,11 +13,20 @@ extern "C" {
 typedef struct {
     rknn_app_context_t encoder_ctx;
     int initialized;
+    unsigned long long model_key;   // Encoder model file identity, seeds image cache keys
 } ImageProcessor;
 
 // Initialize image processor with RKNN vision encoder model
 int init_image_processor(ImageProcessor* processor, const char* model_path, int core_num);
 
+// Decode base64 encoded JPEG, PNG or raw 224x224 RGB into pixels (caller frees *pixels)
+int decode_image_base64(const char* base64_data, uint8_t** pixels,
+                        int* width, int* height, int* channels);
+
+// Decode a base64 encoded NV12 or YUYV frame of the given size (caller frees *frame)
+int decode_frame_base64(const char* base64_data, YuvFormat format, int width, int height,
+                        uint8_t** frame);
+
 // Process base64 encoded image and generate embeddings
 int process_image_base64(ImageProcessor* processor, const char* base64_data, 
                         float* embeddings, size_t* embedding_size);
@@ -26,6 +36,10 @@ int process_image_data(ImageProcessor* processor, uint8_t* image_data,
                       int width, int height, int channels,
                       float* embeddings, size_t* embedding_size);
 
+// Process a YUV frame, converting it to RGB while it is letterboxed
+int process_yuv_data(ImageProcessor* processor, const uint8_t* frame, YuvFormat format,
+                     int width, int height, float* embeddings, size_t* embedding_size);
+
 // Clean up image processor
 int cleanup_image_processor(ImageProcessor* processor);
 
@@ -0,0 +1,14 @@
+#include "free_request.h"
+#include <stdlib.h>
+
+void free_request(JSONRPCRequest* req) {
+    if (!req) {
+        return;
+    }
+    
+    if (req->jsonrpc) free(req->jsonrpc);
+    if (req->method) free(req->method);
+    if (req->params) json_object_put(req->params);
+    if (req->id) json_object_put(req->id);
+    free(req);
+}
\ No newline at end of file
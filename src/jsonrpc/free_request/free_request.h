@@ -0,0 +1,12 @@
+#ifndef FREE_REQUEST_H
+#define FREE_REQUEST_H
+
+#include "../parse_request/parse_request.h"
+
+/**
+ * Frees a parsed JSON-RPC request and its owned fields
+ * @param req Request to free (can be NULL)
+ */
+void free_request(JSONRPCRequest* req);
+
+#endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "../../connection/send_to_connection/send_to_connection.h"
 #include "../../rkllm/call_rkllm_createDefaultParam/call_rkllm_createDefaultParam.h"
 #include "../../rkllm/call_rkllm_init/call_rkllm_init.h"
+#include "../../rkllm/call_rkllm_init_status/call_rkllm_init_status.h"
 #include "../../rkllm/call_rkllm_run/call_rkllm_run.h"
 #include "../../rkllm/call_rkllm_run_async/call_rkllm_run_async.h"
 #include "../../rkllm/call_rkllm_is_running/call_rkllm_is_running.h"
@@ -17,6 +18,13 @@
 #include "../../rkllm/call_rkllm_set_function_tools/call_rkllm_set_function_tools.h"
 #include "../../rkllm/call_rkllm_set_cross_attn_params/call_rkllm_set_cross_attn_params.h"
 #include "../../rkllm/get_rkllm_constants/get_rkllm_constants.h"
+#include "../../rkllm/manage_model_registry/manage_model_registry.h"
+#include "../../rkllm/manage_perf_stats/manage_perf_stats.h"
+#include "../extract_bool_param/extract_bool_param.h"
+#include "../../rkllm/call_session_create/call_session_create.h"
+#include "../../rkllm/call_rkllm_embed/call_rkllm_embed.h"
+#include "../../rkllm/call_session_run/call_session_run.h"
+#include "../../rkllm/call_session_close/call_session_close.h"
 #include "../../rknn/call_rknn_init/call_rknn_init.h"
 #include "../../rknn/call_rknn_query/call_rknn_query.h"
 #include "../../rknn/call_rknn_destroy/call_rknn_destroy.h"
@@ -57,37 +65,45 @@ int handle_request(JSONRPCRequest* req, Connection* conn) {
     if (strcmp(req->method, "rkllm.createDefaultParam") == 0) {
         result = call_rkllm_createDefaultParam();
     } else if (strcmp(req->method, "rkllm.init") == 0) {
-        result = call_rkllm_init(req->params);
+        result = call_rkllm_init(req->params, conn, req->id);
+        
+        if (!result) {
+            return 0; // Answered before the first rkllm.init_status
+        }
+    } else if (strcmp(req->method, "rkllm.init_status") == 0) {
+        result = call_rkllm_init_status(req->params);
     } else if (strcmp(req->method, "rkllm.run") == 0) {
-        int request_id = req->id && json_object_is_type(req->id, json_type_int) ? 
-                        json_object_get_int(req->id) : 0;
-        result = call_rkllm_run(req->params, conn->fd, request_id);
+        result = call_rkllm_run(req->params, conn, req->id);
         
         if (!result) {
             LOG_DEBUG_MSG("rkllm.run returned NULL - async streaming active");
             return 0; // Success - callback handles responses
         }
     } else if (strcmp(req->method, "rkllm.run_async") == 0) {
-        int request_id = req->id && json_object_is_type(req->id, json_type_int) ? 
-                        json_object_get_int(req->id) : 0;
         LOG_DEBUG_MSG("Calling rkllm.run_async");
-        result = call_rkllm_run_async(req->params, conn->fd, request_id);
+        result = call_rkllm_run_async(req->params, conn, req->id);
+    } else if (strcmp(req->method, "rkllm.embed") == 0) {
+        result = call_rkllm_embed(req->params, conn, req->id);
+        
+        if (!result) {
+            return 0; // Vectors went out as a binary frame
+        }
     } else if (strcmp(req->method, "rkllm.is_running") == 0) {
-        result = call_rkllm_is_running();
+        result = call_rkllm_is_running(req->params);
     } else if (strcmp(req->method, "rkllm.abort") == 0) {
-        result = call_rkllm_abort();
+        result = call_rkllm_abort(req->params);
     } else if (strcmp(req->method, "rkllm.destroy") == 0) {
-        result = call_rkllm_destroy();
+        result = call_rkllm_destroy(req->params);
     } else if (strcmp(req->method, "rkllm.load_lora") == 0) {
         result = call_rkllm_load_lora(req->params);
     } else if (strcmp(req->method, "rkllm.load_prompt_cache") == 0) {
         result = call_rkllm_load_prompt_cache(req->params);
     } else if (strcmp(req->method, "rkllm.release_prompt_cache") == 0) {
-        result = call_rkllm_release_prompt_cache();
+        result = call_rkllm_release_prompt_cache(req->params);
     } else if (strcmp(req->method, "rkllm.clear_kv_cache") == 0) {
         result = call_rkllm_clear_kv_cache(req->params);
     } else if (strcmp(req->method, "rkllm.get_kv_cache_size") == 0) {
-        result = call_rkllm_get_kv_cache_size();
+        result = call_rkllm_get_kv_cache_size(req->params);
     } else if (strcmp(req->method, "rkllm.set_chat_template") == 0) {
         result = call_rkllm_set_chat_template(req->params);
     } else if (strcmp(req->method, "rkllm.set_function_tools") == 0) {
@@ -96,6 +112,22 @@ int handle_request(JSONRPCRequest* req, Connection* conn) {
         result = call_rkllm_set_cross_attn_params(req->params);
     } else if (strcmp(req->method, "rkllm.get_constants") == 0) {
         result = get_rkllm_constants();
+    } else if (strcmp(req->method, "rkllm.list_models") == 0) {
+        result = list_models();
+    } else if (strcmp(req->method, "rkllm.perf_stats") == 0) {
+        result = get_perf_stats(extract_bool_param(req->params, "reset", 0));
+        
+    // Conversation sessions
+    } else if (strcmp(req->method, "session.create") == 0) {
+        result = call_session_create(req->params);
+    } else if (strcmp(req->method, "session.run") == 0) {
+        result = call_session_run(req->params, conn, req->id);
+        
+        if (!result) {
+            return 0; // Streamed like rkllm.run
+        }
+    } else if (strcmp(req->method, "session.close") == 0) {
+        result = call_session_close(req->params);
         
     // RKNN methods - Core functions
     } else if (strcmp(req->method, "rknn.init") == 0) {
@@ -152,6 +184,10 @@ int handle_request(JSONRPCRequest* req, Connection* conn) {
         result = call_init_image_processor(req->params);
     } else if (strcmp(req->method, "image.process") == 0) {
         result = call_process_image(req->params);
+    } else if (strcmp(req->method, "image.release") == 0) {
+        result = call_release_image(req->params);
+    } else if (strcmp(req->method, "image.cache_stats") == 0) {
+        result = call_image_cache_stats();
     } else if (strcmp(req->method, "image.cleanup_processor") == 0) {
         result = call_cleanup_image_processor();
     } else {
@@ -176,6 +212,37 @@ int handle_request(JSONRPCRequest* req, Connection* conn) {
     return send_result > 0 ? 0 : -1;
 }
 
+// Methods answered directly on the I/O worker; they only query state,
+// signal the runtime or start background work (rkllm.init) and must stay
+// responsive while the NPU is busy
+static const char* const inline_methods[] = {
+    "rkllm.createDefaultParam",
+    "rkllm.init",
+    "rkllm.init_status",
+    "rkllm.get_constants",
+    "rkllm.is_running",
+    "rkllm.abort",
+    "rkllm.list_models",
+    "rkllm.perf_stats",
+    "rknn.get_constants",
+    "rknn.query",
+    NULL
+};
+
+int is_npu_bound_method(const char* method) {
+    if (!method) {
+        return 0;
+    }
+    
+    for (int i = 0; inline_methods[i]; i++) {
+        if (strcmp(method, inline_methods[i]) == 0) {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
 // Helper function to send error responses
 int send_error_response(Connection* conn, json_object* id, int code, const char* message) {
     json_object* error = json_object_new_object();
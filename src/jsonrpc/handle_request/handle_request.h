@@ -12,6 +12,14 @@
  */
 int handle_request(JSONRPCRequest* req, Connection* conn);
 
+/**
+ * Tells whether a method drives the NPU (or loads models) and therefore
+ * must run on the NPU worker instead of the I/O event loop
+ * @param method JSON-RPC method name
+ * @return 1 if NPU-bound, 0 if it can be answered inline
+ */
+int is_npu_bound_method(const char* method);
+
 /**
  * Helper function to send error responses
  * @param conn Connection to send error to
@@ -0,0 +1,378 @@
+#include "manage_stream_writer.h"
+#include "../../buffer/manage_buffer_pool/manage_buffer_pool.h"
+#include "../../utils/convert_float16/convert_float16.h"
+#include <stdint.h>
+#include <string.h>
+
+#define INITIAL_FRAME_SIZE 4096
+
+static const char hex_digits[] = "0123456789abcdef";
+
+/**
+ * Makes room for extra bytes after the current contents
+ */
+static int reserve(StreamBytes* bytes, size_t extra) {
+    size_t needed = bytes->len + extra;
+    if (needed <= bytes->capacity) {
+        return 0;
+    }
+    
+    size_t new_capacity = bytes->capacity ? bytes->capacity : INITIAL_FRAME_SIZE;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    
+    char* new_data = acquire_pool_buffer(new_capacity, &new_capacity);
+    if (!new_data) {
+        return -1;
+    }
+    
+    if (bytes->len > 0) {
+        memcpy(new_data, bytes->data, bytes->len);
+    }
+    release_pool_buffer(bytes->data, bytes->capacity);
+    bytes->data = new_data;
+    bytes->capacity = new_capacity;
+    return 0;
+}
+
+static int append_raw(StreamBytes* bytes, const char* data, size_t len) {
+    if (reserve(bytes, len) != 0) {
+        return -1;
+    }
+    
+    memcpy(bytes->data + bytes->len, data, len);
+    bytes->len += len;
+    return 0;
+}
+
+static int append_int(StreamBytes* bytes, int value) {
+    char digits[12];
+    size_t pos = sizeof(digits);
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    
+    do {
+        digits[--pos] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    
+    if (value < 0) {
+        digits[--pos] = '-';
+    }
+    
+    return append_raw(bytes, digits + pos, sizeof(digits) - pos);
+}
+
+static int append_size(StreamBytes* bytes, size_t value) {
+    char digits[24];
+    size_t pos = sizeof(digits);
+    do {
+        digits[--pos] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    
+    return append_raw(bytes, digits + pos, sizeof(digits) - pos);
+}
+
+/**
+ * Appends text escaped for a JSON string body (no quotes). Runs of
+ * plain bytes are copied in one go; UTF-8 passes through unchanged.
+ */
+static int append_escaped(StreamBytes* bytes, const char* text) {
+    size_t len = strlen(text);
+    if (len == 0) {
+        return 0;
+    }
+    
+    // Worst case every byte becomes \u00XX
+    if (reserve(bytes, len * 6) != 0) {
+        return -1;
+    }
+    
+    char* out = bytes->data + bytes->len;
+    const unsigned char* p = (const unsigned char*)text;
+    const unsigned char* end = p + len;
+    while (p < end) {
+        const unsigned char* run = p;
+        while (p < end && *p >= 0x20 && *p != '"' && *p != '\\') {
+            p++;
+        }
+        memcpy(out, run, (size_t)(p - run));
+        out += p - run;
+        if (p == end) {
+            break;
+        }
+        
+        unsigned char c = *p++;
+        *out++ = '\\';
+        switch (c) {
+            case '"':  *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '\n': *out++ = 'n'; break;
+            case '\r': *out++ = 'r'; break;
+            case '\t': *out++ = 't'; break;
+            case '\b': *out++ = 'b'; break;
+            case '\f': *out++ = 'f'; break;
+            default:
+                *out++ = 'u';
+                *out++ = '0';
+                *out++ = '0';
+                *out++ = hex_digits[c >> 4];
+                *out++ = hex_digits[c & 0xf];
+                break;
+        }
+    }
+    
+    bytes->len = (size_t)(out - bytes->data);
+    return 0;
+}
+
+/**
+ * Appends text as a quoted JSON string, or null
+ */
+static int append_string(StreamBytes* bytes, const char* text) {
+    if (!text) {
+        return append_raw(bytes, "null", 4);
+    }
+    
+    if (append_raw(bytes, "\"", 1) != 0 ||
+        append_escaped(bytes, text) != 0 ||
+        append_raw(bytes, "\"", 1) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Closes the result object with token_id and state and ends the frame
+ */
+static const char* finish_frame(StreamWriter* writer, int token_id, int state, size_t* frame_len) {
+    StreamBytes* frame = &writer->frame;
+    if (append_raw(frame, ",\"token_id\":", 12) != 0 ||
+        append_int(frame, token_id) != 0 ||
+        append_raw(frame, ",\"_callback_state\":", 19) != 0 ||
+        append_int(frame, state) != 0 ||
+        append_raw(frame, "}}\n", 3) != 0) {
+        return NULL;
+    }
+    
+    if (frame_len) {
+        *frame_len = frame->len;
+    }
+    return frame->data;
+}
+
+int init_stream_writer(StreamWriter* writer, json_object* id) {
+    if (!writer) {
+        return -1;
+    }
+    
+    memset(writer, 0, sizeof(StreamWriter));
+    
+    const char* id_json = id ? json_object_to_json_string_ext(id, JSON_C_TO_STRING_PLAIN) : "null";
+    if (!id_json ||
+        append_raw(&writer->frame, "{\"jsonrpc\":\"2.0\",\"id\":", 22) != 0 ||
+        append_raw(&writer->frame, id_json, strlen(id_json)) != 0 ||
+        append_raw(&writer->frame, ",\"result\":", 10) != 0) {
+        free_stream_writer(writer);
+        return -1;
+    }
+    
+    writer->prefix_len = writer->frame.len;
+    return 0;
+}
+
+const char* format_token_frame(StreamWriter* writer, const char* text, int token_id, int state, size_t* frame_len) {
+    return format_final_frame(writer, text, token_id, state, NULL, NULL, frame_len);
+}
+
+const char* format_final_frame(StreamWriter* writer, const char* text, int token_id, int state,
+                               const char* finish_reason, const char* perf_json, size_t* frame_len) {
+    if (!writer || !writer->frame.data) {
+        return NULL;
+    }
+    
+    StreamBytes* frame = &writer->frame;
+    frame->len = writer->prefix_len;
+    if (append_raw(frame, "{\"text\":", 8) != 0 ||
+        append_string(frame, text) != 0) {
+        return NULL;
+    }
+    if (finish_reason &&
+        (append_raw(frame, ",\"finish_reason\":", 17) != 0 ||
+         append_string(frame, finish_reason) != 0)) {
+        return NULL;
+    }
+    if (perf_json &&
+        (append_raw(frame, ",\"perf\":", 8) != 0 ||
+         append_raw(frame, perf_json, strlen(perf_json)) != 0)) {
+        return NULL;
+    }
+    
+    return finish_frame(writer, token_id, state, frame_len);
+}
+
+const char* format_error_frame(StreamWriter* writer, int code, const char* message, size_t* frame_len) {
+    if (!writer || !writer->frame.data) {
+        return NULL;
+    }
+    
+    // The envelope ends in ,"result": which an error replaces
+    StreamBytes* frame = &writer->frame;
+    frame->len = writer->prefix_len - 10;
+    if (append_raw(frame, ",\"error\":{\"code\":", 17) != 0 ||
+        append_int(frame, code) != 0 ||
+        append_raw(frame, ",\"message\":", 11) != 0 ||
+        append_string(frame, message) != 0 ||
+        append_raw(frame, "}}\n", 3) != 0) {
+        return NULL;
+    }
+    
+    if (frame_len) {
+        *frame_len = frame->len;
+    }
+    return frame->data;
+}
+
+const char* format_tensor_header(StreamWriter* writer, const char* name, TensorDtype dtype,
+                                 int rows, int cols, size_t byte_length, int state, size_t* frame_len) {
+    if (!writer || !writer->frame.data || !name) {
+        return NULL;
+    }
+    
+    StreamBytes* frame = &writer->frame;
+    frame->len = writer->prefix_len;
+    const char* dtype_name = dtype == TENSOR_FLOAT16 ? "\"float16\"" : "\"float32\"";
+    if (append_raw(frame, "{\"tensor\":", 10) != 0 ||
+        append_string(frame, name) != 0 ||
+        append_raw(frame, ",\"dtype\":", 9) != 0 ||
+        append_raw(frame, dtype_name, strlen(dtype_name)) != 0 ||
+        append_raw(frame, ",\"shape\":[", 10) != 0 ||
+        append_int(frame, rows) != 0 ||
+        append_raw(frame, ",", 1) != 0 ||
+        append_int(frame, cols) != 0 ||
+        append_raw(frame, "],\"bytes\":", 10) != 0 ||
+        append_size(frame, byte_length) != 0 ||
+        append_raw(frame, ",\"_callback_state\":", 19) != 0 ||
+        append_int(frame, state) != 0 ||
+        append_raw(frame, "}}\n", 3) != 0) {
+        return NULL;
+    }
+    
+    if (frame_len) {
+        *frame_len = frame->len;
+    }
+    return frame->data;
+}
+
+const void* encode_tensor_payload(StreamWriter* writer, const float* values, size_t count,
+                                  TensorDtype dtype, size_t* byte_length) {
+    if (!writer || (!values && count > 0)) {
+        return NULL;
+    }
+    
+    int little_endian = 1;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    little_endian = 0;
+#endif
+    
+    size_t element_size = dtype == TENSOR_FLOAT16 ? sizeof(uint16_t) : sizeof(float);
+    *byte_length = count * element_size;
+    if (dtype == TENSOR_FLOAT32 && little_endian) {
+        return values;
+    }
+    
+    StreamBytes* payload = &writer->payload;
+    payload->len = 0;
+    if (reserve(payload, *byte_length) != 0) {
+        return NULL;
+    }
+    
+    unsigned char* out = (unsigned char*)payload->data;
+    if (dtype == TENSOR_FLOAT16) {
+        convert_to_float16(values, (uint16_t*)out, count);
+    } else {
+        memcpy(out, values, *byte_length);
+    }
+    
+    // Byte-swap every element on big-endian hosts
+    if (!little_endian) {
+        for (size_t i = 0; i < *byte_length; i += element_size) {
+            for (size_t j = 0; j < element_size / 2; j++) {
+                unsigned char byte = out[i + j];
+                out[i + j] = out[i + element_size - 1 - j];
+                out[i + element_size - 1 - j] = byte;
+            }
+        }
+    }
+    payload->len = *byte_length;
+    return payload->data;
+}
+
+int append_stream_token(StreamWriter* writer, const char* text, int token_id) {
+    if (!writer) {
+        return -1;
+    }
+    
+    if (text) {
+        if (append_escaped(&writer->pending_text, text) != 0) {
+            return -1;
+        }
+        writer->pending_has_text = 1;
+    }
+    
+    if ((writer->pending_count > 0 && append_raw(&writer->pending_ids, ",", 1) != 0) ||
+        append_int(&writer->pending_ids, token_id) != 0) {
+        return -1;
+    }
+    
+    writer->last_token_id = token_id;
+    writer->pending_count++;
+    return 0;
+}
+
+const char* format_pending_frame(StreamWriter* writer, int state, size_t* frame_len) {
+    if (!writer || !writer->frame.data || writer->pending_count == 0) {
+        return NULL;
+    }
+    
+    StreamBytes* frame = &writer->frame;
+    frame->len = writer->prefix_len;
+    
+    int ok = append_raw(frame, "{\"text\":", 8) == 0;
+    if (ok && writer->pending_has_text) {
+        ok = append_raw(frame, "\"", 1) == 0 &&
+             append_raw(frame, writer->pending_text.data, writer->pending_text.len) == 0 &&
+             append_raw(frame, "\"", 1) == 0;
+    } else if (ok) {
+        ok = append_raw(frame, "null", 4) == 0;
+    }
+    
+    // Multi-token frames list every id; single-token frames keep the
+    // exact shape of an uncoalesced frame
+    if (ok && writer->pending_count > 1) {
+        ok = append_raw(frame, ",\"token_ids\":[", 14) == 0 &&
+             append_raw(frame, writer->pending_ids.data, writer->pending_ids.len) == 0 &&
+             append_raw(frame, "]", 1) == 0;
+    }
+    
+    int token_id = writer->last_token_id;
+    writer->pending_text.len = 0;
+    writer->pending_ids.len = 0;
+    writer->pending_count = 0;
+    writer->pending_has_text = 0;
+    
+    return ok ? finish_frame(writer, token_id, state, frame_len) : NULL;
+}
+
+void free_stream_writer(StreamWriter* writer) {
+    if (!writer) {
+        return;
+    }
+    
+    release_pool_buffer(writer->frame.data, writer->frame.capacity);
+    release_pool_buffer(writer->pending_text.data, writer->pending_text.capacity);
+    release_pool_buffer(writer->pending_ids.data, writer->pending_ids.capacity);
+    release_pool_buffer(writer->payload.data, writer->payload.capacity);
+    memset(writer, 0, sizeof(StreamWriter));
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#ifndef MANAGE_STREAM_WRITER_H
+#define MANAGE_STREAM_WRITER_H
+
+#include <stddef.h>
+#include <json-c/json.h>
+
+/**
+ * Growable byte area used by the stream writer
+ */
+typedef struct {
+    char* data;                // Bytes, borrowed from the buffer pool
+    size_t capacity;           // Allocated bytes
+    size_t len;                // Bytes in use
+} StreamBytes;
+
+/**
+ * Reusable encoder for streamed JSON-RPC result frames. The envelope up
+ * to the result object is serialized once per stream; each frame is then
+ * written into the same buffer without building a json_object tree.
+ * Tokens can be buffered and emitted together as one frame.
+ */
+typedef struct {
+    StreamBytes frame;         // Frame being built, reused for every frame
+    size_t prefix_len;         // Bytes of the pre-serialized envelope at the start of frame
+    StreamBytes pending_text;  // Escaped text of buffered tokens (no quotes)
+    StreamBytes pending_ids;   // Comma-separated ids of buffered tokens
+    int pending_count;         // Number of buffered tokens
+    int pending_has_text;      // Whether any buffered token carried text
+    int last_token_id;         // Id of the newest buffered token
+    StreamBytes payload;       // Tensor data converted for a binary frame
+} StreamWriter;
+
+// Element types of binary tensor frames
+typedef enum {
+    TENSOR_FLOAT32 = 0,        // Little-endian IEEE 754 single precision
+    TENSOR_FLOAT16             // Little-endian IEEE 754 half precision
+} TensorDtype;
+
+/**
+ * Prepares a writer for one stream
+ * @param writer Writer to initialize
+ * @param id JSON-RPC request id (NULL encodes as null)
+ * @return 0 on success, -1 on allocation failure
+ */
+int init_stream_writer(StreamWriter* writer, json_object* id);
+
+/**
+ * Encodes one token frame, newline-terminated:
+ * {"jsonrpc":"2.0","id":<id>,"result":{"text":...,"token_id":N,"_callback_state":S}}
+ * @param writer Initialized writer
+ * @param text Token text (NULL encodes as null)
+ * @param token_id Token id
+ * @param state Callback state
+ * @param frame_len Receives the frame length
+ * @return Frame bytes (owned by the writer, valid until the next call) or NULL on error
+ */
+const char* format_token_frame(StreamWriter* writer, const char* text, int token_id, int state, size_t* frame_len);
+
+/**
+ * Encodes a token frame like format_token_frame with the extra
+ * "finish_reason" and "perf" members of the final frame of a run
+ * @param writer Initialized writer
+ * @param text Token text (NULL encodes as null)
+ * @param token_id Token id
+ * @param state Callback state
+ * @param finish_reason Why the server ended the run, e.g. "stop" (NULL omits it)
+ * @param perf_json Serialized JSON value of "perf" (NULL omits it)
+ * @param frame_len Receives the frame length
+ * @return Frame bytes (owned by the writer, valid until the next call) or NULL on error
+ */
+const char* format_final_frame(StreamWriter* writer, const char* text, int token_id, int state,
+                               const char* finish_reason, const char* perf_json, size_t* frame_len);
+
+/**
+ * Encodes a JSON-RPC error response that ends the stream, newline-terminated:
+ * {"jsonrpc":"2.0","id":<id>,"error":{"code":C,"message":...}}
+ * @param writer Initialized writer
+ * @param code JSON-RPC error code
+ * @param message Error message
+ * @param frame_len Receives the frame length
+ * @return Frame bytes (owned by the writer, valid until the next call) or NULL on error
+ */
+const char* format_error_frame(StreamWriter* writer, int code, const char* message, size_t* frame_len);
+
+/**
+ * Encodes the header line of a binary tensor frame. The header is an
+ * ordinary newline-terminated frame; exactly "bytes" raw bytes of
+ * row-major tensor data follow it on the stream:
+ * {"jsonrpc":"2.0","id":<id>,"result":{"tensor":"logits","dtype":"float32","shape":[T,N],"bytes":B,"_callback_state":S}}
+ * @param writer Initialized writer
+ * @param name Tensor name ("hidden_states" or "logits")
+ * @param dtype Element type of the payload
+ * @param rows Number of tokens
+ * @param cols Values per token
+ * @param byte_length Size of the payload that follows
+ * @param state Callback state
+ * @param frame_len Receives the header length
+ * @return Header bytes (owned by the writer, valid until the next call) or NULL on error
+ */
+const char* format_tensor_header(StreamWriter* writer, const char* name, TensorDtype dtype,
+                                 int rows, int cols, size_t byte_length, int state, size_t* frame_len);
+
+/**
+ * Prepares the payload of a binary tensor frame. Float32 data on a
+ * little-endian host is sent as is; anything else is converted into
+ * the writer's payload buffer.
+ * @param writer Initialized writer
+ * @param values Tensor values, row-major
+ * @param count Number of values
+ * @param dtype Element type to send
+ * @param byte_length Receives the payload size
+ * @return Payload bytes (values itself or owned by the writer) or NULL on allocation failure
+ */
+const void* encode_tensor_payload(StreamWriter* writer, const float* values, size_t count,
+                                  TensorDtype dtype, size_t* byte_length);
+
+/**
+ * Buffers a token for the next coalesced frame
+ * @param writer Initialized writer
+ * @param text Token text (NULL adds no text)
+ * @param token_id Token id
+ * @return 0 on success, -1 on allocation failure
+ */
+int append_stream_token(StreamWriter* writer, const char* text, int token_id);
+
+/**
+ * Encodes the buffered tokens as one frame and clears them. The text is
+ * the concatenation of the buffered texts, token_id is the newest id and
+ * token_ids lists every id when more than one token was buffered.
+ * @param writer Writer holding at least one buffered token
+ * @param state Callback state reported in the frame
+ * @param frame_len Receives the frame length
+ * @return Frame bytes (owned by the writer) or NULL if nothing is buffered or on error
+ */
+const char* format_pending_frame(StreamWriter* writer, int state, size_t* frame_len);
+
+/**
+ * Releases the writer's buffers
+ * @param writer Writer to release
+ */
+void free_stream_writer(StreamWriter* writer);
+
+#endif
\ No newline at end of file
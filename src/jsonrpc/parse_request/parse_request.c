@@ -12,9 +12,18 @@ JSONRPCRequest* parse_request(const char* json_str) {
         return NULL;
     }
     
+    JSONRPCRequest* req = parse_request_object(root);
+    json_object_put(root);
+    return req;
+}
+
+JSONRPCRequest* parse_request_object(json_object* root) {
+    if (!root) {
+        return NULL;
+    }
+    
     JSONRPCRequest* req = malloc(sizeof(JSONRPCRequest));
     if (!req) {
-        json_object_put(root);
         return NULL;
     }
     
@@ -29,7 +38,6 @@ JSONRPCRequest* parse_request(const char* json_str) {
             req->jsonrpc = strdup(version);
             if (!req->jsonrpc) {
                 free(req);
-                json_object_put(root);
                 return NULL; // Memory allocation failed
             }
         }
@@ -44,7 +52,6 @@ JSONRPCRequest* parse_request(const char* json_str) {
             if (!req->method) {
                 if (req->jsonrpc) free((void*)req->jsonrpc);
                 free(req);
-                json_object_put(root);
                 return NULL; // Memory allocation failed
             }
         }
@@ -67,6 +74,5 @@ JSONRPCRequest* parse_request(const char* json_str) {
         req->is_valid = 1;
     }
     
-    json_object_put(root);
     return req;
 }
\ No newline at end of file
@@ -21,4 +21,11 @@ typedef struct {
  */
 JSONRPCRequest* parse_request(const char* json_str);
 
+/**
+ * Builds a JSON-RPC request from an already parsed message
+ * @param root Parsed message (not consumed; params and id are referenced)
+ * @return JSONRPCRequest pointer or NULL on error
+ */
+JSONRPCRequest* parse_request_object(json_object* root);
+
 #endif
\ No newline at end of file
@@ -17,19 +17,33 @@
 #include "server/cleanup_socket/cleanup_socket.h"
 #include "server/install_signal_handlers/install_signal_handlers.h"
 #include "server/check_shutdown_requested/check_shutdown_requested.h"
+#include "server/manage_io_workers/manage_io_workers.h"
+#include "server/manage_npu_worker/manage_npu_worker.h"
 
 // Connection management
 #include "connection/create_connection/create_connection.h"
 #include "connection/add_connection/add_connection.h"
-#include "connection/find_connection/find_connection.h"
 #include "connection/remove_connection/remove_connection.h"
+#include "connection/release_connection/release_connection.h"
+#include "connection/cleanup_connection/cleanup_connection.h"
+#include "connection/manage_connection_pool/manage_connection_pool.h"
 
-// JSON-RPC processing
-#include "jsonrpc/parse_request/parse_request.h"
-#include "jsonrpc/handle_request/handle_request.h"
+// Buffer management
+#include "buffer/manage_buffer_pool/manage_buffer_pool.h"
+
+// Model management
+#include "rkllm/manage_model_registry/manage_model_registry.h"
+#include "rkllm/manage_model_loads/manage_model_loads.h"
+#include "rkllm/manage_prompt_cache/manage_prompt_cache.h"
+#include "rkllm/manage_sessions/manage_sessions.h"
+#include "rkllm/preload_models/preload_models.h"
+
+// Image processing
+#include "image_processing/manage_image_embeddings/manage_image_embeddings.h"
 
 // Utility functions
 #include "utils/log_message/log_message.h"
+#include "utils/map_model_file/map_model_file.h"
 
 // Configuration
 #include "config/get_server_config/get_server_config.h"
@@ -40,6 +54,7 @@ static int server_socket = -1;
 static int epoll_fd = -1;
 static volatile int running = 1;
 static ConnectionManager* conn_manager = NULL;
+static IOWorkerPool io_pool;
 static const char* global_socket_path = NULL;
 
 void cleanup_and_exit(void) {
@@ -77,6 +92,7 @@ int main(int argc, char *argv[]) {
     LOG_INFO_MSG("Starting RKLLM Unix Domain Socket Server with Crash Protection");
     LOG_INFO_MSG("Socket path: %s", config->socket_path);
     LOG_INFO_MSG("Max connections: %d", config->max_connections);
+    LOG_INFO_MSG("I/O threads: %d", config->io_threads);
     LOG_INFO_MSG("Log level: %d", config->log_level);
 
     // Install hardened signal handlers for crash protection
@@ -103,13 +119,59 @@ int main(int argc, char *argv[]) {
     }
     conn_manager->max_connections = config->max_connections;
     conn_manager->count = 0;
-    conn_manager->connections = calloc(conn_manager->max_connections, sizeof(Connection*));
+    conn_manager->next_generation = 0;
+    // Indexed by fd; sized for the usual fd range and grown on demand
+    conn_manager->table_size = conn_manager->max_connections + 64;
+    conn_manager->connections = calloc(conn_manager->table_size, sizeof(Connection*));
     if (!conn_manager->connections) {
         LOG_ERROR_MSG("Failed to allocate connections array");
         free(conn_manager);
         free_server_config(config);
         return EXIT_FAILURE;
     }
+    pthread_mutex_init(&conn_manager->lock, NULL);
+    
+    // Preallocate connection objects and bound the I/O buffer cache
+    if (init_connection_pool(conn_manager->max_connections) != 0) {
+        LOG_WARN_MSG("Failed to preallocate connection pool, using heap allocation");
+    }
+    init_buffer_pool((size_t)config->buffer_pool_size);
+    
+    // Resident RKLLM models, evicted least recently used first
+    if (init_model_registry((size_t)config->model_memory_budget_mb * 1024 * 1024, config->max_models) != 0) {
+        LOG_ERROR_MSG("Failed to allocate model registry");
+        free_server_config(config);
+        return EXIT_FAILURE;
+    }
+    
+    // Stateless runs reuse the saved prefill of their system prompt
+    if (init_prompt_cache(config->prompt_cache_dir, (size_t)config->prompt_cache_max_mb * 1024 * 1024) != 0) {
+        LOG_WARN_MSG("Prompt cache disabled");
+    }
+    
+    // Repeated images reuse their vision encoder output
+    if (init_image_embeddings((size_t)config->image_cache_mb * 1024 * 1024, config->image_cache_dir,
+                              (size_t)config->image_cache_disk_mb * 1024 * 1024) != 0) {
+        LOG_WARN_MSG("Image cache directory disabled");
+    }
+    
+    // Pull model files from slow storage into the page cache in the
+    // background; loads that follow read them from memory
+    if (prefetch_model_files(config->prefetch_models) != 0) {
+        LOG_WARN_MSG("Failed to start model file prefetch");
+    }
+    
+    // Load and warm up configured models before the socket exists, so
+    // clients can only connect once the first request will be fast
+    if (preload_models(config->preload_models) != 0) {
+        LOG_ERROR_MSG("Failed to preload models");
+        destroy_image_embeddings();
+        destroy_model_loads();
+        destroy_model_registry();
+        destroy_prompt_cache();
+        free_server_config(config);
+        return EXIT_FAILURE;
+    }
 
     // Create Unix domain socket
     server_socket = create_socket(config->socket_path);
@@ -156,22 +218,45 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
+    // Start the NPU worker and the I/O worker loops
+    if (start_npu_worker(config->npu_queue_size, config->npu_quantum_ms) != 0) {
+        LOG_ERROR_MSG("Failed to start NPU worker");
+        close(epoll_fd);
+        cleanup_socket(server_socket, config->socket_path);
+        free_server_config(config);
+        return EXIT_FAILURE;
+    }
+    
+    if (start_io_workers(&io_pool, config->io_threads, conn_manager, config->epoll_max_events,
+                         config->epoll_timeout_ms, config->buffer_size,
+                         config->max_request_size) != 0) {
+        LOG_ERROR_MSG("Failed to start I/O workers");
+        stop_npu_worker();
+        close(epoll_fd);
+        cleanup_socket(server_socket, config->socket_path);
+        free_server_config(config);
+        return EXIT_FAILURE;
+    }
+
     LOG_INFO_MSG("Server started successfully, waiting for connections");
     
     // Output to stdout for test compatibility
     printf("Server started successfully\n");
     fflush(stdout);
 
-    // Main event loop with crash protection
+    // Accept event loop with crash protection
     struct epoll_event* events = malloc(config->epoll_max_events * sizeof(struct epoll_event));
     if (!events) {
         LOG_ERROR_MSG("Failed to allocate epoll events array");
+        stop_io_workers(&io_pool);
+        stop_npu_worker();
         close(epoll_fd);
         cleanup_socket(server_socket, config->socket_path);
         free_server_config(config);
         return EXIT_FAILURE;
     }
     
+    // Accept loop: this thread only accepts; client I/O runs on the worker pool
     while (running && !is_shutdown_requested()) {
         int event_count = epoll_wait(epoll_fd, events, config->epoll_max_events, config->epoll_timeout_ms);
         
@@ -190,92 +275,42 @@ int main(int argc, char *argv[]) {
         }
 
         for (int i = 0; i < event_count; i++) {
-            if (events[i].data.fd == server_socket) {
-                // New connection request
-                int client_fd = accept_connection(server_socket);
-                if (client_fd >= 0) {
-                    LOG_INFO_MSG("Accepted new connection: fd=%d", client_fd);
-                    
-                    // Create connection object
-                    Connection* conn = create_connection(client_fd);
-                    if (conn && add_connection(conn_manager, conn) == 0) {
-                        // Add client to epoll
-                        struct epoll_event client_event;
-                        client_event.events = EPOLLIN;
-                        client_event.data.fd = client_fd;
-                        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_fd, &client_event) < 0) {
-                            LOG_ERROR_MSG("Failed to add client to epoll: %s", strerror(errno));
-                            remove_connection(conn_manager, client_fd);
-                            close(client_fd);
-                        }
-                    } else {
-                        LOG_ERROR_MSG("Failed to create or add connection");
-                        close(client_fd);
-                    }
-                }
-            } else {
-                // Client data available
-                int client_fd = events[i].data.fd;
-                LOG_DEBUG_MSG("Data available on client fd=%d", client_fd);
-                
-                // Find connection
-                Connection* conn = find_connection(conn_manager, client_fd);
-                if (conn) {
-                    // Read data from client with configurable buffer size
-                    char* buffer = malloc(config->buffer_size);
-                    if (!buffer) {
-                        LOG_ERROR_MSG("Failed to allocate buffer for client fd=%d", client_fd);
-                        continue;
-                    }
-                    
-                    ssize_t bytes_read = recv(client_fd, buffer, config->buffer_size - 1, 0);
-                    
-                    if (bytes_read > 0) {
-                        buffer[bytes_read] = '\0';
-                        LOG_DEBUG_MSG("Received data: %s", buffer);
-                        
-                        // Parse JSON-RPC request
-                        JSONRPCRequest* req = parse_request(buffer);
-                        if (req && req->is_valid) {
-                            LOG_INFO_MSG("Valid JSON-RPC request: method=%s", req->method);
-                            // Handle the request
-                            handle_request(req, conn);
-                        } else {
-                            LOG_WARN_MSG("Invalid JSON-RPC request");
-                        }
-                        
-                        // Clean up request
-                        if (req) {
-                            if (req->jsonrpc) free(req->jsonrpc);
-                            if (req->method) free(req->method);
-                            if (req->params) json_object_put(req->params);
-                            if (req->id) json_object_put(req->id);
-                            free(req);
-                        }
-                    } else if (bytes_read == 0) {
-                        LOG_INFO_MSG("Client disconnected: fd=%d", client_fd);
-                        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client_fd, NULL);
-                        remove_connection(conn_manager, client_fd);
-                        close(client_fd);
-                    } else {
-                        LOG_ERROR_MSG("Read error on fd=%d: %s", client_fd, strerror(errno));
-                        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client_fd, NULL);
-                        remove_connection(conn_manager, client_fd);
-                        close(client_fd);
-                    }
-                    
-                    free(buffer);
-                } else {
-                    LOG_WARN_MSG("Connection not found for fd=%d", client_fd);
-                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client_fd, NULL);
-                    close(client_fd);
-                }
+            if (events[i].data.fd != server_socket) {
+                continue;
+            }
+            
+            // New connection request
+            int client_fd = accept_connection(server_socket);
+            if (client_fd < 0) {
+                continue;
+            }
+            LOG_INFO_MSG("Accepted new connection: fd=%d", client_fd);
+            
+            // Create connection object
+            Connection* conn = create_connection(client_fd);
+            if (!conn) {
+                LOG_ERROR_MSG("Failed to create connection");
+                close(client_fd);
+                continue;
+            }
+            
+            if (add_connection(conn_manager, conn) != 0) {
+                LOG_ERROR_MSG("Failed to add connection (limit %d reached)", conn_manager->max_connections);
+                cleanup_connection(conn);
+                continue;
+            }
+            
+            // Hand the client to an I/O worker loop
+            if (assign_connection_to_worker(&io_pool, conn) != 0) {
+                remove_connection(conn_manager, client_fd);
             }
         }
     }
 
     // Cleanup
     LOG_INFO_MSG("Shutting down server");
+    stop_io_workers(&io_pool);
+    stop_npu_worker();
     if (epoll_fd >= 0) {
         close(epoll_fd);
     }
@@ -290,15 +325,22 @@ int main(int argc, char *argv[]) {
     
     // Clean up connection manager
     if (conn_manager) {
-        for (int i = 0; i < conn_manager->max_connections; i++) {
+        for (int i = 0; i < conn_manager->table_size; i++) {
             if (conn_manager->connections[i]) {
-                close(conn_manager->connections[i]->fd);
-                free(conn_manager->connections[i]);
+                release_connection(conn_manager->connections[i]);
             }
         }
+        pthread_mutex_destroy(&conn_manager->lock);
         free(conn_manager->connections);
         free(conn_manager);
     }
+    destroy_sessions();
+    destroy_image_embeddings();
+    destroy_model_loads();
+    destroy_model_registry();
+    destroy_prompt_cache();
+    destroy_connection_pool();
+    destroy_buffer_pool();
     
     LOG_INFO_MSG("Server shutdown complete");
     
@@ -1,29 +1,15 @@
 #include "call_rkllm_abort.h"
+#include "../manage_model_registry/manage_model_registry.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
-#include "../manage_streaming_context/manage_streaming_context.h"
 #include "../../jsonrpc/format_response/format_response.h"
 #include <stdbool.h>
 #include <rkllm.h>
 #include <json-c/json.h>
 
-// External reference to global LLM handle from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-
-json_object* call_rkllm_abort(void) {
-    // Check if model is initialized
-    if (!global_llm_initialized || !global_llm_handle) {
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Model not initialized - call rkllm.init first"));
-        return error_result;
-    }
-    
-    // Call rkllm_abort
-    int result = rkllm_abort(global_llm_handle);
-    
-    // Clear any active streaming context since task was aborted
-    clear_streaming_context();
+static json_object* abort_with_model(ModelEntry* model) {
+    // Call rkllm_abort; the aborted run ends its own stream and frees its
+    // streaming context
+    int result = rkllm_abort(model->handle);
     
     // Return result
     json_object* result_obj = json_object_new_object();
@@ -32,4 +18,15 @@ json_object* call_rkllm_abort(void) {
     json_object_object_add(result_obj, "status_code", json_object_new_int(result));
     
     return result_obj;
+}
+
+json_object* call_rkllm_abort(json_object* params) {
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    json_object* result = abort_with_model(model);
+    release_model(model);
+    return result;
 }
\ No newline at end of file
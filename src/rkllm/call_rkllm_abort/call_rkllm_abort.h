@@ -5,8 +5,9 @@
 
 /**
  * @brief Abort ongoing RKLLM task
+ * @param params Optional object whose "model" field names the model (default: newest)
  * @return JSON object with abort result
  */
-json_object* call_rkllm_abort(void);
+json_object* call_rkllm_abort(json_object* params);
 
 #endif
\ No newline at end of file
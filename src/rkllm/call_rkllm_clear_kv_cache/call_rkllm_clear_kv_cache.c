@@ -1,4 +1,5 @@
 #include "call_rkllm_clear_kv_cache.h"
+#include "../manage_model_registry/manage_model_registry.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
 #include "../../jsonrpc/extract_int_param/extract_int_param.h"
 #include "../../jsonrpc/extract_array_param/extract_array_param.h"
@@ -6,19 +7,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-// External reference to global LLM handle and state from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-
-json_object* call_rkllm_clear_kv_cache(json_object* params) {
-    // Validate that model is initialized
-    if (!global_llm_initialized || !global_llm_handle) {
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Model not initialized - call rkllm.init first"));
-        return error_result;
-    }
-    
+static json_object* clear_kv_cache_with_model(ModelEntry* model, json_object* params) {
     if (!params || !json_object_is_type(params, json_type_object)) {
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32602));
@@ -34,7 +23,7 @@ json_object* call_rkllm_clear_kv_cache(json_object* params) {
     }
     
     // Get start_pos array from object parameters
-    json_object* start_pos_obj;
+    json_object* start_pos_obj = NULL;
     json_object_object_get_ex(params, "start_pos", &start_pos_obj);
     int* start_pos = NULL;
     size_t start_pos_len = 0;
@@ -59,7 +48,7 @@ json_object* call_rkllm_clear_kv_cache(json_object* params) {
     }
     
     // Get end_pos array from object parameters
-    json_object* end_pos_obj;
+    json_object* end_pos_obj = NULL;
     json_object_object_get_ex(params, "end_pos", &end_pos_obj);
     int* end_pos = NULL;
     size_t end_pos_len = 0;
@@ -84,8 +73,20 @@ json_object* call_rkllm_clear_kv_cache(json_object* params) {
         }
     }
     
+    // The runtime reads one range per batch slot from both arrays
+    if ((start_pos || end_pos) &&
+        ((int)start_pos_len != model->n_batch || (int)end_pos_len != model->n_batch)) {
+        if (start_pos) free(start_pos);
+        if (end_pos) free(end_pos);
+        json_object* error_result = json_object_new_object();
+        json_object_object_add(error_result, "code", json_object_new_int(-32602));
+        json_object_object_add(error_result, "message", json_object_new_string("start_pos and end_pos need one entry per batch slot (n_batch)"));
+        return error_result;
+    }
+    
     // Call rkllm_clear_kv_cache
-    int result = rkllm_clear_kv_cache(global_llm_handle, keep_system_prompt, start_pos, end_pos);
+    int result = rkllm_clear_kv_cache(model->handle, keep_system_prompt, start_pos, end_pos);
+    model->kv_session = 0;
     
     // Clean up allocated memory
     if (start_pos) free(start_pos);
@@ -106,4 +107,15 @@ json_object* call_rkllm_clear_kv_cache(json_object* params) {
         json_object_object_add(error_result, "message", json_object_new_string("Failed to clear KV cache"));
         return error_result;
     }
+}
+
+json_object* call_rkllm_clear_kv_cache(json_object* params) {
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    json_object* result = clear_kv_cache_with_model(model, params);
+    release_model(model);
+    return result;
 }
\ No newline at end of file
@@ -4,10 +4,11 @@
 #include <json-c/json.h>
 
 /**
- * Destroys the RKLLM instance and releases resources
+ * Destroys an RKLLM instance and releases resources
  * Maps to: int rkllm_destroy(LLMHandle handle)
+ * @param params Optional object whose "model" field names the model (default: newest)
  * @return JSON object with success/error status
  */
-json_object* call_rkllm_destroy(void);
+json_object* call_rkllm_destroy(json_object* params);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,357 @@
+#include "call_rkllm_embed.h"
+#include "../manage_streaming_context/manage_streaming_context.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../../jsonrpc/extract_bool_param/extract_bool_param.h"
+#include "../../jsonrpc/manage_stream_writer/manage_stream_writer.h"
+#include "../../connection/manage_output_queue/manage_output_queue.h"
+#include "../../utils/base64_encode.h"
+#include "../../utils/log_message/log_message.h"
+#include <stdbool.h>
+#include <rkllm.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+typedef enum {
+    POOL_LAST = 0,              // Hidden state of the last token
+    POOL_MEAN                   // Average over all tokens
+} PoolingMode;
+
+// Pooled vectors of one rkllm.embed call, filled by the result sink
+typedef struct {
+    PoolingMode pooling;
+    int current;                // Text of the current run
+    int count;                  // Number of texts
+    int dimensions;             // Hidden size (0 until the first result)
+    float* vectors;             // count x dimensions, row-major
+    int* tokens;                // Tokens pooled per text (0 = no hidden states yet)
+    int failed;                 // Allocation failed or the hidden size changed
+} EmbedBatch;
+
+static json_object* embed_error(int code, const char* message) {
+    json_object* error_result = json_object_new_object();
+    json_object_object_add(error_result, "code", json_object_new_int(code));
+    json_object_object_add(error_result, "message", json_object_new_string(message));
+    return error_result;
+}
+
+static const char* get_string_field(json_object* params, const char* key, const char* fallback) {
+    json_object* value = NULL;
+    if (json_object_object_get_ex(params, key, &value) && json_object_is_type(value, json_type_string)) {
+        return json_object_get_string(value);
+    }
+    return fallback;
+}
+
+// Vector helpers; hidden sizes are multiples of 4 in practice, the scalar
+// tails cover the rest
+
+static void add_vector(float* sum, const float* values, int n) {
+    int i = 0;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(sum + i, vaddq_f32(vld1q_f32(sum + i), vld1q_f32(values + i)));
+    }
+#endif
+    for (; i < n; i++) {
+        sum[i] += values[i];
+    }
+}
+
+static void scale_vector(float* values, float factor, int n) {
+    int i = 0;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t scale = vdupq_n_f32(factor);
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(values + i, vmulq_f32(vld1q_f32(values + i), scale));
+    }
+#endif
+    for (; i < n; i++) {
+        values[i] *= factor;
+    }
+}
+
+static float sum_of_squares(const float* values, int n) {
+    int i = 0;
+    float total = 0.0f;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vld1q_f32(values + i);
+        float32x4_t b = vld1q_f32(values + i + 4);
+        acc0 = vfmaq_f32(acc0, a, a);
+        acc1 = vfmaq_f32(acc1, b, b);
+    }
+    total = vaddvq_f32(vaddq_f32(acc0, acc1));
+#else
+    // Independent partial sums let the compiler keep several lanes busy
+    float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (; i + 4 <= n; i += 4) {
+        acc[0] += values[i] * values[i];
+        acc[1] += values[i + 1] * values[i + 1];
+        acc[2] += values[i + 2] * values[i + 2];
+        acc[3] += values[i + 3] * values[i + 3];
+    }
+    total = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+    for (; i < n; i++) {
+        total += values[i] * values[i];
+    }
+    return total;
+}
+
+/**
+ * Pools the hidden states of the current text into its vector; runs on
+ * the callback, so the runtime's buffers are never copied
+ */
+static void collect_hidden_states(void* sink_data, const RKLLMResult* result) {
+    EmbedBatch* batch = (EmbedBatch*)sink_data;
+    const RKLLMResultLastHiddenLayer* layer = &result->last_hidden_layer;
+    if (batch->failed || !layer->hidden_states || layer->num_tokens <= 0 || layer->embd_size <= 0) {
+        return;
+    }
+    
+    if (batch->dimensions == 0) {
+        batch->vectors = malloc((size_t)batch->count * (size_t)layer->embd_size * sizeof(float));
+        if (!batch->vectors) {
+            batch->failed = 1;
+            return;
+        }
+        batch->dimensions = layer->embd_size;
+    }
+    if (layer->embd_size != batch->dimensions) {
+        LOG_ERROR_MSG("Hidden size changed from %d to %d during rkllm.embed",
+                      batch->dimensions, layer->embd_size);
+        batch->failed = 1;
+        return;
+    }
+    
+    int dimensions = batch->dimensions;
+    float* vector = batch->vectors + (size_t)batch->current * (size_t)dimensions;
+    const float* last = layer->hidden_states + (size_t)(layer->num_tokens - 1) * (size_t)dimensions;
+    if (batch->pooling == POOL_LAST) {
+        memcpy(vector, last, (size_t)dimensions * sizeof(float));
+    } else {
+        memset(vector, 0, (size_t)dimensions * sizeof(float));
+        for (int t = 0; t < layer->num_tokens; t++) {
+            add_vector(vector, layer->hidden_states + (size_t)t * (size_t)dimensions, dimensions);
+        }
+        scale_vector(vector, 1.0f / (float)layer->num_tokens, dimensions);
+    }
+    batch->tokens[batch->current] = layer->num_tokens;
+}
+
+/**
+ * Runs every text through the model, one text per rkllm_run: rkllm.h
+ * documents a single RKLLMInput per run and no batch index in the result
+ * @return NULL on success or an error object
+ */
+static json_object* run_hidden_states(ModelEntry* model, json_object* texts, const char* role,
+                                      EmbedBatch* batch, Connection* conn, json_object* request_id) {
+    RKLLMInput input;
+    
+    RKLLMInferParam infer_param;
+    memset(&infer_param, 0, sizeof(infer_param));
+    infer_param.mode = RKLLM_INFER_GET_LAST_HIDDEN_LAYER;
+    infer_param.keep_history = 0;
+    
+    // Embedding runs replace whatever the KV cache held
+    model->kv_session = 0;
+    
+    for (int text = 0; text < batch->count; text++) {
+        batch->current = text;
+        memset(&input, 0, sizeof(input));
+        input.role = role;
+        input.input_type = RKLLM_INPUT_PROMPT;
+        input.prompt_input = json_object_get_string(json_object_array_get_idx(texts, (size_t)text));
+        
+        StreamingContext* context = create_streaming_context(conn, request_id, NULL, 0);
+        if (!context) {
+            return embed_error(-32000, "Failed to allocate streaming context");
+        }
+        context->sink = collect_hidden_states;
+        context->sink_data = batch;
+        
+        int result = rkllm_run(model->handle, &input, &infer_param, context);
+        int finished = !context->is_active;
+        free_streaming_context(context);
+        
+        if (result != 0 || !finished) {
+            LOG_ERROR_MSG("rkllm.embed: rkllm_run failed for text %d (code %d)", text, result);
+            return embed_error(-32000, "RKLLM run failed");
+        }
+        if (batch->failed) {
+            return embed_error(-32000, "Failed to collect hidden states");
+        }
+    }
+    
+    for (int i = 0; i < batch->count; i++) {
+        if (batch->tokens[i] == 0) {
+            return embed_error(-32000, "Model returned no hidden states; is it an RKLLM model with hidden layer output?");
+        }
+    }
+    return NULL;
+}
+
+static void normalize_vectors(EmbedBatch* batch) {
+    for (int i = 0; i < batch->count; i++) {
+        float* vector = batch->vectors + (size_t)i * (size_t)batch->dimensions;
+        float norm = sqrtf(sum_of_squares(vector, batch->dimensions));
+        if (norm > 0.0f) {
+            scale_vector(vector, 1.0f / norm, batch->dimensions);
+        }
+    }
+}
+
+/**
+ * Sends all vectors as one binary tensor frame of shape [count, dimensions]
+ * @return NULL once queued or an error object
+ */
+static json_object* send_binary_vectors(EmbedBatch* batch, TensorDtype dtype,
+                                        Connection* conn, json_object* request_id) {
+    StreamWriter writer;
+    if (init_stream_writer(&writer, request_id) != 0) {
+        return embed_error(-32000, "Memory allocation failed");
+    }
+    
+    size_t byte_length = 0;
+    size_t header_len = 0;
+    const void* payload = encode_tensor_payload(&writer, batch->vectors,
+                                                (size_t)batch->count * (size_t)batch->dimensions,
+                                                dtype, &byte_length);
+    const char* header = payload ? format_tensor_header(&writer, "embeddings", dtype, batch->count,
+                                                        batch->dimensions, byte_length,
+                                                        RKLLM_RUN_FINISH, &header_len) : NULL;
+    if (!header) {
+        free_stream_writer(&writer);
+        return embed_error(-32000, "Memory allocation failed");
+    }
+    
+    struct iovec iov[2];
+    iov[0].iov_base = (void*)header;
+    iov[0].iov_len = header_len;
+    iov[1].iov_base = (void*)payload;
+    iov[1].iov_len = byte_length;
+    if (queue_output(conn, iov, 2) < 0) {
+        LOG_WARN_MSG("rkllm.embed: client left before the vectors were sent");
+    }
+    free_stream_writer(&writer);
+    return NULL;
+}
+
+/**
+ * Describes the vectors with one base64 string of little-endian values each
+ */
+static json_object* describe_vectors(EmbedBatch* batch, TensorDtype dtype, const char* model_id,
+                                     int normalize, json_object* request_id) {
+    StreamWriter writer;
+    if (init_stream_writer(&writer, request_id) != 0) {
+        return embed_error(-32000, "Memory allocation failed");
+    }
+    
+    size_t byte_length = 0;
+    const unsigned char* payload = encode_tensor_payload(&writer, batch->vectors,
+                                                         (size_t)batch->count * (size_t)batch->dimensions,
+                                                         dtype, &byte_length);
+    size_t row_bytes = byte_length / (size_t)batch->count;
+    char* text = payload ? malloc(base64_encoded_length(row_bytes) + 1) : NULL;
+    if (!text) {
+        free_stream_writer(&writer);
+        return embed_error(-32000, "Memory allocation failed");
+    }
+    
+    json_object* embeddings = json_object_new_array();
+    json_object* tokens = json_object_new_array();
+    for (int i = 0; i < batch->count; i++) {
+        base64_encode(payload + (size_t)i * row_bytes, row_bytes, text);
+        json_object_array_add(embeddings, json_object_new_string_len(text, (int)base64_encoded_length(row_bytes)));
+        json_object_array_add(tokens, json_object_new_int(batch->tokens[i]));
+    }
+    free(text);
+    free_stream_writer(&writer);
+    
+    json_object* result = json_object_new_object();
+    json_object_object_add(result, "model", json_object_new_string(model_id));
+    json_object_object_add(result, "dimensions", json_object_new_int(batch->dimensions));
+    json_object_object_add(result, "dtype", json_object_new_string(dtype == TENSOR_FLOAT16 ? "float16" : "float32"));
+    json_object_object_add(result, "pooling", json_object_new_string(batch->pooling == POOL_MEAN ? "mean" : "last"));
+    json_object_object_add(result, "normalized", json_object_new_boolean(normalize));
+    json_object_object_add(result, "embeddings", embeddings);
+    json_object_object_add(result, "tokens", tokens);
+    return result;
+}
+
+json_object* call_rkllm_embed(json_object* params, Connection* conn, json_object* request_id) {
+    if (!params || !json_object_is_type(params, json_type_object)) {
+        return embed_error(-32602, "Invalid parameters - expected object");
+    }
+    
+    json_object* texts = NULL;
+    if (!json_object_object_get_ex(params, "texts", &texts) || !json_object_is_type(texts, json_type_array)) {
+        return embed_error(-32602, "Missing required parameter: texts (array of strings)");
+    }
+    int count = (int)json_object_array_length(texts);
+    if (count == 0 || count > MAX_EMBED_TEXTS) {
+        return embed_error(-32602, "texts must hold between 1 and 1024 strings");
+    }
+    for (int i = 0; i < count; i++) {
+        if (!json_object_is_type(json_object_array_get_idx(texts, (size_t)i), json_type_string)) {
+            return embed_error(-32602, "texts must only contain strings");
+        }
+    }
+    
+    const char* pooling = get_string_field(params, "pooling", "last");
+    const char* dtype_name = get_string_field(params, "dtype", "float16");
+    const char* encoding = get_string_field(params, "encoding", "base64");
+    if (strcmp(pooling, "last") != 0 && strcmp(pooling, "mean") != 0) {
+        return embed_error(-32602, "pooling must be \"last\" or \"mean\"");
+    }
+    if (strcmp(dtype_name, "float16") != 0 && strcmp(dtype_name, "float32") != 0) {
+        return embed_error(-32602, "dtype must be \"float16\" or \"float32\"");
+    }
+    if (strcmp(encoding, "base64") != 0 && strcmp(encoding, "binary") != 0) {
+        return embed_error(-32602, "encoding must be \"base64\" or \"binary\"");
+    }
+    TensorDtype dtype = strcmp(dtype_name, "float16") == 0 ? TENSOR_FLOAT16 : TENSOR_FLOAT32;
+    int normalize = extract_bool_param(params, "normalize", 1);
+    
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    EmbedBatch batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.pooling = strcmp(pooling, "mean") == 0 ? POOL_MEAN : POOL_LAST;
+    batch.count = count;
+    batch.tokens = calloc((size_t)count, sizeof(int));
+    if (!batch.tokens) {
+        release_model(model);
+        return embed_error(-32000, "Memory allocation failed");
+    }
+    
+    json_object* result = run_hidden_states(model, texts, get_string_field(params, "role", "user"),
+                                            &batch, conn, request_id);
+    if (!result) {
+        if (normalize) {
+            normalize_vectors(&batch);
+        }
+        LOG_INFO_MSG("rkllm.embed: %d texts, %d dimensions, %s pooling", count, batch.dimensions, pooling);
+        if (strcmp(encoding, "binary") == 0) {
+            result = send_binary_vectors(&batch, dtype, conn, request_id);
+        } else {
+            result = describe_vectors(&batch, dtype, model->id, normalize, request_id);
+        }
+    }
+    
+    release_model(model);
+    free(batch.vectors);
+    free(batch.tokens);
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#ifndef CALL_RKLLM_EMBED_H
+#define CALL_RKLLM_EMBED_H
+
+#include <json-c/json.h>
+#include "../../connection/create_connection/create_connection.h"
+
+// Texts accepted by one rkllm.embed call
+#define MAX_EMBED_TEXTS 1024
+
+/**
+ * Embeds a batch of texts: each text runs in RKLLM_INFER_GET_LAST_HIDDEN_LAYER
+ * mode (n_batch texts per rkllm_run), its hidden states are pooled to one
+ * vector and optionally L2-normalized
+ * @param params Object with "texts" (array of strings) and optional "model",
+ *               "role", "pooling" ("last" or "mean"), "normalize" (default true),
+ *               "dtype" ("float16" or "float32") and "encoding" ("base64" or "binary")
+ * @param conn Connection receiving the binary frame when encoding is "binary"
+ * @param request_id JSON-RPC request id
+ * @return Result with base64 vectors, error object, or NULL once the binary frame is queued
+ */
+json_object* call_rkllm_embed(json_object* params, Connection* conn, json_object* request_id);
+
+#endif
\ No newline at end of file
@@ -1,27 +1,23 @@
 #include "call_rkllm_get_kv_cache_size.h"
+#include "../manage_model_registry/manage_model_registry.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
 #include <rkllm.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-// External reference to global LLM handle and state from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-
-json_object* call_rkllm_get_kv_cache_size(void) {
-    // Validate that model is initialized
-    if (!global_llm_initialized || !global_llm_handle) {
+static json_object* get_kv_cache_size_with_model(ModelEntry* model) {
+    // The runtime writes one size per batch slot
+    int n_batch = model->n_batch > 0 ? model->n_batch : 1;
+    int* cache_sizes = calloc((size_t)n_batch, sizeof(int));
+    if (!cache_sizes) {
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Model not initialized - call rkllm.init first"));
+        json_object_object_add(error_result, "message", json_object_new_string("Memory allocation failed"));
         return error_result;
     }
     
-    // Allocate array for cache sizes (assuming max 8 batches for safety)
-    int cache_sizes[8] = {0};
-    
     // Call rkllm_get_kv_cache_size
-    int result = rkllm_get_kv_cache_size(global_llm_handle, cache_sizes);
+    int result = rkllm_get_kv_cache_size(model->handle, cache_sizes);
     
     if (result == 0) {
         // Success - create JSON array with cache sizes
@@ -29,21 +25,33 @@ json_object* call_rkllm_get_kv_cache_size(void) {
         json_object_object_add(result_obj, "success", json_object_new_boolean(1));
         json_object_object_add(result_obj, "message", json_object_new_string("KV cache size retrieved successfully"));
         
-        // Create array of cache sizes
+        // One entry per batch slot, empty slots included so indexes line up
         json_object* sizes_array = json_object_new_array();
-        for (int i = 0; i < 8; i++) {
-            if (cache_sizes[i] > 0) {
-                json_object_array_add(sizes_array, json_object_new_int(cache_sizes[i]));
-            }
+        for (int i = 0; i < n_batch; i++) {
+            json_object_array_add(sizes_array, json_object_new_int(cache_sizes[i]));
         }
         json_object_object_add(result_obj, "cache_sizes", sizes_array);
+        json_object_object_add(result_obj, "n_batch", json_object_new_int(n_batch));
         
+        free(cache_sizes);
         return result_obj;
     } else {
         // Error occurred
+        free(cache_sizes);
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32001));
         json_object_object_add(error_result, "message", json_object_new_string("Failed to retrieve KV cache size"));
         return error_result;
     }
+}
+
+json_object* call_rkllm_get_kv_cache_size(json_object* params) {
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    json_object* result = get_kv_cache_size_with_model(model);
+    release_model(model);
+    return result;
 }
\ No newline at end of file
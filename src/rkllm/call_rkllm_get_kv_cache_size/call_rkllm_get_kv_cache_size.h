@@ -6,8 +6,9 @@
 /**
  * Gets the current size of the key-value cache for a given LLM handle
  * Maps to: int rkllm_get_kv_cache_size(LLMHandle handle, int* cache_sizes)
+ * @param params Optional object whose "model" field names the model (default: newest)
  * @return JSON object with cache sizes or error status
  */
-json_object* call_rkllm_get_kv_cache_size(void);
+json_object* call_rkllm_get_kv_cache_size(json_object* params);
 
 #endif
\ No newline at end of file
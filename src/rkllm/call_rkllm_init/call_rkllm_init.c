@@ -2,6 +2,8 @@
 
 #include "call_rkllm_init.h"
 #include "../manage_streaming_context/manage_streaming_context.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../manage_model_loads/manage_model_loads.h"
 #include "../../jsonrpc/format_response/format_response.h"
 #include "../../jsonrpc/extract_string_param/extract_string_param.h"
 #include "../../jsonrpc/extract_int_param/extract_int_param.h"
@@ -9,6 +11,8 @@
 #include "../../jsonrpc/extract_object_param/extract_object_param.h"
 #include "../../utils/log_message/log_message.h"
 #include "../../utils/global_config/global_config.h"
+#include "../../connection/manage_output_queue/manage_output_queue.h"
+#include "../../connection/send_to_connection/send_to_connection.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <rkllm.h>
@@ -19,101 +23,391 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <unistd.h>
-#include <signal.h>
-#include <sys/wait.h>
+#include <errno.h>
+#include <sys/stat.h>
 
-// Global state - only ONE model can be loaded at a time
-LLMHandle global_llm_handle = NULL;
-int global_llm_initialized = 0;
+static long long get_monotonic_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * Queues one encoded frame on the stream's connection
+ * @return Bytes accepted, or -1 if the frame is missing or the client is gone
+ */
+static int queue_stream_frame(StreamingContext* context, const char* frame, size_t frame_len) {
+    if (!frame) {
+        LOG_ERROR_MSG("Failed to encode token frame for request %s", context->request_id);
+        return 0;
+    }
+    
+    struct iovec iov;
+    iov.iov_base = (void*)frame;
+    iov.iov_len = frame_len;
+    return queue_output(context->conn, &iov, 1);
+}
+
+/**
+ * Sends a tensor as a header frame followed by its raw bytes, queued
+ * together so no other frame lands in between
+ * @return Bytes accepted, or -1 if the client is gone
+ */
+static int queue_tensor_frame(StreamingContext* context, const char* name,
+                              const float* values, int rows, int cols) {
+    TensorDtype dtype = context->options.tensor_dtype;
+    size_t byte_length = 0;
+    const void* payload = encode_tensor_payload(&context->writer, values,
+                                                (size_t)rows * (size_t)cols, dtype, &byte_length);
+    if (!payload) {
+        LOG_ERROR_MSG("Failed to encode %s for request %s", name, context->request_id);
+        return 0;
+    }
+    
+    size_t header_len = 0;
+    const char* header = format_tensor_header(&context->writer, name, dtype, rows, cols,
+                                              byte_length, RKLLM_RUN_NORMAL, &header_len);
+    if (!header) {
+        LOG_ERROR_MSG("Failed to encode %s header for request %s", name, context->request_id);
+        return 0;
+    }
+    
+    struct iovec iov[2];
+    iov[0].iov_base = (void*)header;
+    iov[0].iov_len = header_len;
+    iov[1].iov_base = (void*)payload;
+    iov[1].iov_len = byte_length;
+    return queue_output(context->conn, iov, 2);
+}
+
+/**
+ * Queues the frame that ends a stream; a finished run carries its timings
+ * @param finish_reason Set when the server ended the run (stop sequence or max_tokens)
+ * @param perf Runtime statistics (NULL when the server ended the run)
+ * @return Bytes accepted, or -1 if the client is gone
+ */
+static int send_final_frame(StreamingContext* context, const char* text, int token_id, int state,
+                            const char* finish_reason, const RKLLMPerfStat* perf) {
+    json_object* perf_obj = NULL;
+    if (state == RKLLM_RUN_FINISH) {
+        perf_obj = finish_run_timings(&context->timings, perf);
+    }
+    
+    size_t frame_len = 0;
+    const char* frame = format_final_frame(&context->writer, text, token_id, state, finish_reason,
+                                           perf_obj ? json_object_to_json_string_ext(perf_obj, JSON_C_TO_STRING_PLAIN) : NULL,
+                                           &frame_len);
+    if (perf_obj) {
+        json_object_put(perf_obj);
+    }
+    return queue_stream_frame(context, frame, frame_len);
+}
+
+/**
+ * Marks the stream as ended; a detached (async) context is freed here
+ * because no caller is waiting to do it
+ */
+static void end_stream(StreamingContext* context) {
+    context->is_active = 0;
+    if (context->detached) {
+        free_streaming_context(context);
+    }
+}
 
-// Signal handler for timeout
-static volatile int init_timeout = 0;
-void timeout_handler(int sig) {
-    init_timeout = 1;
+/**
+ * Ends a stream that did not finish; its partial reply is dropped so a
+ * session does not record it
+ */
+static void abandon_stream(StreamingContext* context) {
+    free(context->reply);
+    context->reply = NULL;
+    end_stream(context);
 }
 
 int global_rkllm_callback(RKLLMResult* result, void* userdata, LLMCallState state) {
     // Log callback invocation for monitoring
     LOG_DEBUG_MSG("Callback called - state: %d, text: %s", state, result ? (result->text ? result->text : "NULL") : "result=NULL");
     
-    // Get current streaming context
-    StreamingContext* context = get_streaming_context();
-    if (!context) {
+    // Every run passes its own streaming context, so overlapping runs never
+    // share a client or request id
+    StreamingContext* context = (StreamingContext*)userdata;
+    if (!context || !context->is_active) {
         // No active streaming context - ignore callback (during init)
         LOG_DEBUG_MSG("No streaming context, ignoring callback");
         return 0;
     }
     
-    // Convert RKLLM result to JSON using individual functions
-    json_object* result_json = json_object_new_object();
-    if (result) {
-        // Add text field
-        if (result->text) {
-            json_object_object_add(result_json, "text", json_object_new_string(result->text));
-        } else {
-            json_object_object_add(result_json, "text", NULL);
+    // Runs consumed on the server send nothing to the client
+    if (context->sink) {
+        if (state == RKLLM_RUN_NORMAL && result) {
+            context->sink(context->sink_data, result);
+        } else if (state == RKLLM_RUN_FINISH) {
+            end_stream(context);
+        } else if (state == RKLLM_RUN_ERROR) {
+            abandon_stream(context);
+        }
+        return 0;
+    }
+    
+    // Frames are encoded straight into the stream's reusable buffer and
+    // queued with a single write; the lock keeps the deadline flush of the
+    // I/O worker out of the buffer meanwhile
+    int sent = 0;
+    pthread_mutex_lock(&context->lock);
+    if (state == RKLLM_RUN_NORMAL && result &&
+        (result->last_hidden_layer.hidden_states || result->logits.logits)) {
+        // GET_LAST_HIDDEN_LAYER / GET_LOGITS: the tensor goes out as binary,
+        // after any buffered text
+        sent = flush_stream_tokens(context);
+        record_run_token(&context->timings);
+        if (sent >= 0 && result->last_hidden_layer.hidden_states) {
+            sent = queue_tensor_frame(context, "hidden_states", result->last_hidden_layer.hidden_states,
+                                      result->last_hidden_layer.num_tokens, result->last_hidden_layer.embd_size);
+        }
+        if (sent >= 0 && result->logits.logits) {
+            sent = queue_tensor_frame(context, "logits", result->logits.logits,
+                                      result->logits.num_tokens, result->logits.vocab_size);
+        }
+    } else if (state == RKLLM_RUN_NORMAL || state == RKLLM_RUN_WAITING) {
+        // Text that may be the start of a stop sequence is held back until
+        // it completes one (and is dropped) or diverges. WAITING carries
+        // part of a multibyte character, which may be part of a stop
+        // sequence too, so it goes through the same path
+        const char* text = result ? result->text : NULL;
+        int stop_index = context->stop ? feed_stop_matcher(context->stop, text, &text) : -1;
+        
+        // Buffer the token and emit once the batch is full or old enough
+        if (append_stream_token(&context->writer, text, result ? result->token_id : 0) != 0) {
+            LOG_ERROR_MSG("Failed to buffer token for request %s", context->request_id);
+        }
+        append_stream_reply(context, text);
+        record_run_token(&context->timings);
+        context->token_count++;
+        
+        // A stop sequence or max_tokens ends the run on this token: the
+        // final frame goes out now and the run is aborted rather than
+        // paused, so no half-generated turn is left for the next rkllm_run
+        // on the handle (a session run keeps its history) to resume. Later
+        // callbacks of the aborted run find the stream ended
+        if (stop_index >= 0 || (context->max_tokens > 0 && context->token_count >= context->max_tokens)) {
+            LOG_DEBUG_MSG("Request %s reached %s after %d tokens", context->request_id,
+                          stop_index >= 0 ? "a stop sequence" : "max_tokens", context->token_count);
+            flush_stream_tokens(context);
+            send_final_frame(context, NULL, 0, RKLLM_RUN_FINISH, stop_index >= 0 ? "stop" : "length", NULL);
+            pthread_mutex_unlock(&context->lock);
+            
+            // A detached context is freed by end_stream
+            LLMHandle handle = context->model ? context->model->handle : NULL;
+            context->aborted = 1;
+            end_stream(context);
+            if (handle) {
+                rkllm_abort(handle);
+            }
+            return 0;
         }
         
-        // Add token_id field
-        json_object_object_add(result_json, "token_id", json_object_new_int(result->token_id));
+        long long now_ms = get_monotonic_ms();
+        int batch_started = context->writer.pending_count == 1;
+        if (batch_started) {
+            context->batch_start_ms = now_ms;
+        }
+        
+        // A batch ending in part of a character waits for the rest of it
+        context->partial_char = state == RKLLM_RUN_WAITING;
+        const StreamOptions* options = &context->options;
+        if (!context->partial_char &&
+            ((options->flush_tokens > 0 && context->writer.pending_count >= options->flush_tokens) ||
+             (options->flush_ms > 0 && now_ms - context->batch_start_ms >= options->flush_ms))) {
+            sent = flush_stream_tokens(context);
+        } else if (batch_started && options->flush_ms > 0) {
+            // The I/O worker sends the batch if no token arrives before its deadline
+            wake_stream_deadlines();
+        }
+    } else if (state == RKLLM_RUN_FINISH || state == RKLLM_RUN_ERROR) {
+        // The final state ends the batch; buffered tokens go out first
+        sent = flush_stream_tokens(context);
         
-        // Add callback state
-        json_object_object_add(result_json, "_callback_state", json_object_new_int(state));
+        // Final text is matched like any token; held-back text never
+        // completed a stop sequence, so it belongs to the reply after all
+        int stop_index = -1;
+        const char* text = finish_stop_matcher(context->stop, result ? result->text : NULL, &stop_index);
+        append_stream_reply(context, text);
+        
+        // The final frame carries the run's runtime and server timings
+        int final_sent = send_final_frame(context, text, result ? result->token_id : 0, state,
+                                          stop_index >= 0 ? "stop" : NULL, result ? &result->perf : NULL);
+        if (sent >= 0) {
+            sent = final_sent;
+        }
     }
+    pthread_mutex_unlock(&context->lock);
     
-    // Create JSON-RPC response with streaming data
-    json_object* id_obj = json_object_new_int(context->request_id);
-    char* response_str = format_response(id_obj, result_json);
-    json_object_put(id_obj);
-    json_object_put(result_json);
-    
-    if (!response_str) {
+    // The stream ends with its final state
+    if (state == RKLLM_RUN_FINISH) {
+        end_stream(context);
+        return 0;
+    }
+    if (state == RKLLM_RUN_ERROR) {
+        abandon_stream(context);
         return 0;
     }
     
-    // Send streaming response directly to client
-    ssize_t bytes_sent = send(context->client_fd, response_str, strlen(response_str), MSG_NOSIGNAL);
-    bytes_sent += send(context->client_fd, "\n", 1, MSG_NOSIGNAL);
-    free(response_str);
+    // According to rkllm.h: 0=continue, 1=pause. Pausing suspends the run
+    // until rkllm_run is called again, so it is reserved for clients that
+    // are gone or stopped reading
+    if (sent < 0) {
+        LOG_WARN_MSG("Client of request %s is gone, pausing generation", context->request_id);
+        abandon_stream(context);
+        return 1;
+    }
     
-    // Clear context if this is the final state
-    if (state == RKLLM_RUN_FINISH || state == RKLLM_RUN_ERROR) {
-        clear_streaming_context();
+    // Backpressure: a slow reader holds generation here (the callback runs
+    // on the generation thread) until half of its backlog is written
+    size_t high_water = (size_t)get_output_high_water();
+    if (get_queued_output(context->conn) > high_water &&
+        wait_for_output_drain(context->conn, high_water / 2, get_output_stall_timeout_ms()) != 0) {
+        LOG_WARN_MSG("Client of request %s stalled with %zu bytes queued, pausing generation",
+                     context->request_id, get_queued_output(context->conn));
+        
+        // The client is alive, so it learns that its stream ended
+        pthread_mutex_lock(&context->lock);
+        size_t frame_len = 0;
+        const char* frame = format_error_frame(&context->writer, -32000, "Client too slow; generation stopped", &frame_len);
+        queue_stream_frame(context, frame, frame_len);
+        pthread_mutex_unlock(&context->lock);
+        abandon_stream(context);
+        return 1;
     }
     
-    (void)userdata;
-    // Always return 0 to continue inference normally 
-    // According to rkllm.h: 0=continue, 1=pause (we never want to pause)
     return 0;
 }
 
-// Structure for passing data to init thread
+// Structure for passing data to init thread; owned by the load thread,
+// or by the init thread once the load has timed out
 typedef struct {
     RKLLMParam param;
-    int* result;
-    pthread_mutex_t* mutex;
-    pthread_cond_t* cond;
-    int* finished;
+    LLMHandle handle;
+    int result;
+    int finished;               // rkllm_init returned
+    int abandoned;              // Load timed out; the init thread cleans up
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    char* model_path;           // param.model_path points here
+    char model_id[MODEL_ID_LENGTH];
+    size_t memory_bytes;
+    int reservation;            // Registry room held for the model
+    int timeout_ms;
+    int load_id;
 } InitThreadData;
 
+static void free_init_data(InitThreadData* data) {
+    pthread_mutex_destroy(&data->mutex);
+    pthread_cond_destroy(&data->cond);
+    free(data->model_path);
+    free(data);
+}
+
 // Thread function for rkllm_init
 void* rkllm_init_thread(void* arg) {
     InitThreadData* data = (InitThreadData*)arg;
     
     // Call rkllm_init in separate thread context
-    int init_result = rkllm_init(&global_llm_handle, &data->param, global_rkllm_callback);
+    LLMHandle handle = NULL;
+    int init_result = rkllm_init(&handle, &data->param, global_rkllm_callback);
     
     // Signal completion
-    pthread_mutex_lock(data->mutex);
-    *(data->result) = init_result;
-    *(data->finished) = 1;
-    pthread_cond_signal(data->cond);
-    pthread_mutex_unlock(data->mutex);
+    pthread_mutex_lock(&data->mutex);
+    data->handle = handle;
+    data->result = init_result;
+    data->finished = 1;
+    int abandoned = data->abandoned;
+    pthread_cond_signal(&data->cond);
+    pthread_mutex_unlock(&data->mutex);
+    
+    // Nobody is waiting any more: a late model is never registered, and
+    // its room is held until its memory is actually freed
+    if (abandoned) {
+        LOG_WARN_MSG("Model load %d finished after its timeout, discarding it", data->load_id);
+        if (init_result == 0 && handle) {
+            rkllm_destroy(handle);
+        }
+        cancel_model_reservation(data->reservation);
+        free_init_data(data);
+    }
+    
+    return NULL;
+}
+
+/**
+ * Runs one rkllm.init in the background: makes room in the registry,
+ * waits for rkllm_init up to the init timeout and registers the model
+ */
+static void* model_load_thread(void* arg) {
+    InitThreadData* data = (InitThreadData*)arg;
+    
+    // Evict least recently used models until this one fits; the room stays
+    // held so a concurrent load cannot take it while rkllm_init runs
+    data->reservation = reserve_model_memory(data->memory_bytes, data->model_id);
+    if (data->reservation < 0) {
+        set_model_load_state(data->load_id, MODEL_LOAD_FAILED,
+                             "Model memory budget exceeded - resident models are in use");
+        free_init_data(data);
+        return NULL;
+    }
     
+    set_model_load_state(data->load_id, MODEL_LOAD_INITIALIZING, NULL);
+    
+    // rkllm_init cannot be interrupted, so it runs on its own thread and
+    // this one stops waiting at the deadline
+    pthread_t init_thread;
+    if (pthread_create(&init_thread, NULL, rkllm_init_thread, data) != 0) {
+        set_model_load_state(data->load_id, MODEL_LOAD_FAILED, "Failed to start init thread");
+        cancel_model_reservation(data->reservation);
+        free_init_data(data);
+        return NULL;
+    }
+    pthread_detach(init_thread);
+    
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += data->timeout_ms / 1000;
+    deadline.tv_nsec += (long)(data->timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    
+    pthread_mutex_lock(&data->mutex);
+    int wait_result = 0;
+    while (!data->finished && wait_result != ETIMEDOUT) {
+        wait_result = pthread_cond_timedwait(&data->cond, &data->mutex, &deadline);
+    }
+    if (!data->finished) {
+        data->abandoned = 1;
+        pthread_mutex_unlock(&data->mutex);
+        set_model_load_state(data->load_id, MODEL_LOAD_TIMEOUT, "Model initialization timeout");
+        return NULL;
+    }
+    pthread_mutex_unlock(&data->mutex);
+    
+    if (data->result != 0) {
+        cancel_model_reservation(data->reservation);
+        set_model_load_state(data->load_id, MODEL_LOAD_FAILED, "RKLLM initialization failed");
+    } else if (register_model(data->model_id, data->model_path, data->handle,
+                              data->param.extend_param.n_batch, data->reservation) != 0) {
+        // Success would hand the handle and the reservation to the registry
+        rkllm_destroy(data->handle);
+        cancel_model_reservation(data->reservation);
+        set_model_load_state(data->load_id, MODEL_LOAD_FAILED, "Failed to register model");
+    } else {
+        set_model_load_state(data->load_id, MODEL_LOAD_READY, NULL);
+    }
+    
+    free_init_data(data);
     return NULL;
 }
 
-json_object* call_rkllm_init(json_object* params) {
+json_object* call_rkllm_init(json_object* params, Connection* conn, json_object* request_id) {
     // Standardized: Accept JSON object parameters directly
     if (!params || !json_object_is_type(params, json_type_object)) {
         json_object* error_result = json_object_new_object();
@@ -122,13 +416,6 @@ json_object* call_rkllm_init(json_object* params) {
         return error_result;
     }
     
-    // Only ONE model can be loaded at a time - destroy existing if needed
-    if (global_llm_initialized && global_llm_handle) {
-        rkllm_destroy(global_llm_handle);
-        global_llm_handle = NULL;
-        global_llm_initialized = 0;
-    }
-    
     // Extract model_path - REQUIRED field (directly from params)
     char* model_path = extract_string_param(params, "model_path", NULL);
     if (!model_path) {
@@ -138,6 +425,33 @@ json_object* call_rkllm_init(json_object* params) {
         return error_result;
     }
     
+    InitThreadData* data = calloc(1, sizeof(InitThreadData));
+    if (!data) {
+        free(model_path);
+        return NULL;
+    }
+    data->model_path = model_path;
+    
+    // Registry id: explicit, or the model file name without extension
+    const char* requested_id = get_model_name(params);
+    if (requested_id) {
+        snprintf(data->model_id, sizeof(data->model_id), "%s", requested_id);
+    } else {
+        const char* base = strrchr(model_path, '/');
+        snprintf(data->model_id, sizeof(data->model_id), "%s", base ? base + 1 : model_path);
+        char* ext = strrchr(data->model_id, '.');
+        if (ext && ext != data->model_id) {
+            *ext = '\0';
+        }
+        if (data->model_id[0] == '\0') {
+            snprintf(data->model_id, sizeof(data->model_id), "default");
+        }
+    }
+    
+    // Resident size is estimated from the model file
+    struct stat model_stat;
+    data->memory_bytes = stat(model_path, &model_stat) == 0 ? (size_t)model_stat.st_size : 0;
+    
     // Convert JSON to RKLLMParam using individual extraction functions
     RKLLMParam rkllm_param = rkllm_createDefaultParam();
     
@@ -152,6 +466,26 @@ json_object* call_rkllm_init(json_object* params) {
         rkllm_param.temperature = extract_float_param(param_obj, "temperature", rkllm_param.temperature);
         rkllm_param.repeat_penalty = extract_float_param(param_obj, "repeat_penalty", rkllm_param.repeat_penalty);
         // num_npu_core is handled through model initialization, not RKLLMParam
+        
+        // Batch slots per forward pass, named as in rkllm.createDefaultParam
+        json_object* extend_obj = extract_object_param(param_obj, "extend_param");
+        if (extend_obj) {
+            int n_batch = extract_int_param(extend_obj, "n_batch", rkllm_param.extend_param.n_batch);
+            json_object_put(extend_obj);
+            if (n_batch < 1 || n_batch > 255) {
+                json_object_put(param_obj);
+                free(model_path);
+                free(data);
+                json_object* error_result = json_object_new_object();
+                json_object_object_add(error_result, "code", json_object_new_int(-32602));
+                json_object_object_add(error_result, "message", json_object_new_string("extend_param.n_batch must be between 1 and 255"));
+                return error_result;
+            }
+            rkllm_param.extend_param.n_batch = (uint8_t)n_batch;
+        }
+        
+        // extract_object_param returns a new reference
+        json_object_put(param_obj);
     }
     
     // Set model path - CRITICAL!
@@ -170,58 +504,70 @@ json_object* call_rkllm_init(json_object* params) {
     LOG_INFO_MSG("RKLLM Init Debug - max_new_tokens: %d", rkllm_param.max_new_tokens);
     LOG_INFO_MSG("RKLLM Init Debug - temperature: %f", rkllm_param.temperature);
     LOG_INFO_MSG("RKLLM Init Debug - top_k: %d", rkllm_param.top_k);
+    LOG_INFO_MSG("RKLLM Init Debug - n_batch: %d", rkllm_param.extend_param.n_batch);
     
-    // Install signal handler for timeout
-    struct sigaction old_action;
-    struct sigaction timeout_action;
-    timeout_action.sa_handler = timeout_handler;
-    sigemptyset(&timeout_action.sa_mask);
-    timeout_action.sa_flags = 0;
-    sigaction(SIGALRM, &timeout_action, &old_action);
-    
-    // Reset timeout flag
-    init_timeout = 0;
-    
-    // Set alarm for configurable timeout
-    int timeout_seconds = get_init_timeout() / 1000; // Convert ms to seconds
-    if (timeout_seconds <= 0) timeout_seconds = 30; // Fallback to 30 seconds
-    alarm(timeout_seconds);
-    
-    // Call rkllm_init directly  
-    int init_result = rkllm_init(&global_llm_handle, &rkllm_param, global_rkllm_callback);
-    
-    // Cancel alarm and restore signal handler
-    alarm(0);
-    sigaction(SIGALRM, &old_action, NULL);
-    
-    // Check if timeout occurred
-    if (init_timeout) {
-        // Timeout occurred during init
-        if (model_path) free(model_path);
+    data->param = rkllm_param;
+    data->timeout_ms = get_init_timeout();
+    if (data->timeout_ms <= 0) data->timeout_ms = 30000; // Fallback to 30 seconds
+    
+    // The deadline is measured on the monotonic clock
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&data->cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    pthread_mutex_init(&data->mutex, NULL);
+    
+    int active_id = 0;
+    data->load_id = begin_model_load(data->model_id, data->memory_bytes, data->timeout_ms,
+                                     conn, request_id, &active_id);
+    if (data->load_id < 0) {
+        char message[MODEL_ID_LENGTH + 64];
+        if (active_id > 0) {
+            snprintf(message, sizeof(message), "Model '%s' is already loading (load_id %d)", data->model_id, active_id);
+        } else {
+            snprintf(message, sizeof(message), "Too many model loads in progress");
+        }
+        free_init_data(data);
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Model initialization timeout"));
+        json_object_object_add(error_result, "message", json_object_new_string(message));
         return error_result;
     }
     
-    // Clean up allocated strings
-    if (model_path) free(model_path);
+    // Loading takes seconds; the client gets the load id now and follows
+    // progress through rkllm.init_status. The response goes out before the
+    // load thread starts, so no notification can overtake it
+    int load_id = data->load_id;
+    json_object* result = get_model_load_status(load_id);
+    if (result) {
+        json_object_object_add(result, "success", json_object_new_boolean(1));
+    }
+    if (conn && result) {
+        char* response_str = format_response(request_id, result);
+        json_object_put(result);
+        result = NULL;
+        if (response_str) {
+            send_to_connection(conn, response_str, strlen(response_str));
+            free(response_str);
+        }
+    }
     
-    if (init_result != 0) {
-        // RKLLM init failed - return proper error instead of NULL
+    pthread_t load_thread;
+    if (pthread_create(&load_thread, NULL, model_load_thread, data) != 0) {
+        set_model_load_state(load_id, MODEL_LOAD_FAILED, "Failed to start load thread");
+        free_init_data(data);
+        if (!result) {
+            // The client learns of the failure from the final notification
+            return NULL;
+        }
+        json_object_put(result);
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("RKLLM initialization failed"));
+        json_object_object_add(error_result, "message", json_object_new_string("Failed to start model load"));
         return error_result;
     }
-    
-    // Success - mark as initialized
-    global_llm_initialized = 1;
-    
-    // Return success result
-    json_object* result = json_object_new_object();
-    json_object_object_add(result, "success", json_object_new_boolean(1));
-    json_object_object_add(result, "message", json_object_new_string("Model initialized successfully"));
+    pthread_detach(load_thread);
     
     return result;
 }
\ No newline at end of file
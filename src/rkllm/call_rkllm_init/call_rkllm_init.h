@@ -4,19 +4,22 @@
 #include <json-c/json.h>
 #include <stdbool.h>
 #include <rkllm.h>
+#include "../../connection/create_connection/create_connection.h"
 
 /**
- * Global LLMHandle - only ONE model can be loaded at a time
+ * Starts loading a model on a background thread and returns at once; the
+ * handle is registered in the model registry under params.model (default:
+ * the file name of model_path without extension) when rkllm_init finishes
+ * within the init timeout. Progress is sent to the client as
+ * rkllm.init_status notifications and can be polled with rkllm.init_status
+ * @param params JSON object with model_path, optional model and param
+ * @param conn Client notified of each load stage; it gets the response
+ *        before any notification (may be NULL)
+ * @param request_id JSON-RPC request id echoed in the notifications
+ * @return JSON object with the load_id and initial state (success/error),
+ *         or NULL once the response was sent to conn
  */
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-
-/**
- * Calls rkllm_init with parameters from JSON-RPC request
- * @param params JSON array containing RKLLMParam object
- * @return JSON response object (success/error)
- */
-json_object* call_rkllm_init(json_object* params);
+json_object* call_rkllm_init(json_object* params, Connection* conn, json_object* request_id);
 
 /**
  * Global RKLLM callback function for streaming
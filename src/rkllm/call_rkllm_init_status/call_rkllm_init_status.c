@@ -0,0 +1,25 @@
+#include "call_rkllm_init_status.h"
+#include "../manage_model_loads/manage_model_loads.h"
+#include "../../jsonrpc/extract_int_param/extract_int_param.h"
+
+json_object* call_rkllm_init_status(json_object* params) {
+    int load_id = 0;
+    if (params && json_object_is_type(params, json_type_object)) {
+        load_id = extract_int_param(params, "load_id", 0);
+    }
+    
+    if (load_id <= 0) {
+        json_object* result = json_object_new_object();
+        json_object_object_add(result, "loads", list_model_loads());
+        return result;
+    }
+    
+    json_object* status = get_model_load_status(load_id);
+    if (!status) {
+        json_object* error_result = json_object_new_object();
+        json_object_object_add(error_result, "code", json_object_new_int(-32602));
+        json_object_object_add(error_result, "message", json_object_new_string("Unknown load_id"));
+        return error_result;
+    }
+    return status;
+}
\ No newline at end of file
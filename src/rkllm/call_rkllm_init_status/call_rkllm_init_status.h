@@ -0,0 +1,14 @@
+#ifndef CALL_RKLLM_INIT_STATUS_H
+#define CALL_RKLLM_INIT_STATUS_H
+
+#include <json-c/json.h>
+
+/**
+ * Reports the progress of background model loads started by rkllm.init
+ * @param params Optional object with the load_id returned by rkllm.init
+ * @return JSON object describing that load, or {"loads":[...]} with every
+ *         remembered load when no load_id is given
+ */
+json_object* call_rkllm_init_status(json_object* params);
+
+#endif
\ No newline at end of file
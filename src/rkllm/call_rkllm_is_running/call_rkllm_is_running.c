@@ -1,29 +1,29 @@
 #include "call_rkllm_is_running.h"
+#include "../manage_model_registry/manage_model_registry.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
 #include <stdbool.h>
 #include <rkllm.h>
 #include <json-c/json.h>
 
-// External reference to global LLM handle from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-
-json_object* call_rkllm_is_running(void) {
-    // Check if model is initialized
-    if (!global_llm_initialized || !global_llm_handle) {
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Model not initialized - call rkllm.init first"));
-        return error_result;
-    }
-    
+static json_object* is_running_with_model(ModelEntry* model) {
     // Call rkllm_is_running
-    int is_running = rkllm_is_running(global_llm_handle);
+    int is_running = rkllm_is_running(model->handle);
     
     // Return result
     json_object* result = json_object_new_object();
     json_object_object_add(result, "is_running", json_object_new_boolean(is_running == 0));
     json_object_object_add(result, "status_code", json_object_new_int(is_running));
     
+    return result;
+}
+
+json_object* call_rkllm_is_running(json_object* params) {
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    json_object* result = is_running_with_model(model);
+    release_model(model);
     return result;
 }
\ No newline at end of file
@@ -5,8 +5,9 @@
 
 /**
  * @brief Check if RKLLM task is currently running
+ * @param params Optional object whose "model" field names the model (default: newest)
  * @return JSON object with running status
  */
-json_object* call_rkllm_is_running(void);
+json_object* call_rkllm_is_running(json_object* params);
 
 #endif
\ No newline at end of file
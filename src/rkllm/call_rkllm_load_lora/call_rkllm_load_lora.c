@@ -1,4 +1,5 @@
 #include "call_rkllm_load_lora.h"
+#include "../manage_model_registry/manage_model_registry.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
 #include "../../jsonrpc/extract_string_param/extract_string_param.h"
 #include "../../jsonrpc/extract_float_param/extract_float_param.h"
@@ -7,19 +8,7 @@
 #include <string.h>
 #include <stdlib.h>
 
-// External reference to global LLM handle and state from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-
-json_object* call_rkllm_load_lora(json_object* params) {
-    // Validate that model is initialized
-    if (!global_llm_initialized || !global_llm_handle) {
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Model not initialized - call rkllm.init first"));
-        return error_result;
-    }
-    
+static json_object* load_lora_with_model(ModelEntry* model, json_object* params) {
     if (!params || !json_object_is_type(params, json_type_object)) {
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32602));
@@ -57,7 +46,7 @@ json_object* call_rkllm_load_lora(json_object* params) {
     lora_adapter.scale = extract_float_param(lora_obj, "scale", 1.0f);
     
     // Call rkllm_load_lora
-    int result = rkllm_load_lora(global_llm_handle, &lora_adapter);
+    int result = rkllm_load_lora(model->handle, &lora_adapter);
     
     // Clean up allocated memory (extract functions return allocated strings)
     if (lora_adapter.lora_adapter_path) free(lora_adapter.lora_adapter_path);
@@ -77,4 +66,15 @@ json_object* call_rkllm_load_lora(json_object* params) {
         json_object_object_add(error_result, "message", json_object_new_string("Failed to load LoRA adapter"));
         return error_result;
     }
+}
+
+json_object* call_rkllm_load_lora(json_object* params) {
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    json_object* result = load_lora_with_model(model, params);
+    release_model(model);
+    return result;
 }
\ No newline at end of file
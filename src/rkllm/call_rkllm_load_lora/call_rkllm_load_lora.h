@@ -6,7 +6,7 @@
 /**
  * Loads a LoRA adapter into the LLM
  * Maps to: int rkllm_load_lora(LLMHandle handle, RKLLMLoraAdapter* lora_adapter)
- * @param params JSON array containing RKLLMLoraAdapter parameters
+ * @param params JSON array containing RKLLMLoraAdapter parameters (optional "model" selects the model)
  * @return JSON object with success/error status
  */
 json_object* call_rkllm_load_lora(json_object* params);
@@ -1,4 +1,6 @@
 #include "call_rkllm_load_prompt_cache.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../manage_prompt_cache/manage_prompt_cache.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
 #include "../../utils/log_message/log_message.h"
 #include "../../utils/constants/constants.h"
@@ -9,20 +11,9 @@
 #include <sys/stat.h>
 #include <errno.h>
 
-// External reference to global LLM handle and state from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-
-json_object* call_rkllm_load_prompt_cache(json_object* params) {
+static json_object* load_prompt_cache_with_model(ModelEntry* model, json_object* params) {
     json_object* error_obj = json_object_new_object();
     
-    // Validate that model is initialized
-    if (!global_llm_initialized || !global_llm_handle) {
-        json_object_object_add(error_obj, "code", json_object_new_int(-32000));
-        json_object_object_add(error_obj, "message", json_object_new_string("Model not initialized - call rkllm.init first"));
-        return error_obj;
-    }
-    
     if (!params || !json_object_is_type(params, json_type_object)) {
         json_object_object_add(error_obj, "code", json_object_new_int(-32602));
         json_object_object_add(error_obj, "message", json_object_new_string("Invalid parameters - expected object"));
@@ -74,13 +65,15 @@ json_object* call_rkllm_load_prompt_cache(json_object* params) {
     LOG_INFO_MSG("Loading prompt cache from: %s", prompt_cache_path);
     
     // Call rkllm_load_prompt_cache with proper error handling
-    int result = rkllm_load_prompt_cache(global_llm_handle, prompt_cache_path);
+    int result = rkllm_load_prompt_cache(model->handle, prompt_cache_path);
     
     // Clean up error object since we're returning success
     json_object_put(error_obj);
     
     if (result == 0) {
-        // Success
+        // Success; automatic caching leaves the client's cache alone
+        mark_manual_prompt_cache(model, 1);
+        model->kv_session = 0;
         json_object* result_obj = json_object_new_object();
         json_object_object_add(result_obj, "success", json_object_new_boolean(1));
         json_object_object_add(result_obj, "message", json_object_new_string("Prompt cache loaded successfully"));
@@ -102,4 +95,15 @@ json_object* call_rkllm_load_prompt_cache(json_object* params) {
         LOG_ERROR_MSG("Prompt cache loading failed: %s (code: %d)", prompt_cache_path, result);
         return error_result;
     }
+}
+
+json_object* call_rkllm_load_prompt_cache(json_object* params) {
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    json_object* result = load_prompt_cache_with_model(model, params);
+    release_model(model);
+    return result;
 }
\ No newline at end of file
@@ -6,7 +6,7 @@
 /**
  * Loads a prompt cache from a file
  * Maps to: int rkllm_load_prompt_cache(LLMHandle handle, const char* prompt_cache_path)
- * @param params JSON array containing prompt cache path
+ * @param params JSON array containing prompt cache path (optional "model" selects the model)
  * @return JSON object with success/error status
  */
 json_object* call_rkllm_load_prompt_cache(json_object* params);
@@ -1,4 +1,6 @@
 #include "call_rkllm_release_prompt_cache.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../manage_prompt_cache/manage_prompt_cache.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
 #include "../../utils/log_message/log_message.h"
 #include "../../utils/constants/constants.h"
@@ -7,27 +9,14 @@
 #include <stdio.h>
 #include <json-c/json.h>
 
-// External reference to global LLM handle and state from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-
-json_object* call_rkllm_release_prompt_cache(void) {
+static json_object* release_prompt_cache_with_model(ModelEntry* model) {
     LOG_INFO_MSG("Releasing prompt cache...");
     
     // Create error object for potential use
     json_object* error_obj = json_object_new_object();
     
-    // Validate that model is initialized
-    if (!global_llm_initialized) {
-        json_object_object_add(error_obj, "code", json_object_new_int(-32001));
-        json_object_object_add(error_obj, "message", json_object_new_string("Model not initialized - cannot release prompt cache"));
-        
-        LOG_ERROR_MSG("Cannot release prompt cache: Model not initialized");
-        return error_obj;
-    }
-    
     // Validate handle is not NULL
-    if (!global_llm_handle) {
+    if (!model->handle) {
         json_object_object_add(error_obj, "code", json_object_new_int(-32001));
         json_object_object_add(error_obj, "message", json_object_new_string("Invalid model handle - cannot release prompt cache"));
         
@@ -40,13 +29,15 @@ json_object* call_rkllm_release_prompt_cache(void) {
     LOG_DEBUG_MSG("Calling rkllm_release_prompt_cache with handle validation");
     
     // Call rkllm_release_prompt_cache with extra safety
-    int result = rkllm_release_prompt_cache(global_llm_handle);
+    int result = rkllm_release_prompt_cache(model->handle);
     
     // Clean up error object since we're handling the result
     json_object_put(error_obj);
     
     if (result == 0) {
         // Success
+        mark_manual_prompt_cache(model, 0);
+        model->kv_session = 0;
         json_object* result_obj = json_object_new_object();
         json_object_object_add(result_obj, "success", json_object_new_boolean(1));
         json_object_object_add(result_obj, "message", json_object_new_string("Prompt cache released successfully"));
@@ -67,4 +58,15 @@ json_object* call_rkllm_release_prompt_cache(void) {
         LOG_ERROR_MSG("Prompt cache release failed with code: %d", result);
         return error_result;
     }
+}
+
+json_object* call_rkllm_release_prompt_cache(json_object* params) {
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    json_object* result = release_prompt_cache_with_model(model);
+    release_model(model);
+    return result;
 }
\ No newline at end of file
@@ -6,8 +6,9 @@
 /**
  * Releases the prompt cache from memory
  * Maps to: int rkllm_release_prompt_cache(LLMHandle handle)
+ * @param params Optional object whose "model" field names the model (default: newest)
  * @return JSON object with success/error status
  */
-json_object* call_rkllm_release_prompt_cache(void);
+json_object* call_rkllm_release_prompt_cache(json_object* params);
 
 #endif
\ No newline at end of file
@@ -1,8 +1,12 @@
 #include "call_rkllm_run.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
 #include "../manage_streaming_context/manage_streaming_context.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../manage_prompt_cache/manage_prompt_cache.h"
+#include "../../image_processing/manage_image_embeddings/manage_image_embeddings.h"
 #include "../../jsonrpc/extract_string_param/extract_string_param.h"
 #include "../../jsonrpc/extract_int_param/extract_int_param.h"
+#include "../../jsonrpc/extract_bool_param/extract_bool_param.h"
 #include "../../jsonrpc/extract_object_param/extract_object_param.h"
 #include "../../jsonrpc/extract_array_param/extract_array_param.h"
 #include "../../utils/log_message/log_message.h"
@@ -13,19 +17,8 @@
 #include <string.h>
 #include <stdlib.h>
 
-// External reference to global LLM handle from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
 
-json_object* call_rkllm_run(json_object* params, int client_fd, int request_id) {
-    // Validate that model is initialized
-    if (!global_llm_initialized || !global_llm_handle) {
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Model not initialized - call rkllm.init first"));
-        return error_result;
-    }
-    
+static json_object* run_streaming(json_object* params, Connection* conn, json_object* request_id, char** reply) {
     if (!params || !json_object_is_type(params, json_type_object)) {
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32602));
@@ -33,11 +26,18 @@ json_object* call_rkllm_run(json_object* params, int client_fd, int request_id)
         return error_result;
     }
     
+    // Resolve params.model; the streaming context holds it until the stream ends
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
     // Use params directly as the input object - standardized format
     json_object* input_obj = params;
     
     RKLLMInput rkllm_input;
     memset(&rkllm_input, 0, sizeof(RKLLMInput));
+    int embed_is_stored = 0;    // image_embed points into the image embedding store
     
     // Extract input_type (support both string and int)
     json_object* input_type_obj = NULL;
@@ -90,85 +90,106 @@ json_object* call_rkllm_run(json_object* params, int client_fd, int request_id)
             // Extract multimodal parameters
             json_object* multimodal_obj = extract_object_param(input_obj, "multimodal");
             if (multimodal_obj) {
-                // Extract n_image_tokens FIRST to know expected size
-                int n_image_tokens = extract_int_param(multimodal_obj, "n_image_tokens", 196);
-                int embed_size = 1536;
-                int expected_embed_len = n_image_tokens * embed_size;
-                
-                LOG_INFO_MSG("Expected multimodal embeddings: %d tokens × %d dim = %d floats", 
-                           n_image_tokens, embed_size, expected_embed_len);
-                
-                // Try to extract image embeddings - support both array and base64 formats
-                json_object* image_embed_array = extract_array_param(multimodal_obj, "image_embed");
-                json_object* image_embed_base64_obj = NULL;
-                json_object_object_get_ex(multimodal_obj, "image_embed_base64", &image_embed_base64_obj);
-                
-                float* embeddings = malloc(expected_embed_len * sizeof(float));
-                if (!embeddings) {
-                    LOG_ERROR_MSG("Failed to allocate memory for embeddings");
+                char* image_handle = extract_string_param(multimodal_obj, "image_handle", NULL);
+                if (image_handle) {
+                    // Embeddings from image.process are used in place
+                    ImageEmbedding* stored = find_image_embedding(parse_image_handle(image_handle));
+                    if (!stored) {
+                        free(image_handle);
+                        json_object_put(multimodal_obj);
+                        release_model(model);
+                        json_object* error_result = json_object_new_object();
+                        json_object_object_add(error_result, "code", json_object_new_int(-32602));
+                        json_object_object_add(error_result, "message", json_object_new_string("Unknown image_handle"));
+                        return error_result;
+                    }
+                    rkllm_input.multimodal_input.image_embed = stored->data;
+                    rkllm_input.multimodal_input.n_image_tokens = stored->n_image_tokens;
+                    embed_is_stored = 1;
+                    LOG_INFO_MSG("Using stored image embedding %s: %d tokens x %d dim",
+                                 image_handle, stored->n_image_tokens, stored->embed_dim);
+                    free(image_handle);
                 } else {
-                    bool embeddings_loaded = false;
+                    // Extract n_image_tokens FIRST to know expected size
+                    int n_image_tokens = extract_int_param(multimodal_obj, "n_image_tokens", 196);
+                    int embed_size = 1536;
+                    int expected_embed_len = n_image_tokens * embed_size;
                     
-                    // Try base64 format first (more efficient for large arrays)
-                    if (image_embed_base64_obj && json_object_is_type(image_embed_base64_obj, json_type_string)) {
-                        const char* base64_data = json_object_get_string(image_embed_base64_obj);
-                        if (base64_data) {
-                            // Decode base64 to binary float data
-                            unsigned char* decoded_data = NULL;
-                            size_t decoded_len = 0;
-                            
-                            if (base64_decode(base64_data, &decoded_data, &decoded_len) == 0) {
-                                size_t expected_bytes = expected_embed_len * sizeof(float);
-                                size_t copy_bytes = (decoded_len < expected_bytes) ? decoded_len : expected_bytes;
+                    LOG_INFO_MSG("Expected multimodal embeddings: %d tokens × %d dim = %d floats", 
+                               n_image_tokens, embed_size, expected_embed_len);
+                    
+                    // Try to extract image embeddings - support both array and base64 formats
+                    json_object* image_embed_array = extract_array_param(multimodal_obj, "image_embed");
+                    json_object* image_embed_base64_obj = NULL;
+                    json_object_object_get_ex(multimodal_obj, "image_embed_base64", &image_embed_base64_obj);
+                    
+                    float* embeddings = malloc(expected_embed_len * sizeof(float));
+                    if (!embeddings) {
+                        LOG_ERROR_MSG("Failed to allocate memory for embeddings");
+                    } else {
+                        bool embeddings_loaded = false;
+                        
+                        // Try base64 format first (more efficient for large arrays)
+                        if (image_embed_base64_obj && json_object_is_type(image_embed_base64_obj, json_type_string)) {
+                            const char* base64_data = json_object_get_string(image_embed_base64_obj);
+                            if (base64_data) {
+                                // Decode base64 to binary float data
+                                unsigned char* decoded_data = NULL;
+                                size_t decoded_len = 0;
                                 
-                                memcpy(embeddings, decoded_data, copy_bytes);
-                                // Zero-pad if needed
-                                if (copy_bytes < expected_bytes) {
-                                    memset((char*)embeddings + copy_bytes, 0, expected_bytes - copy_bytes);
+                                if (base64_decode(base64_data, &decoded_data, &decoded_len) == 0) {
+                                    size_t expected_bytes = expected_embed_len * sizeof(float);
+                                    size_t copy_bytes = (decoded_len < expected_bytes) ? decoded_len : expected_bytes;
+                                    
+                                    memcpy(embeddings, decoded_data, copy_bytes);
+                                    // Zero-pad if needed
+                                    if (copy_bytes < expected_bytes) {
+                                        memset((char*)embeddings + copy_bytes, 0, expected_bytes - copy_bytes);
+                                    }
+                                    
+                                    free(decoded_data);
+                                    embeddings_loaded = true;
+                                    LOG_INFO_MSG("Loaded embeddings from base64: %zu bytes -> %d floats", 
+                                               decoded_len, expected_embed_len);
+                                } else {
+                                    LOG_ERROR_MSG("Failed to decode base64 embedding data");
+                                    free(decoded_data);
                                 }
-                                
-                                free(decoded_data);
-                                embeddings_loaded = true;
-                                LOG_INFO_MSG("Loaded embeddings from base64: %zu bytes -> %d floats", 
-                                           decoded_len, expected_embed_len);
-                            } else {
-                                LOG_ERROR_MSG("Failed to decode base64 embedding data");
-                                free(decoded_data);
                             }
                         }
-                    }
-                    
-                    // Fallback to JSON array format
-                    if (!embeddings_loaded && image_embed_array) {
-                        int embed_len = json_object_array_length(image_embed_array);
-                        LOG_INFO_MSG("Received embedding array length: %d", embed_len);
                         
-                        if (embed_len > 0) {
-                            // Copy available embeddings, pad with zeros if needed
-                            int copy_len = (embed_len < expected_embed_len) ? embed_len : expected_embed_len;
-                            for (int i = 0; i < copy_len; i++) {
-                                json_object* embed_val = json_object_array_get_idx(image_embed_array, i);
-                                embeddings[i] = json_object_get_double(embed_val);
-                            }
-                            // Zero-pad if array is smaller than expected
-                            for (int i = copy_len; i < expected_embed_len; i++) {
-                                embeddings[i] = 0.0f;
+                        // Fallback to JSON array format
+                        if (!embeddings_loaded && image_embed_array) {
+                            int embed_len = json_object_array_length(image_embed_array);
+                            LOG_INFO_MSG("Received embedding array length: %d", embed_len);
+                            
+                            if (embed_len > 0) {
+                                // Copy available embeddings, pad with zeros if needed
+                                int copy_len = (embed_len < expected_embed_len) ? embed_len : expected_embed_len;
+                                for (int i = 0; i < copy_len; i++) {
+                                    json_object* embed_val = json_object_array_get_idx(image_embed_array, i);
+                                    embeddings[i] = json_object_get_double(embed_val);
+                                }
+                                // Zero-pad if array is smaller than expected
+                                for (int i = copy_len; i < expected_embed_len; i++) {
+                                    embeddings[i] = 0.0f;
+                                }
+                                embeddings_loaded = true;
+                                LOG_INFO_MSG("Loaded embeddings from JSON array: %d floats", copy_len);
                             }
-                            embeddings_loaded = true;
-                            LOG_INFO_MSG("Loaded embeddings from JSON array: %d floats", copy_len);
                         }
-                    }
-                    
-                    if (embeddings_loaded) {
-                        rkllm_input.multimodal_input.image_embed = embeddings;
-                        rkllm_input.multimodal_input.n_image_tokens = n_image_tokens;
                         
-                        LOG_INFO_MSG("Set multimodal embeddings: %d tokens, %d total floats", 
-                                   n_image_tokens, expected_embed_len);
-                    } else {
-                        LOG_ERROR_MSG("No valid embedding data found");
-                        free(embeddings);
-                        embeddings = NULL;
+                        if (embeddings_loaded) {
+                            rkllm_input.multimodal_input.image_embed = embeddings;
+                            rkllm_input.multimodal_input.n_image_tokens = n_image_tokens;
+                            
+                            LOG_INFO_MSG("Set multimodal embeddings: %d tokens, %d total floats", 
+                                       n_image_tokens, expected_embed_len);
+                        } else {
+                            LOG_ERROR_MSG("No valid embedding data found");
+                            free(embeddings);
+                            embeddings = NULL;
+                        }
                     }
                 }
                 
@@ -184,6 +205,7 @@ json_object* call_rkllm_run(json_object* params, int client_fd, int request_id)
                            rkllm_input.multimodal_input.image_height,
                            rkllm_input.multimodal_input.image_width,
                            rkllm_input.multimodal_input.image_embed);
+                json_object_put(multimodal_obj);
             }
             break;
         }
@@ -219,23 +241,73 @@ json_object* call_rkllm_run(json_object* params, int client_fd, int request_id)
             break;
     }
     
-    // Set streaming context for the callback to capture streaming data
-    set_streaming_context(client_fd, request_id);
-    LOG_DEBUG_MSG("Set streaming context for rkllm_run (mode: %d)", rkllm_infer_param.mode);
+    // This run's streaming context travels to the callback as userdata
+    StreamOptions stream_options;
+    extract_stream_options(params, &stream_options);
+    StreamingContext* context = create_streaming_context(conn, request_id, &stream_options, 0);
+    if (!context) {
+        release_model(model);
+        if (rkllm_input.input_type == RKLLM_INPUT_MULTIMODAL && rkllm_input.multimodal_input.image_embed && !embed_is_stored) {
+            free((void*)rkllm_input.multimodal_input.image_embed);
+        }
+        
+        json_object* error_result = json_object_new_object();
+        json_object_object_add(error_result, "code", json_object_new_int(-32000));
+        json_object_object_add(error_result, "message", json_object_new_string("Failed to allocate streaming context"));
+        return error_result;
+    }
+    context->model = model;
+    
+    json_object* stop_error = set_stop_conditions(context, params);
+    if (stop_error) {
+        free_streaming_context(context);
+        if (rkllm_input.input_type == RKLLM_INPUT_MULTIMODAL && rkllm_input.multimodal_input.image_embed && !embed_is_stored) {
+            free((void*)rkllm_input.multimodal_input.image_embed);
+        }
+        return stop_error;
+    }
+    
+    // Whatever the run leaves in the KV cache is no session's history
+    model->kv_session = 0;
+    if (reply) {
+        context->reply = calloc(1, 256);
+        context->reply_capacity = context->reply ? 256 : 0;
+    }
+    
+    // Stateless runs start from the saved prefill of the model's system
+    // prompt and template; a new prefix is saved by a priming run first
+    if (!rkllm_infer_param.keep_history && extract_bool_param(params, "prompt_cache", 1)) {
+        prepare_prompt_cache(model);
+    }
+    LOG_DEBUG_MSG("Created streaming context for rkllm_run (mode: %d)", rkllm_infer_param.mode);
     
     // Call rkllm_run - the callback will handle ALL responses including final
     LOG_INFO_MSG("Calling rkllm_run...");
-    int result = rkllm_run(global_llm_handle, &rkllm_input, &rkllm_infer_param, NULL);
+    int result = rkllm_run(model->handle, &rkllm_input, &rkllm_infer_param, context);
     
     LOG_INFO_MSG("rkllm_run returned: %d", result);
     
+    // A run aborted by its stop condition already sent its final frame
+    if (result != 0 && context->aborted) {
+        result = 0;
+    }
+    
+    // A paused run (client gone or stalled) returns without a FINISH callback
+    if (result == 0 && context->is_active) {
+        LOG_WARN_MSG("rkllm_run returned without finishing request %s", context->request_id);
+    }
+    if (reply && result == 0 && !context->is_active) {
+        *reply = context->reply;
+        context->reply = NULL;
+    }
+    free_streaming_context(context);
+    
     if (result != 0) {
         // RKLLM run failed - cleanup and return error
         LOG_ERROR_MSG("rkllm_run failed with code: %d", result);
-        clear_streaming_context();
         
         // Cleanup allocated memory
-        if (rkllm_input.input_type == RKLLM_INPUT_MULTIMODAL && rkllm_input.multimodal_input.image_embed) {
+        if (rkllm_input.input_type == RKLLM_INPUT_MULTIMODAL && rkllm_input.multimodal_input.image_embed && !embed_is_stored) {
             free((void*)rkllm_input.multimodal_input.image_embed);
         }
         
@@ -246,7 +318,7 @@ json_object* call_rkllm_run(json_object* params, int client_fd, int request_id)
     }
     
     // Cleanup allocated memory
-    if (rkllm_input.input_type == RKLLM_INPUT_MULTIMODAL && rkllm_input.multimodal_input.image_embed) {
+    if (rkllm_input.input_type == RKLLM_INPUT_MULTIMODAL && rkllm_input.multimodal_input.image_embed && !embed_is_stored) {
         free((void*)rkllm_input.multimodal_input.image_embed);
     }
     
@@ -254,4 +326,14 @@ json_object* call_rkllm_run(json_object* params, int client_fd, int request_id)
     // The callback function will handle ALL responses to the client
     LOG_DEBUG_MSG("Async mode: returning NULL (callback handles responses)");
     return NULL; // No immediate response - callback handles everything
+}
+
+json_object* call_rkllm_run(json_object* params, Connection* conn, json_object* request_id) {
+    return run_streaming(params, conn, request_id, NULL);
+}
+
+json_object* call_rkllm_run_with_reply(json_object* params, Connection* conn, json_object* request_id,
+                                       char** reply) {
+    *reply = NULL;
+    return run_streaming(params, conn, request_id, reply);
 }
\ No newline at end of file
@@ -2,14 +2,26 @@
 #define CALL_RKLLM_RUN_H
 
 #include <json-c/json.h>
+#include "../../connection/create_connection/create_connection.h"
 
 /**
  * Calls rkllm_run with JSON-RPC parameters for synchronous inference with streaming
  * @param params JSON array containing RKLLMInput and RKLLMInferParam
- * @param client_fd Client file descriptor for streaming responses
- * @param request_id Request ID for callback correlation
+ * @param conn Client connection for streaming responses
+ * @param request_id JSON-RPC request id echoed in every streamed frame (any JSON type)
  * @return JSON object with result or NULL on error
  */
-json_object* call_rkllm_run(json_object* params, int client_fd, int request_id);
+json_object* call_rkllm_run(json_object* params, Connection* conn, json_object* request_id);
+
+/**
+ * Runs like call_rkllm_run and also returns the generated text
+ * @param params Run parameters as for call_rkllm_run
+ * @param conn Client connection for streaming responses
+ * @param request_id JSON-RPC request id echoed in every streamed frame
+ * @param reply Receives the generated text (caller frees), or NULL if the run did not finish
+ * @return JSON error object, or NULL once the stream was sent
+ */
+json_object* call_rkllm_run_with_reply(json_object* params, Connection* conn, json_object* request_id,
+                                       char** reply);
 
 #endif
\ No newline at end of file
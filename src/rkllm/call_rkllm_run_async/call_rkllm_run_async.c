@@ -1,8 +1,11 @@
 #include "call_rkllm_run_async.h"
 #include "../manage_streaming_context/manage_streaming_context.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../manage_prompt_cache/manage_prompt_cache.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
 #include "../../jsonrpc/extract_string_param/extract_string_param.h"
 #include "../../jsonrpc/extract_int_param/extract_int_param.h"
+#include "../../jsonrpc/extract_bool_param/extract_bool_param.h"
 #include "../../utils/log_message/log_message.h"
 #include <stdbool.h>
 #include <stdio.h>
@@ -12,20 +15,8 @@
 #include <unistd.h>
 #include <signal.h>
 
-// External reference to global LLM handle and callback from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-extern int global_rkllm_callback(RKLLMResult* result, void* userdata, LLMCallState state);
 
-json_object* call_rkllm_run_async(json_object* params, int client_fd, int request_id) {
-    // Validate that model is initialized
-    if (!global_llm_initialized || !global_llm_handle) {
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Model not initialized - call rkllm.init first"));
-        return error_result;
-    }
-    
+json_object* call_rkllm_run_async(json_object* params, Connection* conn, json_object* request_id) {
     if (!params || !json_object_is_type(params, json_type_object)) {
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32602));
@@ -33,6 +24,12 @@ json_object* call_rkllm_run_async(json_object* params, int client_fd, int reques
         return error_result;
     }
     
+    // Resolve params.model; the streaming context holds it until the stream ends
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
     // Use params directly as the input object - standardized format
     json_object* input_obj = params;
     
@@ -51,7 +48,10 @@ json_object* call_rkllm_run_async(json_object* params, int client_fd, int reques
     // Handle union based on input_type
     switch (rkllm_input.input_type) {
         case RKLLM_INPUT_PROMPT: {
-            char* prompt = extract_string_param(input_obj, "prompt_input", NULL);
+            char* prompt = extract_string_param(input_obj, "prompt", NULL);
+            if (!prompt) {
+                prompt = extract_string_param(input_obj, "prompt_input", NULL);
+            }
             if (prompt) {
                 rkllm_input.prompt_input = prompt;  // Don't free - RKLLM keeps reference
             }
@@ -60,14 +60,8 @@ json_object* call_rkllm_run_async(json_object* params, int client_fd, int reques
         // Add other input types as needed
     }
     
-    // Get RKLLMInferParam (parameter 2) - convert using individual extraction functions
-    json_object* infer_obj = json_object_array_get_idx(params, 2);
-    if (!infer_obj) {
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32602));
-        json_object_object_add(error_result, "message", json_object_new_string("Invalid inference parameter"));
-        return error_result;
-    }
+    // Inference parameters share the params object, as in rkllm.run
+    json_object* infer_obj = input_obj;
     
     RKLLMInferParam rkllm_infer_param;
     memset(&rkllm_infer_param, 0, sizeof(RKLLMInferParam));
@@ -76,16 +70,42 @@ json_object* call_rkllm_run_async(json_object* params, int client_fd, int reques
     rkllm_infer_param.mode = extract_int_param(infer_obj, "mode", 0);
     rkllm_infer_param.keep_history = extract_int_param(infer_obj, "keep_history", 0);
     
-    // Set streaming context for callback forwarding
-    set_streaming_context(client_fd, request_id);
+    // The callback owns this context and frees it when the stream ends,
+    // since this call returns before generation does
+    StreamOptions stream_options;
+    extract_stream_options(params, &stream_options);
+    StreamingContext* context = create_streaming_context(conn, request_id, &stream_options, 1);
+    if (!context) {
+        release_model(model);
+        json_object* error_result = json_object_new_object();
+        json_object_object_add(error_result, "code", json_object_new_int(-32000));
+        json_object_object_add(error_result, "message", json_object_new_string("Failed to allocate streaming context"));
+        return error_result;
+    }
+    context->model = model;
+    
+    json_object* stop_error = set_stop_conditions(context, params);
+    if (stop_error) {
+        free_streaming_context(context);
+        return stop_error;
+    }
+    
+    // Whatever the run leaves in the KV cache is no session's history
+    model->kv_session = 0;
+    
+    // Stateless runs start from the saved prefill of the model's system
+    // prompt and template; a new prefix is saved by a priming run first
+    if (!rkllm_infer_param.keep_history && extract_bool_param(params, "prompt_cache", 1)) {
+        prepare_prompt_cache(model);
+    }
     LOG_DEBUG_MSG("About to call rkllm_run_async...");
     
     // Call rkllm_run_async with global callback
-    int result = rkllm_run_async(global_llm_handle, &rkllm_input, &rkllm_infer_param, NULL);
+    int result = rkllm_run_async(model->handle, &rkllm_input, &rkllm_infer_param, context);
     
     if (result != 0) {
-        // RKLLM run_async failed - clear streaming context and return error
-        clear_streaming_context();
+        // RKLLM run_async failed - no callback will see the context
+        free_streaming_context(context);
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32000));
         json_object_object_add(error_result, "message", json_object_new_string("Failed to start async inference"));
@@ -2,14 +2,15 @@
 #define CALL_RKLLM_RUN_ASYNC_H
 
 #include <json-c/json.h>
+#include "../../connection/create_connection/create_connection.h"
 
 /**
  * Calls rkllm_run_async with JSON-RPC parameters for async inference
- * @param params JSON array containing RKLLMInput and RKLLMInferParam
- * @param client_fd File descriptor of the client for callback context
- * @param request_id JSON-RPC request ID for response correlation
+ * @param params JSON object with the input and inference parameters
+ * @param conn Client connection for callback context
+ * @param request_id JSON-RPC request id echoed in every streamed frame (any JSON type)
  * @return JSON object with result or NULL on error
  */
-json_object* call_rkllm_run_async(json_object* params, int client_fd, int request_id);
+json_object* call_rkllm_run_async(json_object* params, Connection* conn, json_object* request_id);
 
 #endif
\ No newline at end of file
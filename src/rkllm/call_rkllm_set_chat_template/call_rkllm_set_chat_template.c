@@ -1,23 +1,13 @@
 #include "call_rkllm_set_chat_template.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../manage_prompt_cache/manage_prompt_cache.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
 #include "../../jsonrpc/extract_string_param/extract_string_param.h"
 #include <rkllm.h>
 #include <stdio.h>
 #include <string.h>
 
-// External reference to global LLM handle and state from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-
-json_object* call_rkllm_set_chat_template(json_object* params) {
-    // Validate that model is initialized
-    if (!global_llm_initialized || !global_llm_handle) {
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Model not initialized - call rkllm.init first"));
-        return error_result;
-    }
-    
+static json_object* set_chat_template_with_model(ModelEntry* model, json_object* params) {
     if (!params || !json_object_is_type(params, json_type_object)) {
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32602));
@@ -61,7 +51,15 @@ json_object* call_rkllm_set_chat_template(json_object* params) {
     }
     
     // Call rkllm_set_chat_template
-    int result = rkllm_set_chat_template(global_llm_handle, system_prompt, prompt_prefix, prompt_postfix);
+    int result = rkllm_set_chat_template(model->handle, system_prompt, prompt_prefix, prompt_postfix);
+    if (result == 0) {
+        // Everything before the user input is what the prompt cache stores
+        set_prompt_prefix(model, hash_prompt_text(hash_prompt_text(0, system_prompt), prompt_prefix));
+        model->kv_session = 0;
+        
+        // Sessions wrap each rebuilt exchange in the same template
+        set_model_chat_template(model, system_prompt, prompt_prefix, prompt_postfix);
+    }
     
     // Clean up allocated strings
     if (system_prompt) free(system_prompt);
@@ -81,4 +79,15 @@ json_object* call_rkllm_set_chat_template(json_object* params) {
         json_object_object_add(error_result, "message", json_object_new_string("Failed to set chat template"));
         return error_result;
     }
+}
+
+json_object* call_rkllm_set_chat_template(json_object* params) {
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    json_object* result = set_chat_template_with_model(model, params);
+    release_model(model);
+    return result;
 }
\ No newline at end of file
@@ -6,7 +6,7 @@
 /**
  * Sets the chat template for the LLM, including system prompt, prefix, and postfix
  * Maps to: int rkllm_set_chat_template(LLMHandle handle, const char* system_prompt, const char* prompt_prefix, const char* prompt_postfix)
- * @param params JSON array containing chat template parameters
+ * @param params JSON array containing chat template parameters (optional "model" selects the model)
  * @return JSON object with success/error status
  */
 json_object* call_rkllm_set_chat_template(json_object* params);
@@ -1,4 +1,5 @@
 #include "call_rkllm_set_cross_attn_params.h"
+#include "../manage_model_registry/manage_model_registry.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
 #include "../../jsonrpc/extract_int_param/extract_int_param.h"
 #include "../../jsonrpc/extract_array_param/extract_array_param.h"
@@ -6,19 +7,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-// External reference to global LLM handle and state from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-
-json_object* call_rkllm_set_cross_attn_params(json_object* params) {
-    // Validate that model is initialized
-    if (!global_llm_initialized || !global_llm_handle) {
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Model not initialized - call rkllm.init first"));
-        return error_result;
-    }
-    
+static json_object* set_cross_attn_params_with_model(ModelEntry* model, json_object* params) {
     if (!params || !json_object_is_type(params, json_type_object)) {
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32602));
@@ -151,7 +140,7 @@ json_object* call_rkllm_set_cross_attn_params(json_object* params) {
     }
     
     // Call rkllm_set_cross_attn_params
-    int result = rkllm_set_cross_attn_params(global_llm_handle, &cross_attn_params);
+    int result = rkllm_set_cross_attn_params(model->handle, &cross_attn_params);
     
     // Clean up allocated memory
     if (cross_attn_params.encoder_k_cache) free(cross_attn_params.encoder_k_cache);
@@ -180,4 +169,15 @@ json_object* call_rkllm_set_cross_attn_params(json_object* params) {
         json_object_object_add(error_result, "message", json_object_new_string("Failed to set cross-attention parameters"));
         return error_result;
     }
+}
+
+json_object* call_rkllm_set_cross_attn_params(json_object* params) {
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    json_object* result = set_cross_attn_params_with_model(model, params);
+    release_model(model);
+    return result;
 }
\ No newline at end of file
@@ -6,7 +6,7 @@
 /**
  * Sets the cross-attention parameters for the LLM decoder
  * Maps to: int rkllm_set_cross_attn_params(LLMHandle handle, RKLLMCrossAttnParam* cross_attn_params)
- * @param params JSON array containing cross-attention parameters
+ * @param params JSON array containing cross-attention parameters (optional "model" selects the model)
  * @return JSON object with success/error status
  */
 json_object* call_rkllm_set_cross_attn_params(json_object* params);
@@ -1,22 +1,12 @@
 #include "call_rkllm_set_function_tools.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../manage_prompt_cache/manage_prompt_cache.h"
 #include "../call_rkllm_init/call_rkllm_init.h"
 #include <rkllm.h>
 #include <stdio.h>
 #include <string.h>
 
-// External reference to global LLM handle and state from call_rkllm_init
-extern LLMHandle global_llm_handle;
-extern int global_llm_initialized;
-
-json_object* call_rkllm_set_function_tools(json_object* params) {
-    // Validate that model is initialized
-    if (!global_llm_initialized || !global_llm_handle) {
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Model not initialized - call rkllm.init first"));
-        return error_result;
-    }
-    
+static json_object* set_function_tools_with_model(ModelEntry* model, json_object* params) {
     if (!params || !json_object_is_type(params, json_type_object)) {
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32602));
@@ -46,7 +36,13 @@ json_object* call_rkllm_set_function_tools(json_object* params) {
     }
     
     // Call rkllm_set_function_tools
-    int result = rkllm_set_function_tools(global_llm_handle, system_prompt, tools, tool_response_str);
+    int result = rkllm_set_function_tools(model->handle, system_prompt, tools, tool_response_str);
+    if (result == 0) {
+        // Tool definitions are rendered into the system prompt
+        set_prompt_prefix(model, hash_prompt_text(hash_prompt_text(0, system_prompt), tools));
+        forget_model_system_prompt(model);
+        model->kv_session = 0;
+    }
     
     if (result == 0) {
         // Success
@@ -73,4 +69,15 @@ json_object* call_rkllm_set_function_tools(json_object* params) {
         json_object_object_add(error_result, "message", json_object_new_string("Failed to set function tools configuration"));
         return error_result;
     }
+}
+
+json_object* call_rkllm_set_function_tools(json_object* params) {
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    json_object* result = set_function_tools_with_model(model, params);
+    release_model(model);
+    return result;
 }
\ No newline at end of file
@@ -0,0 +1,28 @@
+#include "call_session_close.h"
+#include "../manage_sessions/manage_sessions.h"
+#include "../../jsonrpc/extract_int_param/extract_int_param.h"
+#include "../../utils/log_message/log_message.h"
+
+json_object* call_session_close(json_object* params) {
+    int session_id = 0;
+    if (params && json_object_is_type(params, json_type_object)) {
+        session_id = extract_int_param(params, "session_id", 0);
+    }
+    
+    Session* session = find_session(session_id);
+    if (!session) {
+        json_object* error_result = json_object_new_object();
+        json_object_object_add(error_result, "code", json_object_new_int(-32602));
+        json_object_object_add(error_result, "message", json_object_new_string("Unknown session_id"));
+        return error_result;
+    }
+    
+    // The KV cache keeps the history until another run replaces it; the
+    // session id is never reused, so nothing mistakes it for a live session
+    json_object* result = describe_session(session);
+    json_object_object_add(result, "success", json_object_new_boolean(1));
+    close_session(session_id);
+    LOG_INFO_MSG("Session %d closed", session_id);
+    
+    return result;
+}
\ No newline at end of file
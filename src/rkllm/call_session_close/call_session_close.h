@@ -0,0 +1,13 @@
+#ifndef CALL_SESSION_CLOSE_H
+#define CALL_SESSION_CLOSE_H
+
+#include <json-c/json.h>
+
+/**
+ * Closes a session and forgets its history
+ * @param params Object with the session_id
+ * @return JSON object with success and the final session description, or an error object
+ */
+json_object* call_session_close(json_object* params);
+
+#endif
\ No newline at end of file
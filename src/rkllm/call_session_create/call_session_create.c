@@ -0,0 +1,24 @@
+#include "call_session_create.h"
+#include "../manage_sessions/manage_sessions.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../../jsonrpc/extract_int_param/extract_int_param.h"
+#include "../../utils/log_message/log_message.h"
+
+json_object* call_session_create(json_object* params) {
+    // Without a model name the session stays on the current default model
+    ModelEntry* model = acquire_model(get_model_name(params));
+    if (!model) {
+        return model_not_loaded_error(get_model_name(params));
+    }
+    
+    int max_history_tokens = 0;
+    if (params && json_object_is_type(params, json_type_object)) {
+        max_history_tokens = extract_int_param(params, "max_history_tokens", 0);
+    }
+    
+    int session_id = create_session(model->id, max_history_tokens);
+    LOG_INFO_MSG("Session %d opened on model '%s'", session_id, model->id);
+    release_model(model);
+    
+    return describe_session(find_session(session_id));
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#ifndef CALL_SESSION_CREATE_H
+#define CALL_SESSION_CREATE_H
+
+#include <json-c/json.h>
+
+/**
+ * Opens a server-side conversation on a loaded model
+ * @param params Optional object with model and max_history_tokens
+ * @return JSON object with the session_id, or an error object
+ */
+json_object* call_session_create(json_object* params);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "call_session_run.h"
+#include "../manage_sessions/manage_sessions.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../call_rkllm_run/call_rkllm_run.h"
+#include "../../jsonrpc/extract_int_param/extract_int_param.h"
+#include "../../utils/log_message/log_message.h"
+#include <rkllm.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static json_object* session_error(int code, const char* message) {
+    json_object* error_result = json_object_new_object();
+    json_object_object_add(error_result, "code", json_object_new_int(code));
+    json_object_object_add(error_result, "message", json_object_new_string(message));
+    return error_result;
+}
+
+static const char* get_string_field(json_object* params, const char* key) {
+    json_object* value = NULL;
+    if (json_object_object_get_ex(params, key, &value) && json_object_is_type(value, json_type_string)) {
+        return json_object_get_string(value);
+    }
+    return NULL;
+}
+
+/**
+ * Reads the KV cache size of the session's batch slot. Runs pass one
+ * input, which fills one slot; the runtime does not document which on
+ * an n_batch > 1 model, so the fullest slot is taken
+ * @return Number of cached positions, or -1 on error
+ */
+static int get_kv_position(ModelEntry* model) {
+    int sizes[model->n_batch];
+    memset(sizes, 0, sizeof(sizes));
+    if (rkllm_get_kv_cache_size(model->handle, sizes) != 0) {
+        return -1;
+    }
+    int position = 0;
+    for (int i = 0; i < model->n_batch; i++) {
+        if (sizes[i] > position) {
+            position = sizes[i];
+        }
+    }
+    return position;
+}
+
+static int get_history_end(const Session* session) {
+    return session->turn_count ? session->turns[session->turn_count - 1].kv_end : session->kv_base;
+}
+
+static int get_history_tokens(const Session* session) {
+    int tokens = 0;
+    for (int i = 0; i < session->turn_count; i++) {
+        tokens += session->turns[i].tokens;
+    }
+    return tokens;
+}
+
+/**
+ * Tells why the history cannot be prefilled again as one input
+ * @return Error message, or NULL if render_history reproduces it
+ */
+static const char* check_history_render(const Session* session, const ModelEntry* model, const char* role) {
+    // The runtime does not expose the text of a model's built-in template
+    if (!model->prompt_prefix || !model->prompt_postfix) {
+        return "Session history left the KV cache and needs rkllm.set_chat_template to be rebuilt";
+    }
+    // One input is wrapped for one role, so every exchange has to share it
+    for (int i = 0; i < session->turn_count; i++) {
+        if (strcmp(session->turns[i].role, role) != 0) {
+            return "Session history left the KV cache and mixes roles, so it cannot be rebuilt";
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Renders the kept history and the new input as one prompt for a prefill
+ * from scratch. The runtime wraps its input in the template prefix and
+ * postfix, so each earlier exchange is closed with the postfix, followed
+ * by its reply and opened again with the prefix: the rebuilt cache holds
+ * the same text as one filled turn by turn. Only valid once
+ * check_history_render has passed
+ * @return Prompt text (caller frees) or NULL on allocation failure
+ */
+static char* render_history(const Session* session, const ModelEntry* model, const char* prompt) {
+    const char* prefix = model->prompt_prefix;
+    const char* postfix = model->prompt_postfix;
+    size_t prefix_len = strlen(prefix);
+    size_t postfix_len = strlen(postfix);
+    
+    size_t length = strlen(prompt) + 1;
+    for (int i = 0; i < session->turn_count; i++) {
+        const SessionTurn* turn = &session->turns[i];
+        length += strlen(turn->prompt) + postfix_len + strlen(turn->reply) + prefix_len;
+    }
+    
+    char* text = malloc(length);
+    if (!text) {
+        return NULL;
+    }
+    size_t used = 0;
+    for (int i = 0; i < session->turn_count; i++) {
+        const SessionTurn* turn = &session->turns[i];
+        used += snprintf(text + used, length - used, "%s%s%s%s", turn->prompt, postfix, turn->reply, prefix);
+    }
+    snprintf(text + used, length - used, "%s", prompt);
+    return text;
+}
+
+/**
+ * Drops the oldest exchanges that no longer fit the budget
+ */
+static void trim_session_history(Session* session) {
+    while (session->max_history_tokens > 0 && session->turn_count > 0 &&
+           get_history_tokens(session) > session->max_history_tokens) {
+        drop_session_turns(session, 1);
+    }
+}
+
+/**
+ * Empties the KV cache down to the system prompt
+ * @return 0 on success, -1 if the cache could not be cleared
+ */
+static int reset_session_kv(Session* session, ModelEntry* model) {
+    if (rkllm_clear_kv_cache(model->handle, 1, NULL, NULL) != 0) {
+        return -1;
+    }
+    int base = get_kv_position(model);
+    session->kv_base = base > 0 ? base : 0;
+    return 0;
+}
+
+/**
+ * Records a finished exchange; exchanges prefilled again with it share
+ * its KV range
+ */
+static void record_turn(Session* session, ModelEntry* model, int resident,
+                        const char* role, const char* prompt, char* reply) {
+    int history_tokens = get_history_tokens(session);
+    int previous_end = get_history_end(session);
+    int position = get_kv_position(model);
+    
+    SessionTurn* turn = append_session_turn(session, role, prompt, reply);
+    if (!turn) {
+        free(reply);
+        LOG_ERROR_MSG("Session %d: failed to record exchange, history lost", session->id);
+        drop_session_turns(session, session->turn_count);
+        return;
+    }
+    if (position < 0) {
+        // Without a KV size the next turn prefills the history again
+        turn->tokens = (int)(strlen(prompt) + strlen(reply)) / 4 + 1;
+        return;
+    }
+    
+    if (resident) {
+        turn->tokens = position - previous_end;
+    } else {
+        turn->tokens = position - session->kv_base - history_tokens;
+        for (int i = 0; i < session->turn_count; i++) {
+            session->turns[i].kv_end = position;
+        }
+    }
+    if (turn->tokens < 1) {
+        turn->tokens = 1;
+    }
+    turn->kv_end = position;
+    model->kv_session = session->id;
+}
+
+json_object* call_session_run(json_object* params, Connection* conn, json_object* request_id) {
+    if (!params || !json_object_is_type(params, json_type_object)) {
+        return session_error(-32602, "Invalid parameters - expected object");
+    }
+    
+    Session* session = find_session(extract_int_param(params, "session_id", 0));
+    if (!session) {
+        return session_error(-32602, "Unknown session_id");
+    }
+    const char* prompt = get_string_field(params, "prompt");
+    if (!prompt) {
+        return session_error(-32602, "Missing required parameter: prompt");
+    }
+    const char* role = get_string_field(params, "role");
+    if (!role) {
+        role = "user";
+    }
+    
+    ModelEntry* model = acquire_model(session->model);
+    if (!model) {
+        return model_not_loaded_error(session->model);
+    }
+    
+    // The history is still in the KV cache if no other run touched it since
+    // this session's last turn. rkllm_clear_kv_cache only takes a range
+    // while a keep_history == 0 run is paused, so a finished history over
+    // budget cannot be cut in place and is prefilled again without its
+    // oldest exchanges
+    int resident = model->kv_session == session->id &&
+                   get_kv_position(model) == get_history_end(session);
+    if (resident && session->max_history_tokens > 0 &&
+        get_history_end(session) - session->kv_base > session->max_history_tokens) {
+        LOG_DEBUG_MSG("Session %d: history over %d tokens, prefilling it again",
+                      session->id, session->max_history_tokens);
+        resident = 0;
+    }
+    
+    char* text = NULL;
+    if (!resident) {
+        trim_session_history(session);
+        const char* render_error = session->turn_count ? check_history_render(session, model, role) : NULL;
+        if (render_error) {
+            release_model(model);
+            return session_error(-32000, render_error);
+        }
+        if (reset_session_kv(session, model) != 0) {
+            release_model(model);
+            return session_error(-32000, "Failed to clear KV cache");
+        }
+        text = render_history(session, model, prompt);
+        if (!text) {
+            release_model(model);
+            return session_error(-32000, "Memory allocation failed");
+        }
+    }
+    LOG_INFO_MSG("Session %d: %s %d exchanges", session->id,
+                 resident ? "reusing cached" : "prefilling", session->turn_count);
+    
+    // The turn itself is an ordinary rkllm.run that keeps history
+    json_object* run_params = json_object_new_object();
+    json_object_object_add(run_params, "model", json_object_new_string(session->model));
+    json_object_object_add(run_params, "role", json_object_new_string(role));
+    json_object_object_add(run_params, "prompt", json_object_new_string(text ? text : prompt));
+    json_object_object_add(run_params, "keep_history", json_object_new_int(1));
+    json_object_object_add(run_params, "prompt_cache", json_object_new_boolean(0));
+    const char* const stream_keys[] = { "stream_flush_tokens", "stream_flush_ms", "stop", "max_tokens", NULL };
+    for (int i = 0; stream_keys[i]; i++) {
+        json_object* value = NULL;
+        if (json_object_object_get_ex(params, stream_keys[i], &value)) {
+            json_object_object_add(run_params, stream_keys[i], json_object_get(value));
+        }
+    }
+    free(text);
+    
+    char* reply = NULL;
+    json_object* result = call_rkllm_run_with_reply(run_params, conn, request_id, &reply);
+    json_object_put(run_params);
+    
+    // A model reloaded under the same id during the run starts empty
+    ModelEntry* current = acquire_model(session->model);
+    if (!result && reply && current == model) {
+        record_turn(session, model, resident, role, prompt, reply);
+    } else {
+        free(reply);
+        if (!result) {
+            LOG_WARN_MSG("Session %d: turn did not finish, not recorded", session->id);
+        }
+    }
+    release_model(current);
+    release_model(model);
+    
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef CALL_SESSION_RUN_H
+#define CALL_SESSION_RUN_H
+
+#include <json-c/json.h>
+#include "../../connection/create_connection/create_connection.h"
+
+/**
+ * Runs the next turn of a session, streaming tokens like rkllm.run. The
+ * history is reused from the KV cache while the session still owns it and
+ * prefilled again from the transcript otherwise.
+ * @param params Object with session_id, prompt, optional role and stream options
+ * @param conn Client connection for streaming responses
+ * @param request_id JSON-RPC request id echoed in every streamed frame
+ * @return JSON error object, or NULL once the stream was sent
+ */
+json_object* call_session_run(json_object* params, Connection* conn, json_object* request_id);
+
+#endif
\ No newline at end of file
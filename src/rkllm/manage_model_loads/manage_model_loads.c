@@ -0,0 +1,229 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "manage_model_loads.h"
+#include "../../connection/send_to_connection/send_to_connection.h"
+#include "../../connection/retain_connection/retain_connection.h"
+#include "../../connection/release_connection/release_connection.h"
+#include "../../utils/log_message/log_message.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static ModelLoad loads[MAX_MODEL_LOADS];
+static int next_load_id = 1;
+static pthread_mutex_t loads_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t loads_cond = PTHREAD_COND_INITIALIZER;
+
+static const char* const state_names[] = {
+    "evicting", "initializing", "ready", "failed", "timeout"
+};
+
+static long long get_monotonic_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static int is_final_state(ModelLoadState state) {
+    return state >= MODEL_LOAD_READY;
+}
+
+// Caller holds loads_lock
+static ModelLoad* find_load(int load_id) {
+    for (int i = 0; i < MAX_MODEL_LOADS; i++) {
+        if (load_id > 0 && loads[i].id == load_id) {
+            return &loads[i];
+        }
+    }
+    return NULL;
+}
+
+// Caller holds loads_lock
+static json_object* describe_load(const ModelLoad* load) {
+    long long end_ms = load->finished_ms ? load->finished_ms : get_monotonic_ms();
+    
+    json_object* status = json_object_new_object();
+    json_object_object_add(status, "load_id", json_object_new_int(load->id));
+    json_object_object_add(status, "model", json_object_new_string(load->model));
+    json_object_object_add(status, "state", json_object_new_string(state_names[load->state]));
+    json_object_object_add(status, "done", json_object_new_boolean(is_final_state(load->state)));
+    json_object_object_add(status, "elapsed_ms", json_object_new_int64(end_ms - load->started_ms));
+    json_object_object_add(status, "timeout_ms", json_object_new_int(load->timeout_ms));
+    json_object_object_add(status, "memory_bytes", json_object_new_int64((int64_t)load->memory_bytes));
+    if (load->message[0]) {
+        json_object_object_add(status, "message", json_object_new_string(load->message));
+    }
+    return status;
+}
+
+/**
+ * Builds an rkllm.init_status notification (a request without id, so
+ * clients can tell it from responses); the rkllm.init id is in params
+ * Caller holds loads_lock
+ */
+static char* format_load_notification(const ModelLoad* load) {
+    // Each notification parses its own copy of the id: the request's
+    // json_object belongs to the I/O thread that frees it
+    json_object* params = describe_load(load);
+    json_object_object_add(params, "request_id", load->request_id ? json_tokener_parse(load->request_id) : NULL);
+    
+    json_object* notification = json_object_new_object();
+    json_object_object_add(notification, "jsonrpc", json_object_new_string("2.0"));
+    json_object_object_add(notification, "method", json_object_new_string("rkllm.init_status"));
+    json_object_object_add(notification, "params", params);
+    
+    const char* json_str = json_object_to_json_string(notification);
+    char* frame = json_str ? strdup(json_str) : NULL;
+    json_object_put(notification);
+    return frame;
+}
+
+int begin_model_load(const char* model_id, size_t memory_bytes, int timeout_ms,
+                     Connection* conn, json_object* request_id, int* active_id) {
+    if (active_id) {
+        *active_id = 0;
+    }
+    
+    pthread_mutex_lock(&loads_lock);
+    
+    // One load per model at a time; a free slot or else the oldest finished load
+    ModelLoad* slot = NULL;
+    for (int i = 0; i < MAX_MODEL_LOADS; i++) {
+        ModelLoad* load = &loads[i];
+        if (load->id == 0) {
+            if (!slot || slot->id != 0) {
+                slot = load;
+            }
+            continue;
+        }
+        if (!is_final_state(load->state)) {
+            if (strcmp(load->model, model_id) == 0) {
+                if (active_id) {
+                    *active_id = load->id;
+                }
+                pthread_mutex_unlock(&loads_lock);
+                return -1;
+            }
+            continue;
+        }
+        if (!slot || (slot->id != 0 && load->id < slot->id)) {
+            slot = load;
+        }
+    }
+    if (!slot) {
+        pthread_mutex_unlock(&loads_lock);
+        return -1;
+    }
+    
+    free(slot->request_id);
+    memset(slot, 0, sizeof(ModelLoad));
+    slot->id = next_load_id++;
+    snprintf(slot->model, sizeof(slot->model), "%s", model_id);
+    slot->state = MODEL_LOAD_EVICTING;
+    slot->memory_bytes = memory_bytes;
+    slot->timeout_ms = timeout_ms;
+    slot->started_ms = get_monotonic_ms();
+    slot->conn = conn ? retain_connection(conn) : NULL;
+    slot->request_id = request_id ? strdup(json_object_to_json_string_ext(request_id, JSON_C_TO_STRING_PLAIN)) : NULL;
+    int load_id = slot->id;
+    
+    pthread_mutex_unlock(&loads_lock);
+    return load_id;
+}
+
+int set_model_load_state(int load_id, ModelLoadState state, const char* message) {
+    pthread_mutex_lock(&loads_lock);
+    ModelLoad* load = find_load(load_id);
+    if (!load || is_final_state(load->state)) {
+        pthread_mutex_unlock(&loads_lock);
+        return -1;
+    }
+    
+    load->state = state;
+    if (message) {
+        snprintf(load->message, sizeof(load->message), "%s", message);
+    }
+    
+    Connection* conn = load->conn;
+    if (is_final_state(state)) {
+        load->finished_ms = get_monotonic_ms();
+        load->conn = NULL;
+        pthread_cond_broadcast(&loads_cond);
+    }
+    char* frame = conn ? format_load_notification(load) : NULL;
+    
+    LOG_INFO_MSG("Model load %d (%s): %s%s%s", load_id, load->model, state_names[state],
+                 message ? " - " : "", message ? message : "");
+    pthread_mutex_unlock(&loads_lock);
+    
+    // A client that disconnected simply misses the notification
+    if (frame) {
+        send_to_connection(conn, frame, strlen(frame));
+        free(frame);
+    }
+    if (conn && is_final_state(state)) {
+        release_connection(conn);
+    }
+    return 0;
+}
+
+json_object* get_model_load_status(int load_id) {
+    pthread_mutex_lock(&loads_lock);
+    ModelLoad* load = find_load(load_id);
+    json_object* status = load ? describe_load(load) : NULL;
+    pthread_mutex_unlock(&loads_lock);
+    return status;
+}
+
+int wait_for_model_load(int load_id) {
+    pthread_mutex_lock(&loads_lock);
+    ModelLoad* load = find_load(load_id);
+    while (load && !is_final_state(load->state)) {
+        pthread_cond_wait(&loads_cond, &loads_lock);
+        // The slot may have been reused while waiting
+        load = find_load(load_id);
+    }
+    int state = load ? (int)load->state : -1;
+    pthread_mutex_unlock(&loads_lock);
+    return state;
+}
+
+json_object* list_model_loads(void) {
+    json_object* list = json_object_new_array();
+    
+    pthread_mutex_lock(&loads_lock);
+    int last_id = next_load_id;
+    for (;;) {
+        // Ids only grow, so the next lower id is the next older load
+        ModelLoad* newest = NULL;
+        for (int i = 0; i < MAX_MODEL_LOADS; i++) {
+            if (loads[i].id != 0 && loads[i].id < last_id &&
+                (!newest || loads[i].id > newest->id)) {
+                newest = &loads[i];
+            }
+        }
+        if (!newest) {
+            break;
+        }
+        json_object_array_add(list, describe_load(newest));
+        last_id = newest->id;
+    }
+    pthread_mutex_unlock(&loads_lock);
+    
+    return list;
+}
+
+void destroy_model_loads(void) {
+    pthread_mutex_lock(&loads_lock);
+    for (int i = 0; i < MAX_MODEL_LOADS; i++) {
+        if (loads[i].conn) {
+            release_connection(loads[i].conn);
+        }
+        free(loads[i].request_id);
+    }
+    // A load still running finds no entry and reports nowhere
+    memset(loads, 0, sizeof(loads));
+    pthread_mutex_unlock(&loads_lock);
+}
\ No newline at end of file
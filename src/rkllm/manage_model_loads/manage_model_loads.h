@@ -0,0 +1,84 @@
+#ifndef MANAGE_MODEL_LOADS_H
+#define MANAGE_MODEL_LOADS_H
+
+#include <json-c/json.h>
+#include <stddef.h>
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../../connection/create_connection/create_connection.h"
+
+// Recent loads kept for rkllm.init_status; the oldest finished load is
+// forgotten first
+#define MAX_MODEL_LOADS 16
+
+// Stages of a background rkllm.init, in order; the last three are final
+typedef enum {
+    MODEL_LOAD_EVICTING = 0,    // Unloading idle models to make room
+    MODEL_LOAD_INITIALIZING,    // rkllm_init running
+    MODEL_LOAD_READY,           // Registered and usable
+    MODEL_LOAD_FAILED,          // rkllm_init or registration failed
+    MODEL_LOAD_TIMEOUT          // Gave up after the init timeout
+} ModelLoadState;
+
+// One background model load
+typedef struct {
+    int id;                     // Load job id returned by rkllm.init (0 = free slot)
+    char model[MODEL_ID_LENGTH];
+    ModelLoadState state;
+    size_t memory_bytes;        // Estimated size of the model
+    int timeout_ms;             // Budget for rkllm_init
+    long long started_ms;
+    long long finished_ms;      // 0 while the load is in progress
+    char message[128];          // Reason for a failure
+    Connection* conn;           // Client notified of each stage (retained; NULL once final)
+    char* request_id;           // Serialized id of the rkllm.init request, echoed in notifications (NULL = null)
+} ModelLoad;
+
+/**
+ * Records a new load in the evicting stage
+ * @param model_id Model being loaded
+ * @param memory_bytes Estimated model size
+ * @param timeout_ms Budget for rkllm_init
+ * @param conn Client to notify of progress (may be NULL)
+ * @param request_id Id of the rkllm.init request (may be NULL)
+ * @param active_id Set to the id of a load of the same model already in progress
+ * @return Load id (> 0), or -1 if the model is already loading or the table is full
+ */
+int begin_model_load(const char* model_id, size_t memory_bytes, int timeout_ms,
+                     Connection* conn, json_object* request_id, int* active_id);
+
+/**
+ * Moves a load to its next stage and notifies its client; a final stage
+ * also drops the client
+ * @param load_id Load id
+ * @param state New stage
+ * @param message Reason for a failure (may be NULL)
+ * @return 0 on success, -1 if the load is unknown or already final
+ */
+int set_model_load_state(int load_id, ModelLoadState state, const char* message);
+
+/**
+ * Describes a load
+ * @param load_id Load id
+ * @return JSON object with load_id, model, state and timings, or NULL if unknown
+ */
+json_object* get_model_load_status(int load_id);
+
+/**
+ * Blocks until a load reaches a final stage
+ * @param load_id Load id
+ * @return Final ModelLoadState, or -1 if the load is unknown
+ */
+int wait_for_model_load(int load_id);
+
+/**
+ * Describes every remembered load, newest first
+ * @return JSON array of load descriptions
+ */
+json_object* list_model_loads(void);
+
+/**
+ * Drops the clients of unfinished loads; used at shutdown
+ */
+void destroy_model_loads(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,414 @@
+#include "manage_model_registry.h"
+#include "../../utils/log_message/log_message.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Resident models; entries are heap-allocated so a held entry stays valid
+// after it leaves the table
+static ModelEntry** models = NULL;
+static int model_capacity = 0;
+static size_t memory_budget = 0;
+static size_t memory_used = 0;
+static unsigned long long lru_clock = 0;
+static unsigned long long load_clock = 0;
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Loads between reserve_model_memory and register_model (or
+// cancel_model_reservation); their memory and slots count as used, so
+// concurrent loads cannot both pass the budget
+typedef struct {
+    char id[MODEL_ID_LENGTH];
+    size_t memory_bytes;
+    int active;
+} PendingModel;
+
+static PendingModel* pending = NULL;
+static int pending_capacity = 0;
+
+int init_model_registry(size_t memory_budget_bytes, int max_models) {
+    if (max_models < 1) {
+        max_models = 1;
+    }
+    
+    pthread_mutex_lock(&registry_lock);
+    models = calloc((size_t)max_models, sizeof(ModelEntry*));
+    // Each resident model can be replaced by one load while max_models
+    // other loads wait for free slots
+    pending = calloc((size_t)max_models * 2, sizeof(PendingModel));
+    if (!models || !pending) {
+        free(models);
+        free(pending);
+        models = NULL;
+        pending = NULL;
+        pthread_mutex_unlock(&registry_lock);
+        return -1;
+    }
+    model_capacity = max_models;
+    pending_capacity = max_models * 2;
+    memory_budget = memory_budget_bytes;
+    memory_used = 0;
+    pthread_mutex_unlock(&registry_lock);
+    
+    return 0;
+}
+
+const char* get_model_name(json_object* params) {
+    json_object* model_obj = NULL;
+    if (params && json_object_is_type(params, json_type_object) &&
+        json_object_object_get_ex(params, "model", &model_obj) &&
+        json_object_is_type(model_obj, json_type_string)) {
+        return json_object_get_string(model_obj);
+    }
+    return NULL;
+}
+
+static void free_entry(ModelEntry* model) {
+    LOG_INFO_MSG("Destroying model '%s'", model->id);
+    rkllm_destroy(model->handle);
+    free(model->model_path);
+    free(model->system_prompt);
+    free(model->prompt_prefix);
+    free(model->prompt_postfix);
+    free(model);
+}
+
+// Caller holds registry_lock
+static int find_index(const char* name) {
+    int found = -1;
+    for (int i = 0; i < model_capacity; i++) {
+        if (!models[i]) {
+            continue;
+        }
+        if (name) {
+            if (strcmp(models[i]->id, name) == 0) {
+                return i;
+            }
+        } else if (found < 0 || models[i]->loaded_seq > models[found]->loaded_seq) {
+            found = i;
+        }
+    }
+    return found;
+}
+
+/**
+ * Takes a model out of the table; returns it if it should be destroyed
+ * now, or NULL if a holder will destroy it on release
+ * Caller holds registry_lock
+ */
+static ModelEntry* detach_index(int index) {
+    ModelEntry* model = models[index];
+    models[index] = NULL;
+    memory_used -= model->memory_bytes;
+    model->unloading = 1;
+    return model->refs == 0 ? model : NULL;
+}
+
+ModelEntry* acquire_model(const char* name) {
+    pthread_mutex_lock(&registry_lock);
+    ModelEntry* model = NULL;
+    int index = models ? find_index(name) : -1;
+    if (index >= 0) {
+        model = models[index];
+        model->refs++;
+        model->last_used = ++lru_clock;
+    }
+    pthread_mutex_unlock(&registry_lock);
+    return model;
+}
+
+void release_model(ModelEntry* model) {
+    if (!model) {
+        return;
+    }
+    
+    pthread_mutex_lock(&registry_lock);
+    model->refs--;
+    int destroy = model->unloading && model->refs == 0;
+    pthread_mutex_unlock(&registry_lock);
+    
+    if (destroy) {
+        free_entry(model);
+    }
+}
+
+json_object* model_not_loaded_error(const char* name) {
+    char message[MODEL_ID_LENGTH + 64];
+    if (name) {
+        snprintf(message, sizeof(message), "Model '%s' is not loaded", name);
+    } else {
+        snprintf(message, sizeof(message), "Model not initialized - call rkllm.init first");
+    }
+    
+    json_object* error_result = json_object_new_object();
+    json_object_object_add(error_result, "code", json_object_new_int(-32000));
+    json_object_object_add(error_result, "message", json_object_new_string(message));
+    return error_result;
+}
+
+/**
+ * Memory and slots taken by resident models and pending loads
+ * Caller holds registry_lock
+ */
+static void count_usage(const char* replacing, size_t* used, int* count) {
+    *used = memory_used;
+    *count = 0;
+    
+    // The model being replaced frees its slot and memory anyway
+    for (int i = 0; i < model_capacity; i++) {
+        if (!models[i]) {
+            continue;
+        }
+        if (replacing && strcmp(models[i]->id, replacing) == 0) {
+            *used -= models[i]->memory_bytes;
+            continue;
+        }
+        (*count)++;
+    }
+    
+    // A pending load that replaces a resident model takes over its slot
+    for (int i = 0; i < pending_capacity; i++) {
+        if (!pending[i].active) {
+            continue;
+        }
+        *used += pending[i].memory_bytes;
+        if (find_index(pending[i].id) < 0) {
+            (*count)++;
+        }
+    }
+}
+
+int reserve_model_memory(size_t memory_bytes, const char* replacing) {
+    if (memory_budget > 0 && memory_bytes > memory_budget) {
+        LOG_WARN_MSG("Model needs %zu bytes, more than the whole budget of %zu", memory_bytes, memory_budget);
+        return -1;
+    }
+    
+    ModelEntry* evicted[model_capacity > 0 ? model_capacity : 1];
+    int evicted_count = 0;
+    int result = -1;
+    
+    pthread_mutex_lock(&registry_lock);
+    for (;;) {
+        size_t used = 0;
+        int count = 0;
+        count_usage(replacing, &used, &count);
+        if (count < model_capacity && (memory_budget == 0 || used + memory_bytes <= memory_budget)) {
+            // Hold the memory and slot until the load registers or fails
+            for (int i = 0; i < pending_capacity; i++) {
+                if (!pending[i].active) {
+                    snprintf(pending[i].id, sizeof(pending[i].id), "%s", replacing ? replacing : "");
+                    pending[i].memory_bytes = memory_bytes;
+                    pending[i].active = 1;
+                    result = i;
+                    break;
+                }
+            }
+            break;
+        }
+        
+        // Evict the least recently used model nobody is using
+        int victim = -1;
+        for (int i = 0; i < model_capacity; i++) {
+            if (!models[i] || models[i]->refs > 0 ||
+                (replacing && strcmp(models[i]->id, replacing) == 0)) {
+                continue;
+            }
+            if (victim < 0 || models[i]->last_used < models[victim]->last_used) {
+                victim = i;
+            }
+        }
+        if (victim < 0) {
+            break;
+        }
+        
+        LOG_INFO_MSG("Evicting least recently used model '%s'", models[victim]->id);
+        evicted[evicted_count++] = detach_index(victim);
+    }
+    pthread_mutex_unlock(&registry_lock);
+    
+    // rkllm_destroy can take a while; run it outside the lock
+    for (int i = 0; i < evicted_count; i++) {
+        if (evicted[i]) {
+            free_entry(evicted[i]);
+        }
+    }
+    return result;
+}
+
+void cancel_model_reservation(int reservation) {
+    pthread_mutex_lock(&registry_lock);
+    if (pending && reservation >= 0 && reservation < pending_capacity) {
+        pending[reservation].active = 0;
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+
+int register_model(const char* id, const char* model_path, LLMHandle handle,
+                   int n_batch, int reservation) {
+    if (!id || !handle) {
+        return -1;
+    }
+    
+    ModelEntry* model = calloc(1, sizeof(ModelEntry));
+    if (!model) {
+        return -1;
+    }
+    snprintf(model->id, sizeof(model->id), "%s", id);
+    model->model_path = model_path ? strdup(model_path) : NULL;
+    model->handle = handle;
+    model->n_batch = n_batch > 0 ? n_batch : 1;
+    
+    ModelEntry* replaced = NULL;
+    pthread_mutex_lock(&registry_lock);
+    if (!pending || reservation < 0 || reservation >= pending_capacity || !pending[reservation].active) {
+        pthread_mutex_unlock(&registry_lock);
+        free(model->model_path);
+        free(model);
+        return -1;
+    }
+    
+    size_t memory_bytes = pending[reservation].memory_bytes;
+    model->memory_bytes = memory_bytes;
+    
+    int index = find_index(id);
+    if (index >= 0) {
+        replaced = detach_index(index);
+    } else {
+        for (int i = 0; i < model_capacity; i++) {
+            if (!models[i]) {
+                index = i;
+                break;
+            }
+        }
+    }
+    if (index < 0) {
+        pthread_mutex_unlock(&registry_lock);
+        free(model->model_path);
+        free(model);
+        return -1;
+    }
+    
+    // The reservation becomes the resident model
+    pending[reservation].active = 0;
+    model->last_used = ++lru_clock;
+    model->loaded_seq = ++load_clock;
+    models[index] = model;
+    memory_used += memory_bytes;
+    pthread_mutex_unlock(&registry_lock);
+    
+    if (replaced) {
+        free_entry(replaced);
+    }
+    
+    LOG_INFO_MSG("Model '%s' resident (%zu bytes, n_batch %d)", model->id, memory_bytes, model->n_batch);
+    return 0;
+}
+
+int set_model_chat_template(ModelEntry* model, const char* system, const char* prefix, const char* postfix) {
+    forget_model_system_prompt(model);
+    free(model->prompt_prefix);
+    free(model->prompt_postfix);
+    model->prompt_prefix = NULL;
+    model->prompt_postfix = NULL;
+    if (!prefix || !postfix) {
+        return 0;
+    }
+    
+    model->prompt_prefix = strdup(prefix);
+    model->prompt_postfix = strdup(postfix);
+    model->system_prompt = system ? strdup(system) : NULL;
+    if (!model->prompt_prefix || !model->prompt_postfix || (system && !model->system_prompt)) {
+        forget_model_system_prompt(model);
+        free(model->prompt_prefix);
+        free(model->prompt_postfix);
+        model->prompt_prefix = NULL;
+        model->prompt_postfix = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+void forget_model_system_prompt(ModelEntry* model) {
+    free(model->system_prompt);
+    model->system_prompt = NULL;
+}
+
+int unload_model(const char* name) {
+    pthread_mutex_lock(&registry_lock);
+    int index = models ? find_index(name) : -1;
+    if (index < 0) {
+        pthread_mutex_unlock(&registry_lock);
+        return -1;
+    }
+    ModelEntry* model = detach_index(index);
+    pthread_mutex_unlock(&registry_lock);
+    
+    if (model) {
+        free_entry(model);
+    }
+    return 0;
+}
+
+json_object* list_models(void) {
+    json_object* result = json_object_new_object();
+    json_object* list = json_object_new_array();
+    
+    pthread_mutex_lock(&registry_lock);
+    int newest = find_index(NULL);
+    for (int i = 0; i < model_capacity; i++) {
+        ModelEntry* model = models[i];
+        if (!model) {
+            continue;
+        }
+        json_object* item = json_object_new_object();
+        json_object_object_add(item, "model", json_object_new_string(model->id));
+        json_object_object_add(item, "model_path", json_object_new_string(model->model_path ? model->model_path : ""));
+        json_object_object_add(item, "memory_bytes", json_object_new_int64((int64_t)model->memory_bytes));
+        json_object_object_add(item, "n_batch", json_object_new_int(model->n_batch));
+        json_object_object_add(item, "in_use", json_object_new_boolean(model->refs > 0));
+        json_object_object_add(item, "default", json_object_new_boolean(i == newest));
+        json_object_array_add(list, item);
+    }
+    json_object_object_add(result, "models", list);
+    json_object_object_add(result, "memory_used", json_object_new_int64((int64_t)memory_used));
+    json_object_object_add(result, "memory_budget", json_object_new_int64((int64_t)memory_budget));
+    json_object_object_add(result, "max_models", json_object_new_int(model_capacity));
+    pthread_mutex_unlock(&registry_lock);
+    
+    return result;
+}
+
+void destroy_model_registry(void) {
+    pthread_mutex_lock(&registry_lock);
+    ModelEntry** table = models;
+    int capacity = model_capacity;
+    models = NULL;
+    model_capacity = 0;
+    memory_used = 0;
+    free(pending);
+    pending = NULL;
+    pending_capacity = 0;
+    
+    // A model still held by a running stream is destroyed by its last release
+    for (int i = 0; table && i < capacity; i++) {
+        if (table[i]) {
+            table[i]->unloading = 1;
+            if (table[i]->refs > 0) {
+                table[i] = NULL;
+            }
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+    
+    if (!table) {
+        return;
+    }
+    for (int i = 0; i < capacity; i++) {
+        if (table[i]) {
+            free_entry(table[i]);
+        }
+    }
+    free(table);
+}
\ No newline at end of file
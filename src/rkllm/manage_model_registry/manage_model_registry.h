@@ -0,0 +1,134 @@
+#ifndef MANAGE_MODEL_REGISTRY_H
+#define MANAGE_MODEL_REGISTRY_H
+
+#include <json-c/json.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <rkllm.h>
+
+#define MODEL_ID_LENGTH 64
+
+// One resident RKLLM model
+typedef struct {
+    char id[MODEL_ID_LENGTH];   // Name used in the "model" field of rkllm.* requests
+    char* model_path;
+    LLMHandle handle;
+    int n_batch;                // Batch slots of the handle (extend_param.n_batch)
+    size_t memory_bytes;        // Estimated resident size, counted against the budget
+    unsigned long long last_used; // LRU clock value of the latest acquire
+    unsigned long long loaded_seq; // Load order; the newest model is the default
+    int refs;                   // Callers currently using the handle
+    unsigned long long prompt_prefix_hash; // System prompt and template prefix set on the handle (0 = model default)
+    char* system_prompt;        // System prompt of rkllm.set_chat_template (NULL = unknown, e.g. tools rendered in)
+    char* prompt_prefix;        // Template around each input, set with rkllm.set_chat_template
+    char* prompt_postfix;       // (both NULL = the model's built-in template, which the runtime does not expose)
+    unsigned long long prompt_cache_key; // Prompt cache loaded into the handle (0 = none)
+    unsigned long long prompt_cache_failed; // Prompt cache whose priming run saved nothing (not retried)
+    int kv_session;             // Session whose history fills the KV cache (0 = none; NPU worker only)
+    int unloading;              // Out of the registry; destroyed on the last release
+} ModelEntry;
+
+/**
+ * Initializes the registry
+ * @param memory_budget_bytes Total estimated size of resident models (0 = no limit)
+ * @param max_models Maximum number of resident models
+ * @return 0 on success, -1 on error
+ */
+int init_model_registry(size_t memory_budget_bytes, int max_models);
+
+/**
+ * Reads the optional "model" field of request params
+ * @param params Request params (may be NULL or a non-object)
+ * @return Model id (borrowed from params) or NULL for the default model
+ */
+const char* get_model_name(json_object* params);
+
+/**
+ * Looks up a model and holds it until release_model, so eviction or
+ * rkllm.destroy cannot free the handle while it is in use
+ * @param name Model id, or NULL for the most recently loaded model
+ * @return Entry or NULL if no such model is loaded
+ */
+ModelEntry* acquire_model(const char* name);
+
+/**
+ * Drops a hold taken with acquire_model
+ * @param model Entry (may be NULL)
+ */
+void release_model(ModelEntry* model);
+
+/**
+ * Builds the error result for a request naming a model that is not loaded
+ * @param name Requested model id (NULL if none was given)
+ * @return JSON error object with code and message
+ */
+json_object* model_not_loaded_error(const char* name);
+
+/**
+ * Makes room for a model about to be loaded by unloading least recently
+ * used idle models until the memory budget and model count allow it, and
+ * holds that room for the load until register_model or
+ * cancel_model_reservation, so concurrent loads count against each other
+ * @param memory_bytes Estimated size of the new model
+ * @param replacing Id of a model the new one replaces (not counted; may be NULL)
+ * @return Reservation number, or -1 if models in use prevent the load
+ */
+int reserve_model_memory(size_t memory_bytes, const char* replacing);
+
+/**
+ * Gives back the room held for a load that failed
+ * @param reservation Number returned by reserve_model_memory
+ */
+void cancel_model_reservation(int reservation);
+
+/**
+ * Adds a loaded model in the room held by its reservation; a model
+ * already registered under the same id is unloaded first
+ * @param id Model id
+ * @param model_path Path the model was loaded from
+ * @param handle Initialized handle (owned by the registry on success)
+ * @param n_batch Batch slots of the handle
+ * @param reservation Number returned by reserve_model_memory; consumed on success
+ * @return 0 on success, -1 on error (handle and reservation still owned by the caller)
+ */
+int register_model(const char* id, const char* model_path, LLMHandle handle,
+                   int n_batch, int reservation);
+
+/**
+ * Records the system prompt and the template the runtime now wraps
+ * around each input; only called on the NPU worker, like every user of
+ * the template
+ * @param model Model whose template changed
+ * @param system System prompt (NULL = unknown)
+ * @param prefix Text before each input (NULL = unknown)
+ * @param postfix Text after each input (NULL = unknown)
+ * @return 0 on success, -1 on allocation failure (the template is then unknown)
+ */
+int set_model_chat_template(ModelEntry* model, const char* system, const char* prefix, const char* postfix);
+
+/**
+ * Marks the system prompt as unknown, e.g. once rkllm.set_function_tools
+ * rendered tool definitions into it; the template stays known
+ * @param model Model whose system prompt changed
+ */
+void forget_model_system_prompt(ModelEntry* model);
+
+/**
+ * Removes a model; its handle is destroyed now or by the last release
+ * @param name Model id, or NULL for the default model
+ * @return 0 on success, -1 if no such model is loaded
+ */
+int unload_model(const char* name);
+
+/**
+ * Describes the resident models
+ * @return JSON object with the models, budget and usage
+ */
+json_object* list_models(void);
+
+/**
+ * Destroys every model; used at shutdown once no request is running
+ */
+void destroy_model_registry(void);
+
+#endif
\ No newline at end of file
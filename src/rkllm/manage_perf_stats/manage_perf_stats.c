@@ -0,0 +1,274 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "manage_perf_stats.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Upper bounds of the histogram buckets (1-2-5 steps); one more bucket
+// counts everything above the last bound
+static const double bucket_bounds[] = {
+    0.1, 0.2, 0.5, 1, 2, 5, 10, 20, 50, 100, 200, 500,
+    1000, 2000, 5000, 10000, 20000, 50000, 100000
+};
+#define BOUND_COUNT ((int)(sizeof(bucket_bounds) / sizeof(bucket_bounds[0])))
+#define BUCKET_COUNT (BOUND_COUNT + 1)
+
+typedef struct {
+    long long count;
+    double sum;
+    double min;
+    double max;
+    long long buckets[BUCKET_COUNT];
+} PerfHistogram;
+
+static const char* const metric_names[PERF_METRIC_COUNT] = {
+    "queue_wait_ms", "ttft_ms", "itl_ms", "prefill_ms", "generate_ms",
+    "prefill_tokens_per_s", "generate_tokens_per_s"
+};
+
+static PerfHistogram histograms[PERF_METRIC_COUNT];
+static long long total_runs = 0;
+static long long total_prefill_tokens = 0;
+static long long total_generate_tokens = 0;
+static double peak_memory_mb = 0;
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static long long get_monotonic_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+// Two decimals are plenty for milliseconds and rates
+static json_object* new_rounded(double value) {
+    return json_object_new_double((double)(long long)(value * 100 + (value < 0 ? -0.5 : 0.5)) / 100);
+}
+
+// Caller holds stats_lock
+static void add_sample(PerfMetric metric, double value) {
+    PerfHistogram* histogram = &histograms[metric];
+    if (histogram->count == 0 || value < histogram->min) {
+        histogram->min = value;
+    }
+    if (histogram->count == 0 || value > histogram->max) {
+        histogram->max = value;
+    }
+    histogram->count++;
+    histogram->sum += value;
+    
+    int bucket = 0;
+    while (bucket < BOUND_COUNT && value > bucket_bounds[bucket]) {
+        bucket++;
+    }
+    histogram->buckets[bucket]++;
+}
+
+/**
+ * Estimates a percentile by interpolating inside the bucket that holds it
+ * Caller holds stats_lock
+ */
+static double histogram_percentile(const PerfHistogram* histogram, double fraction) {
+    double rank = fraction * (double)histogram->count;
+    long long seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        if (histogram->buckets[i] == 0 || (double)(seen + histogram->buckets[i]) < rank) {
+            seen += histogram->buckets[i];
+            continue;
+        }
+        double lower = i > 0 ? bucket_bounds[i - 1] : 0;
+        double upper = i < BOUND_COUNT ? bucket_bounds[i] : histogram->max;
+        if (lower < histogram->min) {
+            lower = histogram->min;
+        }
+        if (upper > histogram->max) {
+            upper = histogram->max;
+        }
+        return lower + (upper - lower) * (rank - (double)seen) / (double)histogram->buckets[i];
+    }
+    return histogram->max;
+}
+
+static int compare_floats(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static double sorted_percentile(const float* sorted, int count, double fraction) {
+    int index = (int)(fraction * count + 0.999999) - 1;
+    if (index < 0) {
+        index = 0;
+    }
+    if (index >= count) {
+        index = count - 1;
+    }
+    return sorted[index];
+}
+
+void begin_run_timings(RunTimings* timings, long long queue_wait_ms) {
+    memset(timings, 0, sizeof(RunTimings));
+    timings->queue_wait_ms = queue_wait_ms > 0 ? queue_wait_ms : 0;
+    timings->start_us = get_monotonic_us();
+}
+
+void record_run_token(RunTimings* timings) {
+    long long now_us = get_monotonic_us();
+    if (timings->first_token_us == 0) {
+        timings->first_token_us = now_us;
+        timings->last_token_us = now_us;
+        return;
+    }
+    
+    if (timings->gap_count == timings->gap_capacity) {
+        int capacity = timings->gap_capacity ? timings->gap_capacity * 2 : 256;
+        float* gaps = realloc(timings->gaps_ms, (size_t)capacity * sizeof(float));
+        if (!gaps) {
+            // Percentiles then cover the tokens recorded so far
+            timings->last_token_us = now_us;
+            return;
+        }
+        timings->gaps_ms = gaps;
+        timings->gap_capacity = capacity;
+    }
+    timings->gaps_ms[timings->gap_count++] = (float)(now_us - timings->last_token_us) / 1000.0f;
+    timings->last_token_us = now_us;
+}
+
+json_object* finish_run_timings(RunTimings* timings, const RKLLMPerfStat* perf) {
+    json_object* result = json_object_new_object();
+    json_object_object_add(result, "queue_wait_ms", json_object_new_int64(timings->queue_wait_ms));
+    
+    double ttft_ms = -1;
+    if (timings->first_token_us) {
+        ttft_ms = (double)(timings->first_token_us - timings->start_us) / 1000.0;
+        json_object_object_add(result, "ttft_ms", new_rounded(ttft_ms));
+    }
+    
+    // Exact percentiles for the request; the samples themselves go to the
+    // server-wide histogram
+    if (timings->gap_count > 0) {
+        float* sorted = malloc((size_t)timings->gap_count * sizeof(float));
+        if (sorted) {
+            memcpy(sorted, timings->gaps_ms, (size_t)timings->gap_count * sizeof(float));
+            qsort(sorted, (size_t)timings->gap_count, sizeof(float), compare_floats);
+            json_object* itl = json_object_new_object();
+            json_object_object_add(itl, "p50", new_rounded(sorted_percentile(sorted, timings->gap_count, 0.50)));
+            json_object_object_add(itl, "p90", new_rounded(sorted_percentile(sorted, timings->gap_count, 0.90)));
+            json_object_object_add(itl, "p99", new_rounded(sorted_percentile(sorted, timings->gap_count, 0.99)));
+            json_object_object_add(itl, "max", new_rounded(sorted[timings->gap_count - 1]));
+            json_object_object_add(result, "itl_ms", itl);
+            free(sorted);
+        }
+    }
+    
+    double prefill_rate = 0;
+    double generate_rate = 0;
+    if (perf) {
+        json_object_object_add(result, "prefill_ms", new_rounded(perf->prefill_time_ms));
+        json_object_object_add(result, "prefill_tokens", json_object_new_int(perf->prefill_tokens));
+        json_object_object_add(result, "generate_ms", new_rounded(perf->generate_time_ms));
+        json_object_object_add(result, "generate_tokens", json_object_new_int(perf->generate_tokens));
+        json_object_object_add(result, "memory_usage_mb", new_rounded(perf->memory_usage_mb));
+        if (perf->prefill_time_ms > 0) {
+            prefill_rate = perf->prefill_tokens * 1000.0 / perf->prefill_time_ms;
+            json_object_object_add(result, "prefill_tokens_per_s", new_rounded(prefill_rate));
+        }
+        if (perf->generate_time_ms > 0) {
+            generate_rate = perf->generate_tokens * 1000.0 / perf->generate_time_ms;
+            json_object_object_add(result, "generate_tokens_per_s", new_rounded(generate_rate));
+        }
+    }
+    
+    pthread_mutex_lock(&stats_lock);
+    total_runs++;
+    add_sample(PERF_QUEUE_WAIT_MS, (double)timings->queue_wait_ms);
+    if (ttft_ms >= 0) {
+        add_sample(PERF_TTFT_MS, ttft_ms);
+    }
+    for (int i = 0; i < timings->gap_count; i++) {
+        add_sample(PERF_ITL_MS, timings->gaps_ms[i]);
+    }
+    if (perf) {
+        total_prefill_tokens += perf->prefill_tokens;
+        total_generate_tokens += perf->generate_tokens;
+        if (perf->memory_usage_mb > peak_memory_mb) {
+            peak_memory_mb = perf->memory_usage_mb;
+        }
+        if (perf->prefill_tokens > 0) {
+            add_sample(PERF_PREFILL_MS, perf->prefill_time_ms);
+        }
+        if (perf->generate_tokens > 0) {
+            add_sample(PERF_GENERATE_MS, perf->generate_time_ms);
+        }
+        if (prefill_rate > 0) {
+            add_sample(PERF_PREFILL_TOKENS_PER_S, prefill_rate);
+        }
+        if (generate_rate > 0) {
+            add_sample(PERF_GENERATE_TOKENS_PER_S, generate_rate);
+        }
+    }
+    pthread_mutex_unlock(&stats_lock);
+    
+    return result;
+}
+
+void free_run_timings(RunTimings* timings) {
+    free(timings->gaps_ms);
+    timings->gaps_ms = NULL;
+    timings->gap_count = 0;
+    timings->gap_capacity = 0;
+}
+
+json_object* get_perf_stats(int reset) {
+    json_object* result = json_object_new_object();
+    json_object* metrics = json_object_new_object();
+    
+    pthread_mutex_lock(&stats_lock);
+    json_object_object_add(result, "runs", json_object_new_int64(total_runs));
+    json_object_object_add(result, "prefill_tokens", json_object_new_int64(total_prefill_tokens));
+    json_object_object_add(result, "generate_tokens", json_object_new_int64(total_generate_tokens));
+    json_object_object_add(result, "peak_memory_mb", new_rounded(peak_memory_mb));
+    
+    for (int m = 0; m < PERF_METRIC_COUNT; m++) {
+        const PerfHistogram* histogram = &histograms[m];
+        json_object* item = json_object_new_object();
+        json_object_object_add(item, "count", json_object_new_int64(histogram->count));
+        if (histogram->count > 0) {
+            json_object_object_add(item, "mean", new_rounded(histogram->sum / (double)histogram->count));
+            json_object_object_add(item, "min", new_rounded(histogram->min));
+            json_object_object_add(item, "max", new_rounded(histogram->max));
+            json_object_object_add(item, "p50", new_rounded(histogram_percentile(histogram, 0.50)));
+            json_object_object_add(item, "p90", new_rounded(histogram_percentile(histogram, 0.90)));
+            json_object_object_add(item, "p99", new_rounded(histogram_percentile(histogram, 0.99)));
+        }
+        
+        // Non-empty buckets only; "le" is the inclusive upper bound (null = above the last bound)
+        json_object* buckets = json_object_new_array();
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            if (histogram->buckets[i] == 0) {
+                continue;
+            }
+            json_object* bucket = json_object_new_object();
+            json_object_object_add(bucket, "le", i < BOUND_COUNT ? json_object_new_double(bucket_bounds[i]) : NULL);
+            json_object_object_add(bucket, "count", json_object_new_int64(histogram->buckets[i]));
+            json_object_array_add(buckets, bucket);
+        }
+        json_object_object_add(item, "buckets", buckets);
+        json_object_object_add(metrics, metric_names[m], item);
+    }
+    
+    if (reset) {
+        memset(histograms, 0, sizeof(histograms));
+        total_runs = 0;
+        total_prefill_tokens = 0;
+        total_generate_tokens = 0;
+        peak_memory_mb = 0;
+    }
+    pthread_mutex_unlock(&stats_lock);
+    
+    json_object_object_add(result, "histograms", metrics);
+    return result;
+}
\ No newline at end of file
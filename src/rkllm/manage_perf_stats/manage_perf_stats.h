@@ -0,0 +1,65 @@
+#ifndef MANAGE_PERF_STATS_H
+#define MANAGE_PERF_STATS_H
+
+#include <json-c/json.h>
+#include <stdbool.h>
+#include <rkllm.h>
+
+// Server-wide distributions collected from finished runs
+typedef enum {
+    PERF_QUEUE_WAIT_MS = 0,     // Time a request waited for the NPU worker
+    PERF_TTFT_MS,               // Run start to first token
+    PERF_ITL_MS,                // Gap between consecutive tokens
+    PERF_PREFILL_MS,            // Runtime-reported prefill time
+    PERF_GENERATE_MS,           // Runtime-reported decode time
+    PERF_PREFILL_TOKENS_PER_S,
+    PERF_GENERATE_TOKENS_PER_S,
+    PERF_METRIC_COUNT
+} PerfMetric;
+
+// Server-side timings of one run, kept in its streaming context
+typedef struct {
+    long long queue_wait_ms;    // Time the request waited for the NPU worker
+    long long start_us;         // Monotonic time the run started
+    long long first_token_us;   // Arrival of the first token (0 = none yet)
+    long long last_token_us;    // Arrival of the newest token
+    float* gaps_ms;             // Inter-token latencies
+    int gap_count;
+    int gap_capacity;
+} RunTimings;
+
+/**
+ * Starts timing a run
+ * @param timings Timings to initialize
+ * @param queue_wait_ms Time the request spent queued
+ */
+void begin_run_timings(RunTimings* timings, long long queue_wait_ms);
+
+/**
+ * Records the arrival of a token
+ * @param timings Timings of the run
+ */
+void record_run_token(RunTimings* timings);
+
+/**
+ * Summarizes a finished run and adds it to the server-wide histograms
+ * @param timings Timings of the run
+ * @param perf Runtime statistics from the final callback (may be NULL)
+ * @return JSON object for the final frame's "perf" field
+ */
+json_object* finish_run_timings(RunTimings* timings, const RKLLMPerfStat* perf);
+
+/**
+ * Releases the samples of a run
+ * @param timings Timings of the run
+ */
+void free_run_timings(RunTimings* timings);
+
+/**
+ * Describes the server-wide histograms
+ * @param reset Non-zero to start a new collection window afterwards
+ * @return JSON object with totals and one histogram per metric
+ */
+json_object* get_perf_stats(int reset);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,335 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "manage_prompt_cache.h"
+#include "../../utils/log_message/log_message.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <rkllm.h>
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+// Cache files are named <16 hex digits of the key><suffix>
+#define PROMPT_CACHE_SUFFIX ".rkcache"
+
+// One cache file on disk
+typedef struct {
+    unsigned long long key;
+    size_t size;
+    time_t last_used;           // Mirrors the file mtime, so LRU order survives restarts
+} PromptCacheFile;
+
+static char* cache_directory = NULL;
+static size_t cache_budget = 0;
+static PromptCacheFile* cache_files = NULL;
+static int cache_count = 0;
+static int cache_capacity = 0;
+static size_t cache_bytes = 0;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+unsigned long long hash_prompt_text(unsigned long long hash, const char* text) {
+    if (hash == 0) {
+        hash = FNV_OFFSET_BASIS;
+    }
+    for (const unsigned char* p = (const unsigned char*)(text ? text : ""); *p; p++) {
+        hash ^= *p;
+        hash *= FNV_PRIME;
+    }
+    
+    // Separator, so ("ab","c") and ("a","bc") differ
+    hash ^= 0xff;
+    hash *= FNV_PRIME;
+    return hash ? hash : 1;
+}
+
+static char* format_cache_path(unsigned long long key) {
+    size_t length = strlen(cache_directory) + 1 + 16 + strlen(PROMPT_CACHE_SUFFIX) + 1;
+    char* path = malloc(length);
+    if (path) {
+        snprintf(path, length, "%s/%016llx%s", cache_directory, key, PROMPT_CACHE_SUFFIX);
+    }
+    return path;
+}
+
+// Caller holds cache_lock
+static PromptCacheFile* find_cache_file(unsigned long long key) {
+    for (int i = 0; i < cache_count; i++) {
+        if (cache_files[i].key == key) {
+            return &cache_files[i];
+        }
+    }
+    return NULL;
+}
+
+// Caller holds cache_lock
+static PromptCacheFile* add_cache_file(unsigned long long key, size_t size, time_t last_used) {
+    if (cache_count == cache_capacity) {
+        int capacity = cache_capacity ? cache_capacity * 2 : 16;
+        PromptCacheFile* files = realloc(cache_files, (size_t)capacity * sizeof(PromptCacheFile));
+        if (!files) {
+            return NULL;
+        }
+        cache_files = files;
+        cache_capacity = capacity;
+    }
+    
+    PromptCacheFile* file = &cache_files[cache_count++];
+    file->key = key;
+    file->size = size;
+    file->last_used = last_used;
+    cache_bytes += size;
+    return file;
+}
+
+// Caller holds cache_lock
+static void remove_cache_file(int index) {
+    char* path = format_cache_path(cache_files[index].key);
+    if (path) {
+        unlink(path);
+        free(path);
+    }
+    cache_bytes -= cache_files[index].size;
+    cache_files[index] = cache_files[--cache_count];
+}
+
+/**
+ * Deletes least recently used files until the cache fits its budget
+ * Caller holds cache_lock
+ */
+static void evict_cache_files(unsigned long long keep_key) {
+    while (cache_budget > 0 && cache_bytes > cache_budget) {
+        int victim = -1;
+        for (int i = 0; i < cache_count; i++) {
+            if (cache_files[i].key != keep_key &&
+                (victim < 0 || cache_files[i].last_used < cache_files[victim].last_used)) {
+                victim = i;
+            }
+        }
+        if (victim < 0) {
+            break;
+        }
+        LOG_INFO_MSG("Evicting prompt cache %016llx (%zu bytes)", cache_files[victim].key, cache_files[victim].size);
+        remove_cache_file(victim);
+    }
+}
+
+// Caller holds cache_lock
+static void touch_cache_file(PromptCacheFile* file) {
+    file->last_used = time(NULL);
+    char* path = format_cache_path(file->key);
+    if (path) {
+        utimensat(AT_FDCWD, path, NULL, 0);
+        free(path);
+    }
+}
+
+int init_prompt_cache(const char* directory, size_t budget_bytes) {
+    if (!directory || directory[0] == '\0') {
+        return 0;
+    }
+    
+    if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+        LOG_ERROR_MSG("Cannot create prompt cache directory %s: %s", directory, strerror(errno));
+        return -1;
+    }
+    DIR* dir = opendir(directory);
+    if (!dir) {
+        LOG_ERROR_MSG("Cannot open prompt cache directory %s: %s", directory, strerror(errno));
+        return -1;
+    }
+    
+    pthread_mutex_lock(&cache_lock);
+    cache_directory = strdup(directory);
+    cache_budget = budget_bytes;
+    
+    // Files saved by earlier runs stay usable
+    struct dirent* entry;
+    while (cache_directory && (entry = readdir(dir)) != NULL) {
+        unsigned long long key = 0;
+        char suffix[16] = "";
+        if (strlen(entry->d_name) != 16 + strlen(PROMPT_CACHE_SUFFIX) ||
+            sscanf(entry->d_name, "%16llx%15s", &key, suffix) != 2 ||
+            strcmp(suffix, PROMPT_CACHE_SUFFIX) != 0) {
+            continue;
+        }
+        
+        char* path = format_cache_path(key);
+        struct stat file_stat;
+        if (path && stat(path, &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
+            add_cache_file(key, (size_t)file_stat.st_size, file_stat.st_mtime);
+        }
+        free(path);
+    }
+    closedir(dir);
+    
+    int result = cache_directory ? 0 : -1;
+    if (cache_directory) {
+        evict_cache_files(0);
+        LOG_INFO_MSG("Prompt cache in %s: %d files, %zu bytes", cache_directory, cache_count, cache_bytes);
+    }
+    pthread_mutex_unlock(&cache_lock);
+    
+    return result;
+}
+
+void set_prompt_prefix(ModelEntry* model, unsigned long long prefix_hash) {
+    pthread_mutex_lock(&cache_lock);
+    if (model->prompt_cache_key != 0 && model->prompt_cache_key != PROMPT_CACHE_MANUAL) {
+        // The loaded prefix no longer matches the template
+        rkllm_release_prompt_cache(model->handle);
+        model->prompt_cache_key = 0;
+    }
+    model->prompt_prefix_hash = prefix_hash;
+    pthread_mutex_unlock(&cache_lock);
+}
+
+void mark_manual_prompt_cache(ModelEntry* model, int loaded) {
+    pthread_mutex_lock(&cache_lock);
+    model->prompt_cache_key = loaded ? PROMPT_CACHE_MANUAL : 0;
+    pthread_mutex_unlock(&cache_lock);
+}
+
+/**
+ * Saves the prefill of the model's system prompt and template prefix in a
+ * run of its own, so no client's prompt ends up in a file that every later
+ * run loads. The template's postfix is emptied for the run and the input
+ * is empty, so the cache holds exactly the text every run starts with and
+ * no empty user turn or opened assistant turn
+ * @return 0 if the file was written
+ */
+static int prime_prompt_cache(ModelEntry* model, const char* path) {
+    if (rkllm_set_chat_template(model->handle, model->system_prompt, model->prompt_prefix, "") != 0) {
+        return -1;
+    }
+    
+    RKLLMInput input;
+    memset(&input, 0, sizeof(input));
+    input.input_type = RKLLM_INPUT_PROMPT;
+    input.role = "user";
+    input.prompt_input = "";
+    
+    RKLLMPromptCacheParam cache_param;
+    memset(&cache_param, 0, sizeof(cache_param));
+    cache_param.save_prompt_cache = 1;
+    cache_param.prompt_cache_path = path;
+    
+    RKLLMInferParam infer_param;
+    memset(&infer_param, 0, sizeof(infer_param));
+    infer_param.mode = RKLLM_INFER_GET_LAST_HIDDEN_LAYER;
+    infer_param.keep_history = 0;
+    infer_param.prompt_cache_params = &cache_param;
+    
+    // Without a streaming context the callback ignores the hidden states
+    int result = rkllm_run(model->handle, &input, &infer_param, NULL);
+    
+    // Client runs need the full template back
+    if (rkllm_set_chat_template(model->handle, model->system_prompt,
+                                model->prompt_prefix, model->prompt_postfix) != 0) {
+        LOG_ERROR_MSG("Failed to restore the chat template of model '%s' after priming", model->id);
+        return -1;
+    }
+    if (result != 0) {
+        return -1;
+    }
+    struct stat file_stat;
+    return stat(path, &file_stat) == 0 && file_stat.st_size > 0 ? 0 : -1;
+}
+
+void prepare_prompt_cache(ModelEntry* model) {
+    pthread_mutex_lock(&cache_lock);
+    if (!cache_directory || model->prompt_cache_key == PROMPT_CACHE_MANUAL) {
+        pthread_mutex_unlock(&cache_lock);
+        return;
+    }
+    
+    // Only a prefix whose exact text is known can be primed: the model's
+    // built-in template and tool definitions are rendered by the runtime
+    if (!model->system_prompt || !model->prompt_prefix || !model->prompt_postfix) {
+        pthread_mutex_unlock(&cache_lock);
+        return;
+    }
+    
+    // The same prefix on another model file is a different cache
+    unsigned long long key = hash_prompt_text(0, model->model_path);
+    char prefix_text[32];
+    snprintf(prefix_text, sizeof(prefix_text), "%llx", model->prompt_prefix_hash);
+    key = hash_prompt_text(key, prefix_text);
+    
+    PromptCacheFile* file = find_cache_file(key);
+    if ((model->prompt_cache_key == key && file) || model->prompt_cache_failed == key) {
+        if (file) {
+            touch_cache_file(file);
+        }
+        pthread_mutex_unlock(&cache_lock);
+        return;
+    }
+    
+    char* path = format_cache_path(key);
+    if (!path) {
+        pthread_mutex_unlock(&cache_lock);
+        return;
+    }
+    
+    if (!file) {
+        // First use of this prefix: a priming run saves it. Runs are
+        // serialized on the NPU, so nothing else uses the handle meanwhile
+        pthread_mutex_unlock(&cache_lock);
+        int primed = prime_prompt_cache(model, path);
+        pthread_mutex_lock(&cache_lock);
+        
+        struct stat file_stat;
+        if (primed == 0 && stat(path, &file_stat) == 0) {
+            file = find_cache_file(key);
+            if (!file) {
+                file = add_cache_file(key, (size_t)file_stat.st_size, time(NULL));
+            }
+            if (file) {
+                LOG_INFO_MSG("Saved prompt cache %016llx for model '%s' (%zu bytes)", key, model->id, file->size);
+                evict_cache_files(key);
+                file = find_cache_file(key);
+            }
+        }
+        if (!file) {
+            // Not retried for this prefix; runs simply prefill it
+            LOG_WARN_MSG("Priming prompt cache %016llx for model '%s' failed", key, model->id);
+            unlink(path);
+            model->prompt_cache_failed = key;
+            pthread_mutex_unlock(&cache_lock);
+            free(path);
+            return;
+        }
+    }
+    
+    if (rkllm_load_prompt_cache(model->handle, path) == 0) {
+        model->prompt_cache_key = key;
+        touch_cache_file(file);
+        LOG_DEBUG_MSG("Loaded prompt cache %016llx into model '%s'", key, model->id);
+    } else {
+        LOG_WARN_MSG("Prompt cache %016llx failed to load, deleting it", key);
+        remove_cache_file((int)(file - cache_files));
+        model->prompt_cache_key = 0;
+    }
+    pthread_mutex_unlock(&cache_lock);
+    
+    free(path);
+}
+
+void destroy_prompt_cache(void) {
+    pthread_mutex_lock(&cache_lock);
+    free(cache_directory);
+    free(cache_files);
+    cache_directory = NULL;
+    cache_files = NULL;
+    cache_count = 0;
+    cache_capacity = 0;
+    cache_bytes = 0;
+    pthread_mutex_unlock(&cache_lock);
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef MANAGE_PROMPT_CACHE_H
+#define MANAGE_PROMPT_CACHE_H
+
+#include <stddef.h>
+#include "../manage_model_registry/manage_model_registry.h"
+
+// prompt_cache_key of a handle whose cache was loaded by rkllm.load_prompt_cache
+#define PROMPT_CACHE_MANUAL (~0ULL)
+
+/**
+ * Enables the automatic prompt cache: cache files live in directory,
+ * named by the hash of model file, system prompt and template prefix, and
+ * the least recently used are deleted once they exceed budget_bytes
+ * @param directory Cache directory, created if missing (NULL or "" disables the cache)
+ * @param budget_bytes Total size of cache files (0 = no limit)
+ * @return 0 on success, -1 if the directory cannot be used
+ */
+int init_prompt_cache(const char* directory, size_t budget_bytes);
+
+/**
+ * Extends a prompt prefix hash with one piece of text (FNV-1a)
+ * @param hash Hash so far (0 to start)
+ * @param text Text to add (NULL counts as empty)
+ * @return Non-zero hash
+ */
+unsigned long long hash_prompt_text(unsigned long long hash, const char* text);
+
+/**
+ * Records the system prompt and template prefix now set on a handle;
+ * an automatically loaded cache of the old prefix is released
+ * @param model Model whose template changed
+ * @param prefix_hash Hash built with hash_prompt_text
+ */
+void set_prompt_prefix(ModelEntry* model, unsigned long long prefix_hash);
+
+/**
+ * Records that the client loaded or released a prompt cache itself;
+ * automatic caching stays off for the handle while its cache is loaded
+ * @param model Model
+ * @param loaded Non-zero after rkllm.load_prompt_cache, zero after release
+ */
+void mark_manual_prompt_cache(ModelEntry* model, int loaded);
+
+/**
+ * Prepares a stateless run: loads the cached prefill of the model's system
+ * prompt and template prefix, first saving it in a priming run (empty
+ * input, empty postfix) if none was saved yet. Client runs never save the
+ * cache, since it would hold their prompt. Nothing is cached while the
+ * exact prefix text is unknown (built-in template, function tools). Only
+ * called on the NPU worker
+ * @param model Model about to run
+ */
+void prepare_prompt_cache(ModelEntry* model);
+
+/**
+ * Forgets the in-memory index; files stay on disk for the next start
+ */
+void destroy_prompt_cache(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "manage_sessions.h"
+#include "../../utils/log_message/log_message.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Only the NPU worker creates, runs and closes sessions, so the table
+// needs no lock
+static Session sessions[MAX_SESSIONS];
+static int next_session_id = 1;
+static unsigned long long session_clock = 0;
+
+static void free_turn(SessionTurn* turn) {
+    free(turn->role);
+    free(turn->prompt);
+    free(turn->reply);
+}
+
+static void clear_session(Session* session) {
+    for (int i = 0; i < session->turn_count; i++) {
+        free_turn(&session->turns[i]);
+    }
+    free(session->turns);
+    memset(session, 0, sizeof(Session));
+}
+
+int create_session(const char* model_id, int max_history_tokens) {
+    // A free slot or else the least recently used session
+    Session* slot = NULL;
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        if (sessions[i].id == 0) {
+            slot = &sessions[i];
+            break;
+        }
+        if (!slot || sessions[i].last_used < slot->last_used) {
+            slot = &sessions[i];
+        }
+    }
+    if (slot->id != 0) {
+        LOG_INFO_MSG("Closing least recently used session %d", slot->id);
+        clear_session(slot);
+    }
+    
+    slot->id = next_session_id++;
+    snprintf(slot->model, sizeof(slot->model), "%s", model_id);
+    slot->max_history_tokens = max_history_tokens > 0 ? max_history_tokens : 0;
+    slot->last_used = ++session_clock;
+    return slot->id;
+}
+
+Session* find_session(int session_id) {
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        if (session_id > 0 && sessions[i].id == session_id) {
+            sessions[i].last_used = ++session_clock;
+            return &sessions[i];
+        }
+    }
+    return NULL;
+}
+
+SessionTurn* append_session_turn(Session* session, const char* role, const char* prompt, char* reply) {
+    if (session->turn_count == session->turn_capacity) {
+        int capacity = session->turn_capacity ? session->turn_capacity * 2 : 8;
+        SessionTurn* turns = realloc(session->turns, (size_t)capacity * sizeof(SessionTurn));
+        if (!turns) {
+            return NULL;
+        }
+        session->turns = turns;
+        session->turn_capacity = capacity;
+    }
+    
+    SessionTurn* turn = &session->turns[session->turn_count];
+    memset(turn, 0, sizeof(SessionTurn));
+    turn->role = strdup(role ? role : "user");
+    turn->prompt = strdup(prompt ? prompt : "");
+    if (!turn->role || !turn->prompt) {
+        free(turn->role);
+        free(turn->prompt);
+        return NULL;
+    }
+    turn->reply = reply;
+    session->turn_count++;
+    return turn;
+}
+
+void drop_session_turns(Session* session, int count) {
+    if (count > session->turn_count) {
+        count = session->turn_count;
+    }
+    for (int i = 0; i < count; i++) {
+        free_turn(&session->turns[i]);
+    }
+    memmove(session->turns, session->turns + count,
+            (size_t)(session->turn_count - count) * sizeof(SessionTurn));
+    session->turn_count -= count;
+}
+
+json_object* describe_session(const Session* session) {
+    int history_tokens = 0;
+    for (int i = 0; i < session->turn_count; i++) {
+        history_tokens += session->turns[i].tokens;
+    }
+    
+    json_object* result = json_object_new_object();
+    json_object_object_add(result, "session_id", json_object_new_int(session->id));
+    json_object_object_add(result, "model", json_object_new_string(session->model));
+    json_object_object_add(result, "turns", json_object_new_int(session->turn_count));
+    json_object_object_add(result, "history_tokens", json_object_new_int(history_tokens));
+    json_object_object_add(result, "max_history_tokens", json_object_new_int(session->max_history_tokens));
+    return result;
+}
+
+int close_session(int session_id) {
+    Session* session = find_session(session_id);
+    if (!session) {
+        return -1;
+    }
+    clear_session(session);
+    return 0;
+}
+
+void destroy_sessions(void) {
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        if (sessions[i].id != 0) {
+            clear_session(&sessions[i]);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef MANAGE_SESSIONS_H
+#define MANAGE_SESSIONS_H
+
+#include <json-c/json.h>
+#include "../manage_model_registry/manage_model_registry.h"
+
+// Open sessions; creating one more closes the least recently used
+#define MAX_SESSIONS 64
+
+// One exchange of a session
+typedef struct {
+    char* role;                 // Role of the input
+    char* prompt;               // Input text
+    char* reply;                // Generated text
+    int tokens;                 // KV positions the exchange occupies
+    int kv_end;                 // KV position after the exchange; exchanges prefilled together share it
+} SessionTurn;
+
+// A conversation whose history the server keeps, in the KV cache when
+// possible and as text otherwise
+typedef struct {
+    int id;                     // Session id returned by session.create (0 = free slot)
+    char model[MODEL_ID_LENGTH];
+    SessionTurn* turns;         // History, oldest first
+    int turn_count;
+    int turn_capacity;
+    int kv_base;                // KV position where the history starts (after the system prompt)
+    int max_history_tokens;     // History kept before each turn (0 = up to the context window)
+    unsigned long long last_used;
+} Session;
+
+/**
+ * Opens a session on a model; sessions are only used from the NPU worker
+ * @param model_id Resolved model id
+ * @param max_history_tokens History kept before each turn (0 = no limit)
+ * @return Session id (> 0), or -1 on allocation failure
+ */
+int create_session(const char* model_id, int max_history_tokens);
+
+/**
+ * Looks up a session and marks it as used
+ * @param session_id Session id
+ * @return Session or NULL if unknown
+ */
+Session* find_session(int session_id);
+
+/**
+ * Appends an exchange to the history
+ * @param session Session
+ * @param role Role of the input
+ * @param prompt Input text
+ * @param reply Generated text (owned by the session on success)
+ * @return New turn, or NULL on allocation failure
+ */
+SessionTurn* append_session_turn(Session* session, const char* role, const char* prompt, char* reply);
+
+/**
+ * Forgets the oldest exchanges of the history
+ * @param session Session
+ * @param count Number of exchanges to drop
+ */
+void drop_session_turns(Session* session, int count);
+
+/**
+ * Describes a session
+ * @param session Session
+ * @return JSON object with session_id, model, turns and history_tokens
+ */
+json_object* describe_session(const Session* session);
+
+/**
+ * Closes a session
+ * @param session_id Session id
+ * @return 0 on success, -1 if the session is unknown
+ */
+int close_session(int session_id);
+
+/**
+ * Closes every session; used at shutdown
+ */
+void destroy_sessions(void);
+
+#endif
\ No newline at end of file
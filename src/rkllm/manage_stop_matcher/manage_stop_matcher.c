@@ -0,0 +1,196 @@
+#include "manage_stop_matcher.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int find_child(const StopMatcher* matcher, int node, unsigned char byte) {
+    for (int child = matcher->nodes[node].first_child; child >= 0; child = matcher->nodes[child].next_sibling) {
+        if (matcher->nodes[child].byte == byte) {
+            return child;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Follows the goto function, falling back along failure links
+ */
+static int next_state(const StopMatcher* matcher, int state, unsigned char byte) {
+    for (;;) {
+        int child = find_child(matcher, state, byte);
+        if (child >= 0) {
+            return child;
+        }
+        if (state == 0) {
+            return 0;
+        }
+        state = matcher->nodes[state].fail;
+    }
+}
+
+static int reserve_text(char** text, size_t* capacity, size_t needed) {
+    if (needed <= *capacity) {
+        return 0;
+    }
+    
+    size_t new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    char* new_text = realloc(*text, new_capacity);
+    if (!new_text) {
+        return -1;
+    }
+    *text = new_text;
+    *capacity = new_capacity;
+    return 0;
+}
+
+StopMatcher* create_stop_matcher(const char* const* patterns, int count) {
+    if (!patterns || count < 1 || count > MAX_STOP_SEQUENCES) {
+        return NULL;
+    }
+    
+    StopMatcher* matcher = calloc(1, sizeof(StopMatcher));
+    if (!matcher) {
+        return NULL;
+    }
+    
+    int max_nodes = 1;
+    for (int i = 0; i < count; i++) {
+        max_nodes += (int)strlen(patterns[i]);
+    }
+    matcher->nodes = malloc((size_t)max_nodes * sizeof(StopNode));
+    if (!matcher->nodes) {
+        free(matcher);
+        return NULL;
+    }
+    
+    matcher->node_count = 1;
+    matcher->nodes[0] = (StopNode){ -1, -1, 0, -1, 0, 0 };
+    
+    // Trie of all sequences; a sequence that repeats another keeps the
+    // lower index
+    for (int i = 0; i < count; i++) {
+        const unsigned char* p = (const unsigned char*)patterns[i];
+        int node = 0;
+        for (; *p; p++) {
+            int child = find_child(matcher, node, *p);
+            if (child < 0) {
+                child = matcher->node_count++;
+                matcher->nodes[child] = (StopNode){ -1, matcher->nodes[node].first_child, 0, -1,
+                                                    matcher->nodes[node].depth + 1, *p };
+                matcher->nodes[node].first_child = child;
+            }
+            node = child;
+        }
+        if (matcher->nodes[node].match < 0) {
+            matcher->nodes[node].match = i;
+        }
+        matcher->pattern_lengths[i] = matcher->nodes[node].depth;
+    }
+    
+    // Failure links breadth-first; nodes inherit the match of their
+    // failure node so a sequence inside a longer one is still found
+    int* queue = malloc((size_t)matcher->node_count * sizeof(int));
+    if (!queue) {
+        free_stop_matcher(matcher);
+        return NULL;
+    }
+    int head = 0;
+    int tail = 0;
+    for (int child = matcher->nodes[0].first_child; child >= 0; child = matcher->nodes[child].next_sibling) {
+        matcher->nodes[child].fail = 0;
+        queue[tail++] = child;
+    }
+    while (head < tail) {
+        int node = queue[head++];
+        for (int child = matcher->nodes[node].first_child; child >= 0; child = matcher->nodes[child].next_sibling) {
+            int fail = next_state(matcher, matcher->nodes[node].fail, matcher->nodes[child].byte);
+            matcher->nodes[child].fail = fail;
+            if (matcher->nodes[child].match < 0) {
+                matcher->nodes[child].match = matcher->nodes[fail].match;
+            }
+            queue[tail++] = child;
+        }
+    }
+    free(queue);
+    return matcher;
+}
+
+int feed_stop_matcher(StopMatcher* matcher, const char* text, const char** released) {
+    size_t text_len = text ? strlen(text) : 0;
+    size_t held_len = matcher->held_len;
+    if (reserve_text(&matcher->held, &matcher->held_capacity, held_len + text_len + 1) != 0 ||
+        reserve_text(&matcher->released, &matcher->released_capacity, held_len + text_len + 1) != 0) {
+        // Without room to hold text back, release it unmatched
+        *released = text;
+        return -1;
+    }
+    
+    int found = -1;
+    size_t end = 0;
+    for (size_t i = 0; i < text_len; i++) {
+        matcher->state = next_state(matcher, matcher->state, (unsigned char)text[i]);
+        if (matcher->nodes[matcher->state].match >= 0) {
+            found = matcher->nodes[matcher->state].match;
+            end = held_len + i + 1;
+            break;
+        }
+    }
+    if (text_len > 0) {
+        memcpy(matcher->held + held_len, text, text_len);
+    }
+    
+    // Everything before the stop sequence, or before the bytes that may
+    // still start one, is released; text after a stop sequence is dropped
+    size_t total = held_len + text_len;
+    size_t keep = 0;
+    size_t release_len = 0;
+    if (found >= 0) {
+        release_len = end - (size_t)matcher->pattern_lengths[found];
+        matcher->state = 0;
+    } else {
+        keep = (size_t)matcher->nodes[matcher->state].depth;
+        release_len = total - keep;
+    }
+    memcpy(matcher->released, matcher->held, release_len);
+    matcher->released[release_len] = '\0';
+    
+    memmove(matcher->held, matcher->held + total - keep, keep);
+    matcher->held_len = keep;
+    *released = matcher->released;
+    return found;
+}
+
+const char* finish_stop_matcher(StopMatcher* matcher, const char* text, int* stop_index) {
+    *stop_index = -1;
+    if (!matcher) {
+        return text;
+    }
+    
+    const char* released = NULL;
+    *stop_index = feed_stop_matcher(matcher, text, &released);
+    if (*stop_index >= 0 || matcher->held_len == 0 || released != matcher->released) {
+        return released;
+    }
+    
+    // The held tail never completed a stop sequence; feed_stop_matcher
+    // reserved room for all of it behind the released text
+    size_t released_len = strlen(matcher->released);
+    memcpy(matcher->released + released_len, matcher->held, matcher->held_len);
+    matcher->released[released_len + matcher->held_len] = '\0';
+    matcher->held_len = 0;
+    matcher->state = 0;
+    return matcher->released;
+}
+
+void free_stop_matcher(StopMatcher* matcher) {
+    if (!matcher) {
+        return;
+    }
+    
+    free(matcher->nodes);
+    free(matcher->held);
+    free(matcher->released);
+    free(matcher);
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef MANAGE_STOP_MATCHER_H
+#define MANAGE_STOP_MATCHER_H
+
+#include <stddef.h>
+
+// Limits of the "stop" parameter
+#define MAX_STOP_SEQUENCES 16
+#define MAX_STOP_LENGTH 256
+
+// One node of the Aho-Corasick automaton
+typedef struct {
+    int first_child;            // Child list of the trie (-1 = leaf)
+    int next_sibling;
+    int fail;                   // Longest proper suffix that is also a trie node
+    int match;                  // Stop sequence ending here or at a suffix (-1 = none)
+    int depth;                  // Bytes from the root
+    unsigned char byte;         // Byte on the edge from the parent
+} StopNode;
+
+// Finds stop sequences in streamed text. Text that could still turn
+// out to be the start of a stop sequence is held back until it either
+// completes the sequence (and is dropped) or diverges (and is released).
+typedef struct {
+    StopNode* nodes;
+    int node_count;
+    int state;                  // Current node
+    int pattern_lengths[MAX_STOP_SEQUENCES];
+    char* held;                 // Text not yet released, its length is the current depth
+    size_t held_len;
+    size_t held_capacity;
+    char* released;             // Text released by the last call, NUL-terminated
+    size_t released_capacity;
+} StopMatcher;
+
+/**
+ * Builds the automaton for a set of stop sequences
+ * @param patterns Stop sequences (non-empty, at most MAX_STOP_LENGTH bytes)
+ * @param count Number of sequences (1..MAX_STOP_SEQUENCES)
+ * @return New matcher or NULL on allocation failure
+ */
+StopMatcher* create_stop_matcher(const char* const* patterns, int count);
+
+/**
+ * Feeds the text of one token
+ * @param matcher Matcher
+ * @param text Token text (NULL feeds nothing)
+ * @param released Receives the text that is safe to send, without any stop
+ *                 sequence (owned by the matcher, valid until the next call)
+ * @return Index of the stop sequence that completed, or -1
+ */
+int feed_stop_matcher(StopMatcher* matcher, const char* text, const char** released);
+
+/**
+ * Feeds the text that arrives with the final state and releases the text
+ * still held back, since it can no longer complete a stop sequence
+ * @param matcher Matcher (NULL returns text unchanged)
+ * @param text Final text (may be NULL)
+ * @param stop_index Receives the index of a stop sequence the text completed, or -1
+ * @return Text to send (owned by the matcher unless it is text; may be NULL)
+ */
+const char* finish_stop_matcher(StopMatcher* matcher, const char* text, int* stop_index);
+
+/**
+ * Frees a matcher
+ * @param matcher Matcher (may be NULL)
+ */
+void free_stop_matcher(StopMatcher* matcher);
+
+#endif
\ No newline at end of file
@@ -1,22 +1,293 @@
 #include "manage_streaming_context.h"
+#include "../../connection/retain_connection/retain_connection.h"
+#include "../../connection/release_connection/release_connection.h"
+#include "../../jsonrpc/extract_int_param/extract_int_param.h"
+#include "../../server/manage_npu_worker/manage_npu_worker.h"
+#include "../../connection/manage_output_queue/manage_output_queue.h"
+#include "../../utils/log_message/log_message.h"
+#include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
 
-// Global streaming context - only ONE inference at a time
-static StreamingContext global_streaming_context = {0, 0, 0};
+// Streams with a stream_flush_ms deadline, walked by the I/O worker that
+// watches deadline_fd
+static StreamingContext* deadline_streams = NULL;
+static pthread_mutex_t deadline_lock = PTHREAD_MUTEX_INITIALIZER;
+static int deadline_fd = -1;
 
-void set_streaming_context(int client_fd, int request_id) {
-    global_streaming_context.client_fd = client_fd;
-    global_streaming_context.request_id = request_id;
-    global_streaming_context.is_active = 1;
+static long long get_monotonic_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
 }
 
-void clear_streaming_context(void) {
-    memset(&global_streaming_context, 0, sizeof(StreamingContext));
+void extract_stream_options(json_object* params, StreamOptions* options) {
+    if (!options) {
+        return;
+    }
+    
+    options->flush_tokens = extract_int_param(params, "stream_flush_tokens", 0);
+    options->flush_ms = extract_int_param(params, "stream_flush_ms", 0);
+    if (options->flush_tokens < 0) {
+        options->flush_tokens = 0;
+    }
+    if (options->flush_ms < 0) {
+        options->flush_ms = 0;
+    }
+    
+    // No coalescing requested: one frame per token
+    if (options->flush_tokens == 0 && options->flush_ms == 0) {
+        options->flush_tokens = 1;
+    }
+    
+    json_object* dtype = NULL;
+    options->tensor_dtype = TENSOR_FLOAT32;
+    if (params && json_object_object_get_ex(params, "tensor_dtype", &dtype) &&
+        json_object_is_type(dtype, json_type_string) &&
+        strcmp(json_object_get_string(dtype), "float16") == 0) {
+        options->tensor_dtype = TENSOR_FLOAT16;
+    }
 }
 
-StreamingContext* get_streaming_context(void) {
-    if (global_streaming_context.is_active) {
-        return &global_streaming_context;
+StreamingContext* create_streaming_context(Connection* conn, json_object* request_id,
+                                           const StreamOptions* options, int detached) {
+    StreamingContext* context = calloc(1, sizeof(StreamingContext));
+    if (!context) {
+        return NULL;
+    }
+    
+    // Serialize the id once; every token frame reuses it
+    if (init_stream_writer(&context->writer, request_id) != 0) {
+        free(context);
+        return NULL;
+    }
+    snprintf(context->request_id, sizeof(context->request_id), "%s",
+             request_id ? json_object_to_json_string_ext(request_id, JSON_C_TO_STRING_PLAIN) : "null");
+    
+    if (options) {
+        context->options = *options;
+    } else {
+        context->options.flush_tokens = 1;
+        context->options.flush_ms = 0;
+        context->options.tensor_dtype = TENSOR_FLOAT32;
+    }
+    
+    // Keep the connection alive while tokens are in flight even if the
+    // client disconnects mid-stream
+    retain_connection(conn);
+    context->conn = conn;
+    context->detached = detached;
+    context->is_active = 1;
+    pthread_mutex_init(&context->lock, NULL);
+    
+    // A deadline must hold even while no token arrives to check it
+    if (context->options.flush_ms > 0) {
+        pthread_mutex_lock(&deadline_lock);
+        context->next_deadline = deadline_streams;
+        deadline_streams = context;
+        pthread_mutex_unlock(&deadline_lock);
+    }
+    
+    // Runs start on the NPU worker right after their job was dequeued
+    begin_run_timings(&context->timings, get_npu_job_wait_ms());
+    
+    // A detached stream occupies the NPU until it is freed; the scheduler
+    // holds the next job until then
+    if (detached) {
+        begin_npu_background_work();
+    }
+    return context;
+}
+
+static json_object* stop_error(const char* message) {
+    json_object* error_result = json_object_new_object();
+    json_object_object_add(error_result, "code", json_object_new_int(-32602));
+    json_object_object_add(error_result, "message", json_object_new_string(message));
+    return error_result;
+}
+
+json_object* set_stop_conditions(StreamingContext* context, json_object* params) {
+    context->max_tokens = extract_int_param(params, "max_tokens", 0);
+    if (context->max_tokens < 0) {
+        return stop_error("max_tokens must not be negative");
+    }
+    
+    json_object* stop = NULL;
+    if (!params || !json_object_object_get_ex(params, "stop", &stop) || !stop) {
+        return NULL;
+    }
+    
+    const char* patterns[MAX_STOP_SEQUENCES];
+    int count = 0;
+    if (json_object_is_type(stop, json_type_string)) {
+        patterns[count++] = json_object_get_string(stop);
+    } else if (json_object_is_type(stop, json_type_array)) {
+        int length = (int)json_object_array_length(stop);
+        if (length > MAX_STOP_SEQUENCES) {
+            char message[64];
+            snprintf(message, sizeof(message), "stop accepts at most %d sequences", MAX_STOP_SEQUENCES);
+            return stop_error(message);
+        }
+        for (int i = 0; i < length; i++) {
+            json_object* item = json_object_array_get_idx(stop, (size_t)i);
+            if (!json_object_is_type(item, json_type_string)) {
+                return stop_error("stop must be a string or an array of strings");
+            }
+            patterns[count++] = json_object_get_string(item);
+        }
+    } else {
+        return stop_error("stop must be a string or an array of strings");
+    }
+    
+    for (int i = 0; i < count; i++) {
+        size_t length = strlen(patterns[i]);
+        if (length == 0 || length > MAX_STOP_LENGTH) {
+            char message[64];
+            snprintf(message, sizeof(message), "stop sequences must be 1 to %d bytes long", MAX_STOP_LENGTH);
+            return stop_error(message);
+        }
+    }
+    if (count == 0) {
+        return NULL;
+    }
+    
+    context->stop = create_stop_matcher(patterns, count);
+    if (!context->stop) {
+        json_object* error_result = stop_error("Memory allocation failed");
+        json_object_object_add(error_result, "code", json_object_new_int(-32000));
+        return error_result;
     }
     return NULL;
+}
+
+void append_stream_reply(StreamingContext* context, const char* text) {
+    if (!context || !context->reply || !text) {
+        return;
+    }
+    
+    size_t text_len = strlen(text);
+    if (context->reply_len + text_len + 1 > context->reply_capacity) {
+        size_t capacity = context->reply_capacity ? context->reply_capacity : 256;
+        while (capacity < context->reply_len + text_len + 1) {
+            capacity *= 2;
+        }
+        char* reply = realloc(context->reply, capacity);
+        if (!reply) {
+            free(context->reply);
+            context->reply = NULL;
+            return;
+        }
+        context->reply = reply;
+        context->reply_capacity = capacity;
+    }
+    memcpy(context->reply + context->reply_len, text, text_len + 1);
+    context->reply_len += text_len;
+}
+
+int flush_stream_tokens(StreamingContext* context) {
+    if (context->writer.pending_count == 0) {
+        return 0;
+    }
+    
+    size_t frame_len = 0;
+    const char* frame = format_pending_frame(&context->writer, RKLLM_RUN_NORMAL, &frame_len);
+    if (!frame) {
+        LOG_ERROR_MSG("Failed to encode token frame for request %s", context->request_id);
+        return 0;
+    }
+    
+    struct iovec iov;
+    iov.iov_base = (void*)frame;
+    iov.iov_len = frame_len;
+    return queue_output(context->conn, &iov, 1);
+}
+
+int open_stream_deadline_fd(void) {
+    deadline_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return deadline_fd;
+}
+
+void wake_stream_deadlines(void) {
+    if (deadline_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(deadline_fd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void clear_stream_deadline_wakeup(void) {
+    uint64_t count;
+    ssize_t got = read(deadline_fd, &count, sizeof(count));
+    (void)got;
+}
+
+int flush_expired_streams(void) {
+    long long now_ms = get_monotonic_ms();
+    long long next_ms = -1;
+    
+    pthread_mutex_lock(&deadline_lock);
+    for (StreamingContext* context = deadline_streams; context; context = context->next_deadline) {
+        // A busy stream is inside its callback; look again right after
+        if (pthread_mutex_trylock(&context->lock) != 0) {
+            next_ms = 1;
+            continue;
+        }
+        if (context->is_active && context->writer.pending_count > 0 && !context->partial_char) {
+            long long due_ms = context->batch_start_ms + context->options.flush_ms;
+            if (due_ms <= now_ms) {
+                flush_stream_tokens(context);
+            } else if (next_ms < 0 || due_ms - now_ms < next_ms) {
+                next_ms = due_ms - now_ms;
+            }
+        }
+        pthread_mutex_unlock(&context->lock);
+    }
+    pthread_mutex_unlock(&deadline_lock);
+    
+    return (int)next_ms;
+}
+
+void close_stream_deadline_fd(void) {
+    if (deadline_fd >= 0) {
+        close(deadline_fd);
+        deadline_fd = -1;
+    }
+}
+
+void free_streaming_context(StreamingContext* context) {
+    if (!context) {
+        return;
+    }
+    
+    // Waits for a deadline flush of this stream to finish
+    if (context->options.flush_ms > 0) {
+        pthread_mutex_lock(&deadline_lock);
+        StreamingContext** link = &deadline_streams;
+        while (*link && *link != context) {
+            link = &(*link)->next_deadline;
+        }
+        if (*link) {
+            *link = context->next_deadline;
+        }
+        pthread_mutex_unlock(&deadline_lock);
+    }
+    pthread_mutex_destroy(&context->lock);
+    
+    free_stream_writer(&context->writer);
+    free(context->reply);
+    free_run_timings(&context->timings);
+    free_stop_matcher(context->stop);
+    if (context->conn) {
+        release_connection(context->conn);
+    }
+    release_model(context->model);
+    if (context->detached) {
+        end_npu_background_work();
+    }
+    free(context);
 }
\ No newline at end of file
@@ -2,30 +2,128 @@
 #define MANAGE_STREAMING_CONTEXT_H
 
 #include <json-c/json.h>
+#include <pthread.h>
+#include "../../connection/create_connection/create_connection.h"
+#include "../../jsonrpc/manage_stream_writer/manage_stream_writer.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../manage_perf_stats/manage_perf_stats.h"
+#include "../manage_stop_matcher/manage_stop_matcher.h"
 
-// Streaming context for active inference
+// Token coalescing options of a stream
 typedef struct {
-    int client_fd;
-    int request_id;
-    int is_active;
+    int flush_tokens;       // Emit a frame once this many tokens are buffered (0 = no count limit)
+    int flush_ms;           // Emit a frame once the oldest buffered token is this old (0 = no deadline)
+    TensorDtype tensor_dtype; // Element type of binary hidden state and logits frames
+} StreamOptions;
+
+// Consumes the results of a run on the server instead of streaming them
+// (rkllm.embed)
+typedef void (*ResultSink)(void* sink_data, const RKLLMResult* result);
+
+// Streaming context of one inference, passed to the callback as userdata
+typedef struct StreamingContext {
+    Connection* conn;       // Client receiving the token stream (retained)
+    ModelEntry* model;      // Model generating the stream, held until the context is freed
+    char request_id[64];    // Serialized JSON-RPC id, for log messages
+    int is_active;          // Cleared once the stream reached its final frame
+    int detached;           // Freed by the callback when the stream ends (rkllm_run_async)
+    StreamWriter writer;    // Token frame encoder for this stream
+    StreamOptions options;  // Token coalescing options
+    long long batch_start_ms; // Monotonic time the oldest buffered token arrived
+    int partial_char;       // The batch ends in part of a multibyte character (RKLLM_RUN_WAITING)
+    pthread_mutex_t lock;   // Guards the writer between the callback and the deadline flush
+    struct StreamingContext* next_deadline; // Next stream in the stream_flush_ms deadline list
+    char* reply;            // Generated text, collected for session transcripts (NULL = not collected)
+    size_t reply_len;
+    size_t reply_capacity;
+    RunTimings timings;     // Queue wait and token arrival times, reported in the final frame
+    ResultSink sink;        // Receives results instead of the client (NULL = stream them)
+    void* sink_data;
+    StopMatcher* stop;      // Stop sequences that end the run (NULL = none)
+    int max_tokens;         // Tokens after which the run ends (0 = up to max_new_tokens)
+    int token_count;        // Tokens generated so far
+    int aborted;            // Ended by a stop condition through rkllm_abort (the run may report failure)
 } StreamingContext;
 
 /**
- * Sets the global streaming context for the current inference
- * @param client_fd File descriptor of the client
- * @param request_id JSON-RPC request ID
+ * Reads stream_flush_tokens, stream_flush_ms and tensor_dtype from
+ * rkllm.run params. Without either flush option every token is sent as
+ * its own frame; tensors are sent as float32 unless tensor_dtype is
+ * "float16".
+ * @param params Request params (may be NULL)
+ * @param options Receives the options
+ */
+void extract_stream_options(json_object* params, StreamOptions* options);
+
+/**
+ * Creates the streaming context of one inference
+ * @param conn Connection of the client; retained until the context is freed
+ * @param request_id JSON-RPC request id of any type (NULL is sent as null)
+ * @param options Token coalescing options (NULL sends every token at once)
+ * @param detached Non-zero if the callback frees the context when the stream
+ *                 ends; otherwise the caller frees it after rkllm_run returns
+ * @return New context or NULL on allocation failure
+ */
+StreamingContext* create_streaming_context(Connection* conn, json_object* request_id,
+                                           const StreamOptions* options, int detached);
+
+/**
+ * Reads "stop" (a string or an array of strings) and "max_tokens" from
+ * rkllm.run params; the callback ends the run as soon as either is reached
+ * @param context Context of the run
+ * @param params Request params (may be NULL)
+ * @return NULL on success, or an error object for invalid values
+ */
+json_object* set_stop_conditions(StreamingContext* context, json_object* params);
+
+/**
+ * Appends generated text to the collected reply; a reply that cannot
+ * grow is dropped, so the caller sees an incomplete run
+ * @param context Context collecting its reply
+ * @param text Token text (may be NULL)
+ */
+void append_stream_reply(StreamingContext* context, const char* text);
+
+/**
+ * Sends buffered tokens as one frame, if any; the caller holds context->lock
+ * @param context Context of the stream
+ * @return Bytes accepted, or -1 if the client is gone
+ */
+int flush_stream_tokens(StreamingContext* context);
+
+/**
+ * Creates the event fd that wakes the I/O worker enforcing stream_flush_ms
+ * deadlines when a stream starts buffering tokens
+ * @return The fd, to be watched by that worker, or -1 on error
+ */
+int open_stream_deadline_fd(void);
+
+/**
+ * Wakes the I/O worker after a stream with a deadline started a batch
+ */
+void wake_stream_deadlines(void);
+
+/**
+ * Consumes a wakeup of the deadline event fd
+ */
+void clear_stream_deadline_wakeup(void);
+
+/**
+ * Sends the buffered tokens of every stream whose stream_flush_ms deadline
+ * has passed, so a batch goes out on time even when the next token is slow
+ * @return Milliseconds until the next deadline, or -1 if no batch is waiting
  */
-void set_streaming_context(int client_fd, int request_id);
+int flush_expired_streams(void);
 
 /**
- * Clears the global streaming context
+ * Closes the deadline event fd
  */
-void clear_streaming_context(void);
+void close_stream_deadline_fd(void);
 
 /**
- * Gets the current streaming context
- * @return Pointer to current context or NULL if none active
+ * Frees a streaming context and releases its connection and model
+ * @param context Context to free (may be NULL)
  */
-StreamingContext* get_streaming_context(void);
+void free_streaming_context(StreamingContext* context);
 
 #endif
\ No newline at end of file
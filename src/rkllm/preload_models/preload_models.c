@@ -0,0 +1,166 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "preload_models.h"
+#include "../call_rkllm_init/call_rkllm_init.h"
+#include "../manage_model_loads/manage_model_loads.h"
+#include "../manage_model_registry/manage_model_registry.h"
+#include "../../jsonrpc/extract_int_param/extract_int_param.h"
+#include "../../utils/log_message/log_message.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <rkllm.h>
+
+// Longest a warmup generation may run before it is aborted
+#define DEFAULT_WARMUP_MS 2000
+
+// One warmup generation, run on its own thread so it can be cut short
+typedef struct {
+    LLMHandle handle;
+    RKLLMInput input;
+    RKLLMInferParam infer_param;
+    int result;
+    int finished;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} WarmupRun;
+
+static long long get_monotonic_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static void* warmup_thread(void* arg) {
+    WarmupRun* run = (WarmupRun*)arg;
+    
+    // No streaming context: the callback discards the tokens
+    int result = rkllm_run(run->handle, &run->input, &run->infer_param, NULL);
+    
+    pthread_mutex_lock(&run->mutex);
+    run->result = result;
+    run->finished = 1;
+    pthread_cond_signal(&run->cond);
+    pthread_mutex_unlock(&run->mutex);
+    return NULL;
+}
+
+/**
+ * Generates from the warmup prompt for at most warmup_ms, which compiles
+ * and caches the NPU kernels for both prefill and decode
+ */
+static void warm_up_model(const char* model_id, const char* prompt, int warmup_ms) {
+    ModelEntry* model = acquire_model(model_id);
+    if (!model) {
+        return;
+    }
+    
+    WarmupRun run;
+    memset(&run, 0, sizeof(run));
+    run.handle = model->handle;
+    run.input.role = "user";
+    run.input.input_type = RKLLM_INPUT_PROMPT;
+    run.input.prompt_input = prompt;
+    run.infer_param.mode = RKLLM_INFER_GENERATE;
+    run.infer_param.keep_history = 0;
+    
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&run.cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    pthread_mutex_init(&run.mutex, NULL);
+    
+    long long start_ms = get_monotonic_ms();
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, warmup_thread, &run) != 0) {
+        LOG_WARN_MSG("Failed to start warmup of model '%s'", model_id);
+    } else {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += warmup_ms / 1000;
+        deadline.tv_nsec += (long)(warmup_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        
+        pthread_mutex_lock(&run.mutex);
+        int wait_result = 0;
+        while (!run.finished && wait_result != ETIMEDOUT) {
+            wait_result = pthread_cond_timedwait(&run.cond, &run.mutex, &deadline);
+        }
+        int finished = run.finished;
+        pthread_mutex_unlock(&run.mutex);
+        
+        // A few tokens are enough; stop the rest of the answer
+        if (!finished) {
+            rkllm_abort(run.handle);
+        }
+        pthread_join(thread, NULL);
+        
+        LOG_INFO_MSG("Warmed up model '%s' in %lld ms%s", model_id, get_monotonic_ms() - start_ms,
+                     run.result != 0 ? " (warmup run failed)" : "");
+    }
+    
+    pthread_mutex_destroy(&run.mutex);
+    pthread_cond_destroy(&run.cond);
+    release_model(model);
+}
+
+int preload_models(json_object* models) {
+    if (!models) {
+        return 0;
+    }
+    
+    int count = (int)json_object_array_length(models);
+    for (int i = 0; i < count; i++) {
+        json_object* params = json_object_array_get_idx(models, i);
+        
+        // Same validation and loading as a client's rkllm.init
+        json_object* result = call_rkllm_init(params, NULL, NULL);
+        json_object* load_id_obj = NULL;
+        json_object* model_obj = NULL;
+        if (!result || !json_object_object_get_ex(result, "load_id", &load_id_obj) ||
+            !json_object_object_get_ex(result, "model", &model_obj)) {
+            json_object* message_obj = NULL;
+            LOG_ERROR_MSG("Preload entry %d rejected: %s", i,
+                          result && json_object_object_get_ex(result, "message", &message_obj) ?
+                          json_object_get_string(message_obj) : "unknown error");
+            if (result) {
+                json_object_put(result);
+            }
+            return -1;
+        }
+        
+        int load_id = json_object_get_int(load_id_obj);
+        char model_id[MODEL_ID_LENGTH];
+        snprintf(model_id, sizeof(model_id), "%s", json_object_get_string(model_obj));
+        json_object_put(result);
+        
+        LOG_INFO_MSG("Preloading model '%s' (load %d)", model_id, load_id);
+        if (wait_for_model_load(load_id) != MODEL_LOAD_READY) {
+            json_object* status = get_model_load_status(load_id);
+            json_object* message_obj = NULL;
+            LOG_ERROR_MSG("Failed to preload model '%s': %s", model_id,
+                          status && json_object_object_get_ex(status, "message", &message_obj) ?
+                          json_object_get_string(message_obj) : "unknown error");
+            if (status) {
+                json_object_put(status);
+            }
+            return -1;
+        }
+        
+        json_object* prompt_obj = NULL;
+        if (json_object_object_get_ex(params, "warmup_prompt", &prompt_obj) &&
+            json_object_is_type(prompt_obj, json_type_string)) {
+            int warmup_ms = extract_int_param(params, "warmup_ms", DEFAULT_WARMUP_MS);
+            warm_up_model(model_id, json_object_get_string(prompt_obj),
+                          warmup_ms > 0 ? warmup_ms : DEFAULT_WARMUP_MS);
+        }
+    }
+    
+    return 0;
+}
\ No newline at end of file
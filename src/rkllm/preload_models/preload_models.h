@@ -0,0 +1,16 @@
+#ifndef PRELOAD_MODELS_H
+#define PRELOAD_MODELS_H
+
+#include <json-c/json.h>
+
+/**
+ * Loads the configured models through the rkllm.init path and runs a short
+ * warmup generation on each, so the first client request finds them
+ * resident and the NPU warm
+ * @param models JSON array of rkllm.init params, each optionally with
+ *        warmup_prompt and warmup_ms (may be NULL)
+ * @return 0 when every model is ready, -1 if any failed to load
+ */
+int preload_models(json_object* models);
+
+#endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "call_rknn_init.h"
 #include "../../jsonrpc/extract_string_param/extract_string_param.h"
 #include "../../jsonrpc/extract_int_param/extract_int_param.h"
+#include "../../utils/map_model_file/map_model_file.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,9 +39,10 @@ json_object* call_rknn_init(json_object* params) {
     // Core mask is optional, default to 0 (auto)
     uint32_t core_mask = (uint32_t)extract_int_param(params, "core_mask", 0);
     
-    // Read model file
-    FILE* file = fopen(model_path, "rb");
-    if (!file) {
+    // Map the model file instead of copying it into a heap buffer;
+    // rknn_init keeps its own copy, so the mapping is dropped right after
+    MappedModelFile model_file;
+    if (map_model_file(model_path, &model_file) != 0) {
         free(model_path);
         json_object* error_result = json_object_new_object();
         json_object_object_add(error_result, "code", json_object_new_int(-32000));
@@ -48,44 +50,9 @@ json_object* call_rknn_init(json_object* params) {
         return error_result;
     }
     
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    
-    if (file_size <= 0) {
-        fclose(file);
-        free(model_path);
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Invalid model file size"));
-        return error_result;
-    }
-    
-    void* model_data = malloc(file_size);
-    if (!model_data) {
-        fclose(file);
-        free(model_path);
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Memory allocation failed"));
-        return error_result;
-    }
-    
-    size_t read_size = fread(model_data, 1, file_size, file);
-    fclose(file);
-    
-    if (read_size != (size_t)file_size) {
-        free(model_data);
-        free(model_path);
-        json_object* error_result = json_object_new_object();
-        json_object_object_add(error_result, "code", json_object_new_int(-32000));
-        json_object_object_add(error_result, "message", json_object_new_string("Failed to read model file"));
-        return error_result;
-    }
-    
     // Initialize RKNN context
-    int ret = rknn_init(&global_rknn_context, model_data, file_size, 0, NULL);
-    free(model_data);
+    int ret = rknn_init(&global_rknn_context, model_file.data, (uint32_t)model_file.size, 0, NULL);
+    unmap_model_file(&model_file);
     
     if (ret != RKNN_SUCC) {
         global_rknn_context = 0;
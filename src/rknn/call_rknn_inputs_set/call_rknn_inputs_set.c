@@ -4,6 +4,7 @@
 #include "../../jsonrpc/extract_string_param/extract_string_param.h"
 #include "../../jsonrpc/extract_bool_param/extract_bool_param.h"
 #include "../../utils/base64_decode.h"
+#include "../../image_processing/letterbox_image/letterbox_image.h"
 #include <rknn_api.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -100,11 +101,43 @@ json_object* call_rknn_inputs_set(json_object* params) {
             return error_result;
         }
         
+        // Camera frames become RGB for the model unless it takes the frame
+        // layout itself (pass_through)
+        bool pass_through = extract_bool_param(input_obj, "pass_through", false);
+        size_t converted_size = 0;
+        char* color_format = extract_string_param(input_obj, "color_format", NULL);
+        if (color_format && !pass_through) {
+            YuvFormat format = parse_yuv_format(color_format);
+            int width = extract_int_param(input_obj, "width", 0);
+            int height = extract_int_param(input_obj, "height", 0);
+            size_t frame_size = yuv_frame_size(format, width, height);
+            unsigned char* rgb = NULL;
+            if (frame_size > 0 && decoded_len >= frame_size) {
+                converted_size = (size_t)width * height * 3;
+                rgb = malloc(converted_size);
+            }
+            if (!rgb || convert_yuv_image(decoded_data, format, width, height, rgb) != 0) {
+                free(rgb);
+                free(color_format);
+                free(decoded_data);
+                free(inputs);
+                json_object* error_result = json_object_new_object();
+                json_object_object_add(error_result, "code", json_object_new_int(-32602));
+                json_object_object_add(error_result, "message", json_object_new_string("Invalid color_format, width, height or frame size"));
+                return error_result;
+            }
+            free(decoded_data);
+            decoded_data = rgb;
+        }
+        free(color_format);
+        
         inputs[i].buf = (void*)decoded_data;
         
         // Use decoded length or provided size parameter
         int provided_size = extract_int_param(input_obj, "size", 0);
-        if (provided_size > 0) {
+        if (converted_size > 0) {
+            inputs[i].size = converted_size;
+        } else if (provided_size > 0) {
             inputs[i].size = provided_size;
         } else {
             inputs[i].size = decoded_len;
@@ -119,9 +152,9 @@ json_object* call_rknn_inputs_set(json_object* params) {
             return error_result;
         }
         
-        inputs[i].pass_through = extract_bool_param(input_obj, "pass_through", false) ? 1 : 0;
-        inputs[i].type = extract_int_param(input_obj, "type", RKNN_TENSOR_UINT8);
-        inputs[i].fmt = extract_int_param(input_obj, "fmt", RKNN_TENSOR_NHWC);
+        inputs[i].pass_through = pass_through ? 1 : 0;
+        inputs[i].type = converted_size > 0 ? RKNN_TENSOR_UINT8 : extract_int_param(input_obj, "type", RKNN_TENSOR_UINT8);
+        inputs[i].fmt = converted_size > 0 ? RKNN_TENSOR_NHWC : extract_int_param(input_obj, "fmt", RKNN_TENSOR_NHWC);
     }
     
     // Call RKNN function
@@ -0,0 +1,70 @@
+#include "handle_client_event.h"
+#include "../manage_npu_worker/manage_npu_worker.h"
+#include "../../connection/remove_connection/remove_connection.h"
+#include "../../connection/frame_requests/frame_requests.h"
+#include "../../jsonrpc/parse_request/parse_request.h"
+#include "../../jsonrpc/handle_request/handle_request.h"
+#include "../../jsonrpc/free_request/free_request.h"
+#include "../../utils/log_message/log_message.h"
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+static void close_client(ConnectionManager* manager, Connection* conn) {
+    int client_fd = conn->fd;
+    epoll_ctl(conn->epoll_fd, EPOLL_CTL_DEL, client_fd, NULL);
+    // Wake up any pending writer and make the peer see EOF right away;
+    // the fd itself is closed when the last reference is released
+    shutdown(client_fd, SHUT_RDWR);
+    remove_connection(manager, client_fd);
+}
+
+/**
+ * Dispatches one framed message; called in stream order so pipelined
+ * requests are queued in the order the client sent them
+ */
+static void dispatch_message(Connection* conn, json_object* message, void* userdata) {
+    (void)userdata;
+    
+    if (!message) {
+        send_error_response(conn, NULL, -32700, "Parse error");
+        return;
+    }
+    
+    JSONRPCRequest* req = parse_request_object(message);
+    if (!req || !req->is_valid) {
+        LOG_WARN_MSG("Invalid JSON-RPC request");
+        send_error_response(conn, req ? req->id : NULL, -32600, "Invalid Request");
+        free_request(req);
+        return;
+    }
+    
+    LOG_INFO_MSG("Valid JSON-RPC request: method=%s", req->method);
+    
+    if (is_npu_bound_method(req->method)) {
+        // Long-running model work goes to the NPU worker so this
+        // loop keeps serving its other clients
+        if (submit_npu_job(req, conn) == 0) {
+            return;
+        }
+        LOG_ERROR_MSG("Failed to queue NPU job for fd=%d", conn->fd);
+        send_error_response(conn, req->id, -32000, "Server busy");
+    } else {
+        handle_request(req, conn);
+    }
+    
+    free_request(req);
+}
+
+int handle_client_event(ConnectionManager* manager, Connection* conn, int buffer_size, int max_request_size) {
+    if (!manager || !conn || buffer_size <= 0 || max_request_size <= 0) {
+        return -1;
+    }
+    
+    if (frame_requests(conn, (size_t)buffer_size, (size_t)max_request_size, dispatch_message, NULL) == 0) {
+        return 0;
+    }
+    
+    close_client(manager, conn);
+    return -1;
+}
\ No newline at end of file
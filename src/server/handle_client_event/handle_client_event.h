@@ -0,0 +1,18 @@
+#ifndef HANDLE_CLIENT_EVENT_H
+#define HANDLE_CLIENT_EVENT_H
+
+#include "../../connection/add_connection/add_connection.h"
+
+/**
+ * Handles a readiness event for a client on its owning I/O worker:
+ * frames every complete request in the stream, answers lightweight
+ * methods inline and hands NPU-bound methods to the NPU worker
+ * @param manager Connection manager owning the connection
+ * @param conn Connection that became readable
+ * @param buffer_size Minimum free space offered to each read
+ * @param max_request_size Largest accepted request message in bytes
+ * @return 0 if the connection stays open, -1 if it was closed
+ */
+int handle_client_event(ConnectionManager* manager, Connection* conn, int buffer_size, int max_request_size);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "manage_io_workers.h"
+#include "../setup_epoll/setup_epoll.h"
+#include "../handle_client_event/handle_client_event.h"
+#include "../../connection/find_connection/find_connection.h"
+#include "../../connection/manage_output_queue/manage_output_queue.h"
+#include "../../rkllm/manage_streaming_context/manage_streaming_context.h"
+#include "../../utils/log_message/log_message.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+// Event key of the stream deadline fd; fd -1 never matches a connection
+#define STREAM_DEADLINE_EVENT_KEY UINT64_MAX
+
+/**
+ * Adds the stream deadline event fd to an epoll instance
+ */
+static int watch_stream_deadlines(int epoll_fd) {
+    int fd = open_stream_deadline_fd();
+    if (fd < 0) {
+        return -1;
+    }
+    
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u64 = STREAM_DEADLINE_EVENT_KEY;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        close_stream_deadline_fd();
+        return -1;
+    }
+    return 0;
+}
+
+static void* io_worker_loop(void* arg) {
+    IOWorker* worker = (IOWorker*)arg;
+    IOWorkerPool* pool = worker->pool;
+    
+    struct epoll_event* events = malloc(pool->max_events * sizeof(struct epoll_event));
+    if (!events) {
+        LOG_ERROR_MSG("I/O worker %d: failed to allocate epoll events array", worker->index);
+        return NULL;
+    }
+    
+    while (pool->running) {
+        // The first worker sends token batches whose stream_flush_ms
+        // deadline passed and sleeps no longer than the next one
+        int timeout_ms = pool->timeout_ms;
+        if (worker->index == 0) {
+            int next_ms = flush_expired_streams();
+            if (next_ms >= 0 && (timeout_ms < 0 || next_ms < timeout_ms)) {
+                timeout_ms = next_ms;
+            }
+        }
+        
+        int event_count = epoll_wait(worker->epoll_fd, events, pool->max_events, timeout_ms);
+        if (event_count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR_MSG("I/O worker %d: epoll_wait failed: %s", worker->index, strerror(errno));
+            break;
+        }
+        
+        for (int i = 0; i < event_count; i++) {
+            // A stream started a batch; the deadlines are checked above
+            if (events[i].data.u64 == STREAM_DEADLINE_EVENT_KEY) {
+                clear_stream_deadline_wakeup();
+                continue;
+            }
+            
+            // O(1): the event key indexes the fd table and the generation
+            // rejects events left over from a previous owner of the fd
+            Connection* conn = find_connection_by_key(pool->manager, events[i].data.u64);
+            if (!conn) {
+                LOG_WARN_MSG("Stale event for fd=%u", (unsigned int)(uint32_t)events[i].data.u64);
+                continue;
+            }
+            LOG_DEBUG_MSG("Event 0x%x on client fd=%d (worker %d)", events[i].events, conn->fd, worker->index);
+            
+            // Drain pending output before reading more requests
+            if (events[i].events & EPOLLOUT) {
+                flush_output(conn);
+            }
+            
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                handle_client_event(pool->manager, conn, pool->buffer_size, pool->max_request_size);
+            }
+        }
+    }
+    
+    free(events);
+    return NULL;
+}
+
+int start_io_workers(IOWorkerPool* pool, int count, ConnectionManager* manager,
+                     int max_events, int timeout_ms, int buffer_size, int max_request_size) {
+    if (!pool || count <= 0 || !manager) {
+        return -1;
+    }
+    
+    memset(pool, 0, sizeof(IOWorkerPool));
+    pool->workers = calloc(count, sizeof(IOWorker));
+    if (!pool->workers) {
+        return -1;
+    }
+    
+    pool->manager = manager;
+    pool->max_events = max_events;
+    pool->timeout_ms = timeout_ms;
+    pool->buffer_size = buffer_size;
+    pool->max_request_size = max_request_size;
+    pool->running = 1;
+    
+    for (int i = 0; i < count; i++) {
+        IOWorker* worker = &pool->workers[i];
+        worker->index = i;
+        worker->pool = pool;
+        worker->epoll_fd = setup_epoll();
+        if (worker->epoll_fd < 0) {
+            LOG_ERROR_MSG("Failed to setup epoll for I/O worker %d", i);
+            stop_io_workers(pool);
+            return -1;
+        }
+        
+        if (i == 0 && watch_stream_deadlines(worker->epoll_fd) != 0) {
+            LOG_ERROR_MSG("Failed to watch stream flush deadlines: %s", strerror(errno));
+            close(worker->epoll_fd);
+            stop_io_workers(pool);
+            return -1;
+        }
+        
+        if (pthread_create(&worker->thread, NULL, io_worker_loop, worker) != 0) {
+            LOG_ERROR_MSG("Failed to start I/O worker %d", i);
+            close(worker->epoll_fd);
+            stop_io_workers(pool);
+            return -1;
+        }
+        
+        // Only count workers whose thread is running so stop joins them
+        pool->count = i + 1;
+    }
+    
+    LOG_INFO_MSG("Started %d I/O worker threads", pool->count);
+    return 0;
+}
+
+int assign_connection_to_worker(IOWorkerPool* pool, Connection* conn) {
+    if (!pool || !conn || pool->count == 0) {
+        return -1;
+    }
+    
+    // Only the accept thread assigns, so the cursor needs no locking
+    IOWorker* worker = &pool->workers[pool->next % pool->count];
+    pool->next++;
+    
+    conn->epoll_fd = worker->epoll_fd;
+    
+    struct epoll_event client_event;
+    memset(&client_event, 0, sizeof(client_event));
+    client_event.events = EPOLLIN;
+    client_event.data.u64 = CONNECTION_EVENT_KEY(conn);
+    if (epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, conn->fd, &client_event) < 0) {
+        LOG_ERROR_MSG("Failed to add client to epoll: %s", strerror(errno));
+        return -1;
+    }
+    
+    LOG_DEBUG_MSG("Assigned fd=%d to I/O worker %d", conn->fd, worker->index);
+    return 0;
+}
+
+void stop_io_workers(IOWorkerPool* pool) {
+    if (!pool || !pool->workers) {
+        return;
+    }
+    
+    pool->running = 0;
+    
+    // Loops notice the flag within one epoll timeout
+    for (int i = 0; i < pool->count; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+        close(pool->workers[i].epoll_fd);
+    }
+    
+    free(pool->workers);
+    pool->workers = NULL;
+    pool->count = 0;
+    close_stream_deadline_fd();
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef MANAGE_IO_WORKERS_H
+#define MANAGE_IO_WORKERS_H
+
+#include <pthread.h>
+#include "../../connection/add_connection/add_connection.h"
+
+struct IOWorkerPool;
+
+/**
+ * Single epoll event loop running on its own thread
+ */
+typedef struct {
+    pthread_t thread;          // Worker thread
+    int epoll_fd;              // Epoll instance serving this worker's clients
+    int index;                 // Position in the pool
+    struct IOWorkerPool* pool; // Owning pool
+} IOWorker;
+
+/**
+ * Pool of I/O workers fed round-robin by the accept thread
+ */
+typedef struct IOWorkerPool {
+    IOWorker* workers;         // Worker array
+    int count;                 // Number of workers
+    unsigned int next;         // Round-robin cursor
+    volatile int running;      // Cleared to stop all loops
+    ConnectionManager* manager; // Shared connection manager
+    int max_events;            // Maximum epoll events per wait
+    int timeout_ms;            // Epoll wait timeout in milliseconds
+    int buffer_size;           // Minimum free space offered to each read
+    int max_request_size;      // Largest accepted request message
+} IOWorkerPool;
+
+/**
+ * Creates the worker epoll instances and starts their threads
+ * @param pool Pool to initialize
+ * @param count Number of worker threads
+ * @param manager Shared connection manager
+ * @param max_events Maximum epoll events per wait
+ * @param timeout_ms Epoll wait timeout in milliseconds
+ * @param buffer_size Minimum free space offered to each read
+ * @param max_request_size Largest accepted request message in bytes
+ * @return 0 on success, -1 on error
+ */
+int start_io_workers(IOWorkerPool* pool, int count, ConnectionManager* manager,
+                     int max_events, int timeout_ms, int buffer_size, int max_request_size);
+
+/**
+ * Hands a newly accepted connection to the next worker (round-robin)
+ * @param pool Worker pool
+ * @param conn Connection already registered in the manager
+ * @return 0 on success, -1 on error
+ */
+int assign_connection_to_worker(IOWorkerPool* pool, Connection* conn);
+
+/**
+ * Stops all worker loops and waits for their threads
+ * @param pool Worker pool
+ */
+void stop_io_workers(IOWorkerPool* pool);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,205 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "manage_npu_scheduler.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Batch jobs get a turn after this many interactive jobs in a row
+#define NPU_BATCH_TURN_INTERVAL 8
+
+// Service time assumed before any job of a kind has finished
+#define NPU_INITIAL_GENERATION_MS 2000
+#define NPU_INITIAL_OTHER_MS 50
+
+static long long get_monotonic_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+void init_npu_scheduler(NPUScheduler* scheduler, int max_queued, int quantum_ms) {
+    memset(scheduler, 0, sizeof(NPUScheduler));
+    scheduler->max_queued = max_queued > 0 ? max_queued : 1;
+    scheduler->quantum_ms = quantum_ms > 0 ? quantum_ms : 1;
+    scheduler->ewma_ms[0] = NPU_INITIAL_OTHER_MS;
+    scheduler->ewma_ms[1] = NPU_INITIAL_GENERATION_MS;
+}
+
+static NPUFlow* find_flow(NPULaneQueue* lane, Connection* conn) {
+    for (NPUFlow* flow = lane->head; flow; flow = flow->next) {
+        if (flow->conn == conn) {
+            return flow;
+        }
+    }
+    return NULL;
+}
+
+int enqueue_npu_job(NPUScheduler* scheduler, NPUJob* job, NPUQueueEstimate* estimate) {
+    if (scheduler->queued >= scheduler->max_queued) {
+        return -1;
+    }
+    
+    NPULaneQueue* lane = &scheduler->lanes[job->lane];
+    NPUFlow* flow = find_flow(lane, job->conn);
+    if (!flow) {
+        // A client joins the round at the back with an empty deficit
+        flow = calloc(1, sizeof(NPUFlow));
+        if (!flow) {
+            return -1;
+        }
+        flow->conn = job->conn;
+        if (lane->tail) {
+            lane->tail->next = flow;
+        } else {
+            lane->head = flow;
+        }
+        lane->tail = flow;
+    }
+    
+    job->cost_ms = scheduler->ewma_ms[job->is_generation ? 1 : 0];
+    job->next = NULL;
+    
+    // Higher lanes run first; within the lane each client takes turns, so
+    // roughly as many jobs of every other client run as this client has
+    // queued ahead of the new one
+    if (estimate) {
+        estimate->position = 0;
+        estimate->wait_ms = 0;
+        for (int i = 0; i < (int)job->lane; i++) {
+            estimate->position += scheduler->lanes[i].queued;
+            estimate->wait_ms += scheduler->lanes[i].queued_cost_ms;
+        }
+        
+        int turn = 1;
+        for (NPUJob* queued = flow->head; queued; queued = queued->next) {
+            turn++;
+        }
+        for (NPUFlow* other = lane->head; other; other = other->next) {
+            int limit = other == flow ? turn - 1 : turn;
+            int taken = 0;
+            for (NPUJob* queued = other->head; queued && taken < limit; queued = queued->next) {
+                estimate->position++;
+                estimate->wait_ms += queued->cost_ms;
+                taken++;
+            }
+        }
+        
+        if (scheduler->running_cost_ms > 0) {
+            long long remaining = scheduler->running_cost_ms -
+                                  (get_monotonic_ms() - scheduler->running_start_ms);
+            if (remaining > 0) {
+                estimate->wait_ms += remaining;
+            }
+        }
+    }
+    
+    if (flow->tail) {
+        flow->tail->next = job;
+    } else {
+        flow->head = job;
+    }
+    flow->tail = job;
+    
+    lane->queued++;
+    lane->queued_cost_ms += job->cost_ms;
+    scheduler->queued++;
+    return 0;
+}
+
+/**
+ * Deficit round-robin over the clients of one lane: the client at the
+ * front runs jobs while its deficit covers them, then goes to the back
+ * with a fresh quantum
+ */
+static NPUJob* dequeue_from_lane(NPULaneQueue* lane, long long quantum_ms) {
+    while (lane->head) {
+        NPUFlow* flow = lane->head;
+        NPUJob* job = flow->head;
+        
+        if (flow->deficit_ms < job->cost_ms) {
+            // The client's turn is over; its next one comes after the others
+            flow->deficit_ms += quantum_ms;
+            if (flow->next) {
+                lane->head = flow->next;
+                lane->tail->next = flow;
+                lane->tail = flow;
+                flow->next = NULL;
+                continue;
+            }
+            // Sole client: no one to yield to
+            if (flow->deficit_ms < job->cost_ms) {
+                flow->deficit_ms = job->cost_ms;
+            }
+        }
+        
+        flow->deficit_ms -= job->cost_ms;
+        flow->head = job->next;
+        job->next = NULL;
+        lane->queued--;
+        lane->queued_cost_ms -= job->cost_ms;
+        
+        if (!flow->head) {
+            // An idle client leaves the round and forfeits its deficit
+            lane->head = flow->next;
+            if (!lane->head) {
+                lane->tail = NULL;
+            }
+            free(flow);
+        }
+        return job;
+    }
+    return NULL;
+}
+
+NPUJob* next_npu_job(NPUScheduler* scheduler) {
+    if (scheduler->queued == 0) {
+        return NULL;
+    }
+    
+    NPULaneQueue* interactive = &scheduler->lanes[NPU_LANE_INTERACTIVE];
+    NPULaneQueue* batch = &scheduler->lanes[NPU_LANE_BATCH];
+    
+    NPUJob* job = NULL;
+    if (interactive->queued > 0 &&
+        (batch->queued == 0 || scheduler->interactive_streak < NPU_BATCH_TURN_INTERVAL)) {
+        job = dequeue_from_lane(interactive, scheduler->quantum_ms);
+        scheduler->interactive_streak = batch->queued > 0 ? scheduler->interactive_streak + 1 : 0;
+    } else {
+        job = dequeue_from_lane(batch, scheduler->quantum_ms);
+        scheduler->interactive_streak = 0;
+    }
+    
+    if (job) {
+        scheduler->queued--;
+        scheduler->running_cost_ms = job->cost_ms;
+        scheduler->running_start_ms = get_monotonic_ms();
+    }
+    return job;
+}
+
+void complete_npu_job(NPUScheduler* scheduler, const NPUJob* job, long long service_ms) {
+    if (service_ms < 0) {
+        service_ms = 0;
+    }
+    
+    // EWMA with weight 1/8 for the newest sample
+    long long* ewma = &scheduler->ewma_ms[job->is_generation ? 1 : 0];
+    *ewma += (service_ms - *ewma) / 8;
+    if (*ewma < 1) {
+        *ewma = 1;
+    }
+    
+    scheduler->running_cost_ms = 0;
+}
+
+NPULane get_request_lane(const JSONRPCRequest* req) {
+    json_object* priority = NULL;
+    if (req && req->params && json_object_is_type(req->params, json_type_object) &&
+        json_object_object_get_ex(req->params, "priority", &priority) &&
+        json_object_is_type(priority, json_type_string) &&
+        strcmp(json_object_get_string(priority), "batch") == 0) {
+        return NPU_LANE_BATCH;
+    }
+    return NPU_LANE_INTERACTIVE;
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#ifndef MANAGE_NPU_SCHEDULER_H
+#define MANAGE_NPU_SCHEDULER_H
+
+#include "../../jsonrpc/parse_request/parse_request.h"
+#include "../../connection/create_connection/create_connection.h"
+
+// Priority lanes; interactive jobs are served before batch jobs
+typedef enum {
+    NPU_LANE_INTERACTIVE = 0,
+    NPU_LANE_BATCH = 1,
+    NPU_LANE_COUNT = 2
+} NPULane;
+
+// Pending NPU request
+typedef struct NPUJob {
+    JSONRPCRequest* req;
+    Connection* conn;           // Retained until the job is freed
+    NPULane lane;
+    int is_generation;          // rkllm.run / rkllm.run_async
+    long long cost_ms;          // Estimated NPU time, charged to the client's deficit
+    long long enqueued_ms;      // Monotonic time the job was queued
+    struct NPUJob* next;
+} NPUJob;
+
+// Jobs of one client in one lane, scheduled by deficit round-robin
+typedef struct NPUFlow {
+    Connection* conn;
+    NPUJob* head;
+    NPUJob* tail;
+    long long deficit_ms;       // NPU time the client may still use this round
+    struct NPUFlow* next;
+} NPUFlow;
+
+// Round-robin list of clients with queued jobs in one lane
+typedef struct {
+    NPUFlow* head;
+    NPUFlow* tail;
+    int queued;                 // Jobs queued in this lane
+    long long queued_cost_ms;   // Sum of their estimated costs
+} NPULaneQueue;
+
+// Bounded, fair queue in front of the NPU; callers provide the locking
+typedef struct {
+    NPULaneQueue lanes[NPU_LANE_COUNT];
+    int queued;                 // Jobs queued in all lanes
+    int max_queued;             // Queue bound; further jobs are rejected
+    long long quantum_ms;       // Deficit added to a client per round
+    int interactive_streak;     // Interactive jobs served in a row while batch jobs waited
+    long long ewma_ms[2];       // Service time estimate: [0] other jobs, [1] generation
+    long long running_cost_ms;  // Estimated cost of the job in progress (0 = idle)
+    long long running_start_ms; // Monotonic start time of the job in progress
+} NPUScheduler;
+
+// Where a new job landed, reported to the client in the queue ack
+typedef struct {
+    int position;               // Jobs expected to run before this one
+    long long wait_ms;          // Estimated time until it starts
+} NPUQueueEstimate;
+
+/**
+ * Initializes an empty scheduler
+ * @param scheduler Scheduler to initialize
+ * @param max_queued Maximum number of queued jobs
+ * @param quantum_ms Per-round deficit of each client in milliseconds
+ */
+void init_npu_scheduler(NPUScheduler* scheduler, int max_queued, int quantum_ms);
+
+/**
+ * Queues a job behind the other jobs of its client and lane, and fills in
+ * its cost from the current service time estimate
+ * @param scheduler Scheduler
+ * @param job Job with req, conn, lane and is_generation set
+ * @param estimate Receives the queue position and wait estimate (may be NULL)
+ * @return 0 on success, -1 if the queue is full or memory ran out
+ */
+int enqueue_npu_job(NPUScheduler* scheduler, NPUJob* job, NPUQueueEstimate* estimate);
+
+/**
+ * Picks the next job: interactive lane first (with an occasional batch job
+ * so that lane cannot starve), then deficit round-robin between clients
+ * @param scheduler Scheduler
+ * @return Job (owned by the caller) or NULL if nothing is queued
+ */
+NPUJob* next_npu_job(NPUScheduler* scheduler);
+
+/**
+ * Records that the job returned by next_npu_job finished
+ * @param scheduler Scheduler
+ * @param job Finished job
+ * @param service_ms NPU time the job took
+ */
+void complete_npu_job(NPUScheduler* scheduler, const NPUJob* job, long long service_ms);
+
+/**
+ * Reads the lane a request asks for with params.priority ("interactive" or "batch")
+ * @param req Parsed request
+ * @return Requested lane, interactive by default
+ */
+NPULane get_request_lane(const JSONRPCRequest* req);
+
+#endif
\ No newline at end of file
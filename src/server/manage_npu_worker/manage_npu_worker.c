@@ -0,0 +1,206 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "manage_npu_worker.h"
+#include "../manage_npu_scheduler/manage_npu_scheduler.h"
+#include "../../jsonrpc/handle_request/handle_request.h"
+#include "../../jsonrpc/free_request/free_request.h"
+#include "../../connection/send_to_connection/send_to_connection.h"
+#include "../../connection/retain_connection/retain_connection.h"
+#include "../../connection/release_connection/release_connection.h"
+#include "../../utils/log_message/log_message.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Fair queue of pending jobs shared between I/O workers and the NPU worker
+static NPUScheduler scheduler;
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t npu_thread;
+static int npu_running = 0;
+
+// Inference still generating after its job returned (rkllm.run_async)
+static int background_work = 0;
+
+// Queue wait of the job in progress; only read on the NPU worker thread
+static long long current_wait_ms = 0;
+
+static long long get_monotonic_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static void free_job(NPUJob* job) {
+    free_request(job->req);
+    release_connection(job->conn);
+    free(job);
+}
+
+static int is_generation_method(const char* method) {
+    return strcmp(method, "rkllm.run") == 0 || strcmp(method, "rkllm.run_async") == 0;
+}
+
+/**
+ * Tells a streaming client where its request landed with an
+ * rkllm.queue_status notification, so the request's own id only carries
+ * its results; sent before any token frame because the job cannot start
+ * until the queue lock is released, which also keeps the NPU worker off
+ * the request id while it is referenced here
+ */
+static void send_queue_ack(NPUJob* job, const NPUQueueEstimate* estimate) {
+    json_object* params = json_object_new_object();
+    json_object_object_add(params, "request_id", json_object_get(job->req->id));
+    json_object_object_add(params, "queue_position", json_object_new_int(estimate->position));
+    json_object_object_add(params, "estimated_wait_ms", json_object_new_int64(estimate->wait_ms));
+    json_object_object_add(params, "priority",
+                           json_object_new_string(job->lane == NPU_LANE_BATCH ? "batch" : "interactive"));
+    
+    json_object* notification = json_object_new_object();
+    json_object_object_add(notification, "jsonrpc", json_object_new_string("2.0"));
+    json_object_object_add(notification, "method", json_object_new_string("rkllm.queue_status"));
+    json_object_object_add(notification, "params", params);
+    
+    const char* json_str = json_object_to_json_string(notification);
+    if (json_str) {
+        send_to_connection(job->conn, json_str, strlen(json_str));
+    }
+    json_object_put(notification);
+}
+
+static void* npu_worker_loop(void* arg) {
+    (void)arg;
+    
+    for (;;) {
+        pthread_mutex_lock(&queue_lock);
+        while (npu_running && scheduler.queued == 0) {
+            pthread_cond_wait(&queue_cond, &queue_lock);
+        }
+        if (!npu_running) {
+            pthread_mutex_unlock(&queue_lock);
+            break;
+        }
+        
+        NPUJob* job = next_npu_job(&scheduler);
+        pthread_mutex_unlock(&queue_lock);
+        
+        long long start_ms = get_monotonic_ms();
+        current_wait_ms = start_ms - job->enqueued_ms;
+        
+        // Skip work for clients that disconnected while queued
+        if (job->conn->is_active) {
+            LOG_DEBUG_MSG("NPU worker running %s for fd=%d", job->req->method, job->conn->fd);
+            handle_request(job->req, job->conn);
+        } else {
+            LOG_INFO_MSG("Dropping %s for disconnected fd=%d", job->req->method, job->conn->fd);
+        }
+        
+        // An async run keeps the NPU busy after its job returns; the next
+        // job starts only once it has finished
+        pthread_mutex_lock(&queue_lock);
+        while (npu_running && background_work > 0) {
+            pthread_cond_wait(&queue_cond, &queue_lock);
+        }
+        complete_npu_job(&scheduler, job, get_monotonic_ms() - start_ms);
+        pthread_mutex_unlock(&queue_lock);
+        
+        free_job(job);
+    }
+    
+    return NULL;
+}
+
+int start_npu_worker(int max_queued, int quantum_ms) {
+    pthread_mutex_lock(&queue_lock);
+    init_npu_scheduler(&scheduler, max_queued, quantum_ms);
+    background_work = 0;
+    npu_running = 1;
+    pthread_mutex_unlock(&queue_lock);
+    
+    if (pthread_create(&npu_thread, NULL, npu_worker_loop, NULL) != 0) {
+        npu_running = 0;
+        LOG_ERROR_MSG("Failed to start NPU worker thread");
+        return -1;
+    }
+    
+    return 0;
+}
+
+int submit_npu_job(JSONRPCRequest* req, Connection* conn) {
+    if (!req || !conn) {
+        return -1;
+    }
+    
+    NPUJob* job = malloc(sizeof(NPUJob));
+    if (!job) {
+        return -1;
+    }
+    
+    job->req = req;
+    job->conn = conn;
+    job->lane = get_request_lane(req);
+    job->is_generation = is_generation_method(req->method);
+    job->enqueued_ms = get_monotonic_ms();
+    
+    pthread_mutex_lock(&queue_lock);
+    NPUQueueEstimate estimate;
+    if (!npu_running || enqueue_npu_job(&scheduler, job, &estimate) != 0) {
+        if (npu_running) {
+            LOG_WARN_MSG("NPU queue full (%d jobs), rejecting %s from fd=%d",
+                         scheduler.queued, req->method, conn->fd);
+        }
+        pthread_mutex_unlock(&queue_lock);
+        free(job);
+        return -1;
+    }
+    retain_connection(conn);
+    
+    if (job->is_generation) {
+        send_queue_ack(job, &estimate);
+    }
+    
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+    
+    return 0;
+}
+
+long long get_npu_job_wait_ms(void) {
+    return current_wait_ms;
+}
+
+void begin_npu_background_work(void) {
+    pthread_mutex_lock(&queue_lock);
+    background_work++;
+    pthread_mutex_unlock(&queue_lock);
+}
+
+void end_npu_background_work(void) {
+    pthread_mutex_lock(&queue_lock);
+    if (background_work > 0) {
+        background_work--;
+    }
+    pthread_cond_broadcast(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+void stop_npu_worker(void) {
+    pthread_mutex_lock(&queue_lock);
+    if (!npu_running) {
+        pthread_mutex_unlock(&queue_lock);
+        return;
+    }
+    npu_running = 0;
+    pthread_cond_broadcast(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+    
+    // Waits for the job in progress (if any) to return
+    pthread_join(npu_thread, NULL);
+    
+    // Drop jobs that never started
+    NPUJob* job;
+    while ((job = next_npu_job(&scheduler)) != NULL) {
+        free_job(job);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef MANAGE_NPU_WORKER_H
+#define MANAGE_NPU_WORKER_H
+
+#include "../../jsonrpc/parse_request/parse_request.h"
+#include "../../connection/create_connection/create_connection.h"
+
+/**
+ * Starts the NPU worker thread that executes model-bound requests
+ * (inference, model loading) off the I/O event loops, one at a time
+ * @param max_queued Maximum number of queued requests
+ * @param quantum_ms Per-round NPU time share of each client in milliseconds
+ * @return 0 on success, -1 on error
+ */
+int start_npu_worker(int max_queued, int quantum_ms);
+
+/**
+ * Queues a request for the NPU worker in the lane named by params.priority,
+ * sharing NPU time fairly between connections. Generation requests are
+ * acknowledged with their queue position and estimated wait.
+ * On success takes ownership of the request and a reference on the connection
+ * @param req Parsed JSON-RPC request
+ * @param conn Connection that will receive the response
+ * @return 0 on success, -1 on error or full queue (request still owned by the caller)
+ */
+int submit_npu_job(JSONRPCRequest* req, Connection* conn);
+
+/**
+ * Reports how long the job the NPU worker is running waited in the queue
+ * @return Queue wait in milliseconds; only meaningful on the NPU worker thread
+ */
+long long get_npu_job_wait_ms(void);
+
+/**
+ * Marks inference that keeps running after its request returned
+ * (rkllm.run_async); the next job waits until it ends
+ */
+void begin_npu_background_work(void);
+
+/**
+ * Ends work started with begin_npu_background_work
+ */
+void end_npu_background_work(void);
+
+/**
+ * Stops the NPU worker, dropping jobs that have not started yet
+ */
+void stop_npu_worker(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "base64_encode.h"
+
+static const char base64_encode_table[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+size_t base64_encoded_length(size_t input_len) {
+    return (input_len + 2) / 3 * 4;
+}
+
+void base64_encode(const unsigned char* input, size_t input_len, char* output) {
+    size_t i = 0;
+    size_t j = 0;
+    
+    for (; i + 2 < input_len; i += 3) {
+        unsigned int triple = ((unsigned int)input[i] << 16) |
+                              ((unsigned int)input[i + 1] << 8) |
+                              input[i + 2];
+        output[j++] = base64_encode_table[(triple >> 18) & 0x3f];
+        output[j++] = base64_encode_table[(triple >> 12) & 0x3f];
+        output[j++] = base64_encode_table[(triple >> 6) & 0x3f];
+        output[j++] = base64_encode_table[triple & 0x3f];
+    }
+    
+    // One or two trailing bytes are padded with '='
+    if (i < input_len) {
+        unsigned int triple = (unsigned int)input[i] << 16;
+        if (i + 1 < input_len) {
+            triple |= (unsigned int)input[i + 1] << 8;
+        }
+        output[j++] = base64_encode_table[(triple >> 18) & 0x3f];
+        output[j++] = base64_encode_table[(triple >> 12) & 0x3f];
+        output[j++] = i + 1 < input_len ? base64_encode_table[(triple >> 6) & 0x3f] : '=';
+        output[j++] = '=';
+    }
+    
+    output[j] = '\0';
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef BASE64_ENCODE_H
+#define BASE64_ENCODE_H
+
+#include <stddef.h>
+
+/**
+ * Calculate the encoded length of binary data, without the terminator
+ * @param input_len Length of the binary data
+ * @return Number of base64 characters
+ */
+size_t base64_encoded_length(size_t input_len);
+
+/**
+ * Encode binary data as a padded base64 string
+ * @param input Binary data
+ * @param input_len Length of the binary data
+ * @param output Buffer of at least base64_encoded_length(input_len) + 1 bytes; receives a terminated string
+ */
+void base64_encode(const unsigned char* input, size_t input_len, char* output);
+
+#endif // BASE64_ENCODE_H
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "convert_float16.h"
+#include <string.h>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+static uint16_t float_to_half(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    uint32_t exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+    
+    // NaN keeps a quiet payload bit, infinity stays infinity
+    if (exponent == 0xff) {
+        return (uint16_t)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    }
+    
+    int half_exponent = (int)exponent - 127 + 15;
+    if (half_exponent >= 31) {
+        return (uint16_t)(sign | 0x7c00);
+    }
+    
+    if (half_exponent <= 0) {
+        // Subnormal half or zero
+        if (half_exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        int shift = 14 - half_exponent;
+        uint32_t half_mantissa = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half_mantissa & 1))) {
+            half_mantissa++;
+        }
+        return (uint16_t)(sign | half_mantissa);
+    }
+    
+    // A mantissa that rounds up carries into the exponent, which is the
+    // correctly rounded result up to and including infinity
+    uint32_t half = ((uint32_t)half_exponent << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fff;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        half++;
+    }
+    return (uint16_t)(sign | half);
+}
+
+void convert_to_float16(const float* input, uint16_t* output, size_t count) {
+    size_t i = 0;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    // FCVTN rounds to nearest even like the scalar path
+    for (; i + 4 <= count; i += 4) {
+        float16x4_t half = vcvt_f16_f32(vld1q_f32(input + i));
+        vst1_u16(output + i, vreinterpret_u16_f16(half));
+    }
+#endif
+    for (; i < count; i++) {
+        output[i] = float_to_half(input[i]);
+    }
+}
\ No newline at end of file
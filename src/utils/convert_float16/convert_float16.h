@@ -0,0 +1,16 @@
+#ifndef CONVERT_FLOAT16_H
+#define CONVERT_FLOAT16_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Converts float32 values to IEEE 754 half precision, rounding to
+ * nearest even; values beyond the half range become infinity
+ * @param input Values to convert
+ * @param output Receives count half-precision values
+ * @param count Number of values
+ */
+void convert_to_float16(const float* input, uint16_t* output, size_t count);
+
+#endif
\ No newline at end of file
@@ -41,4 +41,12 @@ int get_init_timeout(void) {
 
 int get_async_timeout(void) {
     return global_config ? global_config->async_timeout : 60;
+}
+
+int get_output_high_water(void) {
+    return global_config ? global_config->output_high_water : 1024 * 1024;
+}
+
+int get_output_stall_timeout_ms(void) {
+    return global_config ? global_config->output_stall_timeout_ms : 30000;
 }
\ No newline at end of file
@@ -27,5 +27,7 @@ int get_max_path_length(void);
 int get_method_name_length(void);
 int get_init_timeout(void);
 int get_async_timeout(void);
+int get_output_high_water(void);
+int get_output_stall_timeout_ms(void);
 
 #endif
\ No newline at end of file
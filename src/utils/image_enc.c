@@ -4,31 +4,7 @@
 #include <math.h>
 
 #include "image_enc.h"
-
-int read_data_from_file(const char *path, char **out_data)
-{
-    FILE *fp = fopen(path, "rb");
-    if(fp == NULL) {
-        printf("fopen %s fail!\n", path);
-        return -1;
-    }
-    fseek(fp, 0, SEEK_END);
-    int file_size = ftell(fp);
-    char *data = (char *)malloc(file_size+1);
-    data[file_size] = 0;
-    fseek(fp, 0, SEEK_SET);
-    if(file_size != fread(data, 1, file_size, fp)) {
-        printf("fread %s fail!\n", path);
-        free(data);
-        fclose(fp);
-        return -1;
-    }
-    if(fp) {
-        fclose(fp);
-    }
-    *out_data = data;
-    return file_size;
-}
+#include "map_model_file/map_model_file.h"
 
 static void dump_tensor_attr(rknn_tensor_attr* attr)
 {
@@ -43,20 +19,18 @@ int init_imgenc(const char* model_path, rknn_app_context_t* app_ctx)
 {
     int ret;
 
-    int model_len = 0;
-    char* model;
+    MappedModelFile model;
     rknn_context ctx = 0;
     int is_crypt = 0;
 
-    // Load RKNN Model
-    model_len = read_data_from_file(model_path, &model);
-    if (model == NULL) {
+    // Load RKNN Model (mapped, not copied; rknn_init keeps its own copy)
+    if (map_model_file(model_path, &model) != 0) {
         printf("load_model fail!\n");
         return -1;
     }
 
-    ret = rknn_init(&ctx, model, model_len, 0, NULL);
-    free(model);
+    ret = rknn_init(&ctx, model.data, (uint32_t)model.size, 0, NULL);
+    unmap_model_file(&model);
     if (ret < 0) {
         printf("rknn_init fail! ret=%d\n", ret);
         return -1;
@@ -0,0 +1,103 @@
+#include "map_model_file.h"
+#include "../log_message/log_message.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Readahead is issued in steps so one request does not hold the device queue
+#define PREFETCH_CHUNK_BYTES (16 * 1024 * 1024)
+
+int map_model_file(const char* path, MappedModelFile* mapped) {
+    mapped->data = NULL;
+    mapped->size = 0;
+    
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+        close(fd);
+        return -1;
+    }
+    
+    // The kernel reads pages in sequential order well ahead of the loader
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    
+    // rknn_init takes a non-const buffer; a private writable mapping lets
+    // the runtime write to it without faulting, and costs nothing unless it
+    // does (only touched pages are copied, the file is never changed)
+    void* data = mmap(NULL, (size_t)file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+    
+    madvise(data, (size_t)file_stat.st_size, MADV_SEQUENTIAL);
+    madvise(data, (size_t)file_stat.st_size, MADV_WILLNEED);
+    
+    mapped->data = data;
+    mapped->size = (size_t)file_stat.st_size;
+    return 0;
+}
+
+void unmap_model_file(MappedModelFile* mapped) {
+    if (mapped->data) {
+        munmap(mapped->data, mapped->size);
+    }
+    mapped->data = NULL;
+    mapped->size = 0;
+}
+
+static void* prefetch_thread(void* arg) {
+    char* paths = (char*)arg;
+    char* saveptr = NULL;
+    
+    for (char* path = strtok_r(paths, ":", &saveptr); path; path = strtok_r(NULL, ":", &saveptr)) {
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            LOG_WARN_MSG("Cannot prefetch model file %s", path);
+            continue;
+        }
+        
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) == 0) {
+            for (off_t offset = 0; offset < file_stat.st_size; offset += PREFETCH_CHUNK_BYTES) {
+                if (readahead(fd, offset, PREFETCH_CHUNK_BYTES) != 0) {
+                    // Not supported here (e.g. some FUSE mounts); fall back to a hint
+                    posix_fadvise(fd, offset, 0, POSIX_FADV_WILLNEED);
+                    break;
+                }
+            }
+            LOG_INFO_MSG("Prefetched model file %s (%lld bytes)", path, (long long)file_stat.st_size);
+        }
+        close(fd);
+    }
+    
+    free(paths);
+    return NULL;
+}
+
+int prefetch_model_files(const char* paths) {
+    if (!paths || paths[0] == '\0') {
+        return 0;
+    }
+    
+    char* copy = strdup(paths);
+    if (!copy) {
+        return -1;
+    }
+    
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, prefetch_thread, copy) != 0) {
+        free(copy);
+        return -1;
+    }
+    pthread_detach(thread);
+    return 0;
+}
\ No newline at end of file
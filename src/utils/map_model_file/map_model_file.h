@@ -0,0 +1,36 @@
+#ifndef MAP_MODEL_FILE_H
+#define MAP_MODEL_FILE_H
+
+#include <stddef.h>
+
+// Private (copy-on-write) mapping of a model file
+typedef struct {
+    void* data;                 // Start of the mapping (NULL if not mapped)
+    size_t size;                // File size in bytes
+} MappedModelFile;
+
+/**
+ * Maps a model file copy-on-write and asks the kernel to read it ahead
+ * sequentially, so the loader neither copies it into a heap buffer nor
+ * waits on each page fault
+ * @param path Model file path
+ * @param mapped Receives the mapping
+ * @return 0 on success, -1 if the file cannot be opened, is empty or cannot be mapped
+ */
+int map_model_file(const char* path, MappedModelFile* mapped);
+
+/**
+ * Releases a mapping made by map_model_file
+ * @param mapped Mapping (may be unmapped)
+ */
+void unmap_model_file(MappedModelFile* mapped);
+
+/**
+ * Starts a background thread that pulls the given model files into the
+ * page cache, so later loads from slow storage read from memory
+ * @param paths Colon-separated list of files (may be NULL or empty)
+ * @return 0 on success or nothing to do, -1 if the thread could not start
+ */
+int prefetch_model_files(const char* paths);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "connection/frame_requests/frame_requests.h"
+#include "buffer/manage_buffer_pool/manage_buffer_pool.h"
+#include "utils/log_message/log_message.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int failures = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        failures++; \
+    } \
+} while (0)
+
+#define READ_SIZE 4096
+#define MAX_MESSAGE_SIZE (1024 * 1024)
+
+// Messages seen by the handler, "!" for a frame that failed to parse
+static char seen[1024];
+
+static void record_message(Connection* conn, json_object* message, void* userdata) {
+    (void)conn;
+    (void)userdata;
+    const char* text = message ? json_object_to_json_string_ext(message, JSON_C_TO_STRING_PLAIN) : "!";
+    strncat(seen, text, sizeof(seen) - strlen(seen) - 2);
+    strcat(seen, " ");
+}
+
+/**
+ * Connection on one end of a socket pair; the test writes to peer
+ */
+static void open_connection(Connection* conn, int* peer) {
+    int fds[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    memset(conn, 0, sizeof(Connection));
+    conn->fd = fds[0];
+    conn->is_active = 1;
+    *peer = fds[1];
+    seen[0] = '\0';
+}
+
+static void close_connection(Connection* conn, int peer) {
+    close(peer);
+    close(conn->fd);
+    json_tokener_free(conn->tokener);
+    release_pool_buffer(conn->buffer, conn->buffer_size);
+}
+
+static int deliver(Connection* conn, int peer, const char* bytes) {
+    if (write(peer, bytes, strlen(bytes)) != (ssize_t)strlen(bytes)) {
+        return -1;
+    }
+    return frame_requests(conn, READ_SIZE, MAX_MESSAGE_SIZE, record_message, NULL);
+}
+
+// A corrupt line is reported once and the stream picks up at the next line
+static void test_resync_after_bad_line(void) {
+    Connection conn;
+    int peer;
+    open_connection(&conn, &peer);
+    CHECK(deliver(&conn, peer, "{\"a\":1}\n{bad json\n{\"b\":2}\n") == 0);
+    CHECK(strcmp(seen, "{\"a\":1} ! {\"b\":2} ") == 0);
+    
+    seen[0] = '\0';
+    CHECK(deliver(&conn, peer, "Content-Lenxth: 5\r\n{\"c\":3}\n") == 0);
+    CHECK(strcmp(seen, "! {\"c\":3} ") == 0);
+    close_connection(&conn, peer);
+}
+
+// A value split over reads is parsed once complete; values need no newline
+static void test_split_and_back_to_back(void) {
+    Connection conn;
+    int peer;
+    open_connection(&conn, &peer);
+    CHECK(deliver(&conn, peer, "{\"text\":\"hel") == 0);
+    CHECK(strcmp(seen, "") == 0);
+    CHECK(deliver(&conn, peer, "lo\"}[1,2]{\"x\":") == 0);
+    CHECK(strcmp(seen, "{\"text\":\"hello\"} [1,2] ") == 0);
+    CHECK(deliver(&conn, peer, "true}") == 0);
+    CHECK(strcmp(seen, "{\"text\":\"hello\"} [1,2] {\"x\":true} ") == 0);
+    close_connection(&conn, peer);
+}
+
+// Length-prefixed frames mix with the JSON stream, even when split
+static void test_content_length(void) {
+    Connection conn;
+    int peer;
+    open_connection(&conn, &peer);
+    CHECK(deliver(&conn, peer, "Content-Length: 7\r\n\r\n{\"c\"") == 0);
+    CHECK(strcmp(seen, "") == 0);
+    CHECK(deliver(&conn, peer, ":3}{\"d\":4}\ncontent-length: 5\n\n[1]  ") == 0);
+    CHECK(strcmp(seen, "{\"c\":3} {\"d\":4} [1] ") == 0);
+    
+    // Frames over the limit drop the connection
+    CHECK(deliver(&conn, peer, "Content-Length: 99999999\r\n\r\n") == -1);
+    close_connection(&conn, peer);
+}
+
+int main(void) {
+    set_log_level(LOG_LEVEL_ERROR);
+    test_resync_after_bad_line();
+    test_split_and_back_to_back();
+    test_content_length();
+    
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("frame requests: all checks passed\n");
+    return 0;
+}
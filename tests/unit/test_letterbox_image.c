@@ -0,0 +1,100 @@
+#include "image_processing/letterbox_image/letterbox_image.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        failures++; \
+    } \
+} while (0)
+
+// Weights of every output sum to one, so a flat image stays exactly flat
+// and the padding keeps exactly its value
+static void test_flat_image_and_padding(void) {
+    int width = 100, height = 60, channels = 3, size = 50;
+    uint8_t* src = malloc((size_t)width * height * channels);
+    uint8_t* dst = malloc((size_t)size * size * channels);
+    memset(src, 200, (size_t)width * height * channels);
+    CHECK(letterbox_image(src, width, height, channels, dst, size, 114) == 0);
+    
+    // The 60 rows sit at rows 20..79 of the 100 pixel square, 10..39 of the output
+    int wrong = 0;
+    for (int y = 0; y < size; y++) {
+        uint8_t expected = y >= 10 && y < 40 ? 200 : 114;
+        for (int i = 0; i < size * channels; i++) {
+            wrong += dst[(size_t)y * size * channels + i] != expected;
+        }
+    }
+    CHECK(wrong == 0);
+    free(src);
+    free(dst);
+}
+
+// Downscaling averages every source pixel under an output pixel
+static void test_area_average(void) {
+    const uint8_t src[16] = {
+        10, 20, 0, 0,
+        30, 40, 0, 255,
+        7, 9, 100, 100,
+        9, 7, 100, 100,
+    };
+    uint8_t dst[4];
+    CHECK(letterbox_image(src, 4, 4, 1, dst, 2, 0) == 0);
+    CHECK(dst[0] == 25);
+    CHECK(dst[1] == 64);
+    CHECK(dst[2] == 8);
+    CHECK(dst[3] == 100);
+}
+
+// An output pixel half on the padding blends the two evenly
+static void test_padding_weight(void) {
+    uint8_t src[8];
+    uint8_t dst[4];
+    memset(src, 200, sizeof(src));
+    CHECK(letterbox_image(src, 4, 2, 1, dst, 2, 100) == 0);
+    for (int i = 0; i < 4; i++) {
+        CHECK(dst[i] == 150);
+    }
+}
+
+// Same size is a copy, and upscaling a flat image stays flat
+static void test_identity_and_upscale(void) {
+    int size = 37;
+    uint8_t* src = malloc((size_t)size * size * 3);
+    uint8_t* dst = malloc((size_t)size * size * 3);
+    for (int i = 0; i < size * size * 3; i++) {
+        src[i] = (uint8_t)(i * 31 + 7);
+    }
+    CHECK(letterbox_image(src, size, size, 3, dst, size, 0) == 0);
+    CHECK(memcmp(src, dst, (size_t)size * size * 3) == 0);
+    
+    uint8_t flat[4 * 4 * 3];
+    uint8_t large[64 * 64 * 3];
+    memset(flat, 77, sizeof(flat));
+    CHECK(letterbox_image(flat, 4, 4, 3, large, 64, 0) == 0);
+    int wrong = 0;
+    for (size_t i = 0; i < sizeof(large); i++) {
+        wrong += large[i] != 77;
+    }
+    CHECK(wrong == 0);
+    free(src);
+    free(dst);
+}
+
+int main(void) {
+    test_flat_image_and_padding();
+    test_area_average();
+    test_padding_weight();
+    test_identity_and_upscale();
+    
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("letterbox: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "server/manage_npu_scheduler/manage_npu_scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int failures = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        failures++; \
+    } \
+} while (0)
+
+// The scheduler only compares connections, so they need no setup
+static Connection clients[2];
+
+static NPUJob* new_job(Connection* conn, NPULane lane, int is_generation) {
+    NPUJob* job = calloc(1, sizeof(NPUJob));
+    job->conn = conn;
+    job->lane = lane;
+    job->is_generation = is_generation;
+    return job;
+}
+
+static Connection* run_next(NPUScheduler* scheduler) {
+    NPUJob* job = next_npu_job(scheduler);
+    if (!job) {
+        return NULL;
+    }
+    Connection* conn = job->conn;
+    complete_npu_job(scheduler, job, job->cost_ms);
+    free(job);
+    return conn;
+}
+
+// Clients take turns of one quantum each, however many jobs they queued
+static void test_round_robin(void) {
+    NPUScheduler scheduler;
+    init_npu_scheduler(&scheduler, 16, 100);
+    for (int i = 0; i < 4; i++) {
+        CHECK(enqueue_npu_job(&scheduler, new_job(&clients[0], NPU_LANE_INTERACTIVE, 0), NULL) == 0);
+    }
+    for (int i = 0; i < 2; i++) {
+        CHECK(enqueue_npu_job(&scheduler, new_job(&clients[1], NPU_LANE_INTERACTIVE, 0), NULL) == 0);
+    }
+    
+    // Jobs cost 50 ms, so a 100 ms quantum covers two of them
+    Connection* expected[] = { &clients[0], &clients[0], &clients[1], &clients[1], &clients[0], &clients[0] };
+    for (int i = 0; i < 6; i++) {
+        CHECK(run_next(&scheduler) == expected[i]);
+    }
+    CHECK(run_next(&scheduler) == NULL);
+}
+
+// Interactive jobs go first, but a batch job gets a turn after eight
+static void test_batch_lane_not_starved(void) {
+    NPUScheduler scheduler;
+    init_npu_scheduler(&scheduler, 32, 100);
+    for (int i = 0; i < 12; i++) {
+        enqueue_npu_job(&scheduler, new_job(&clients[0], NPU_LANE_INTERACTIVE, 0), NULL);
+    }
+    enqueue_npu_job(&scheduler, new_job(&clients[1], NPU_LANE_BATCH, 0), NULL);
+    
+    for (int i = 0; i < 8; i++) {
+        CHECK(run_next(&scheduler) == &clients[0]);
+    }
+    CHECK(run_next(&scheduler) == &clients[1]);
+    for (int i = 0; i < 4; i++) {
+        CHECK(run_next(&scheduler) == &clients[0]);
+    }
+}
+
+// The queue bound rejects jobs, and estimates count the other client's turns
+static void test_bound_and_estimate(void) {
+    NPUScheduler scheduler;
+    init_npu_scheduler(&scheduler, 4, 100);
+    NPUQueueEstimate estimate;
+    
+    enqueue_npu_job(&scheduler, new_job(&clients[0], NPU_LANE_INTERACTIVE, 0), NULL);
+    enqueue_npu_job(&scheduler, new_job(&clients[0], NPU_LANE_INTERACTIVE, 0), NULL);
+    enqueue_npu_job(&scheduler, new_job(&clients[0], NPU_LANE_INTERACTIVE, 0), NULL);
+    CHECK(enqueue_npu_job(&scheduler, new_job(&clients[1], NPU_LANE_INTERACTIVE, 0), &estimate) == 0);
+    CHECK(estimate.position == 1);
+    CHECK(estimate.wait_ms == 50);
+    
+    NPUJob* rejected = new_job(&clients[1], NPU_LANE_INTERACTIVE, 0);
+    CHECK(enqueue_npu_job(&scheduler, rejected, NULL) == -1);
+    free(rejected);
+    while (run_next(&scheduler)) {
+    }
+}
+
+// Service times feed the cost of later jobs with weight 1/8
+static void test_service_estimate(void) {
+    NPUScheduler scheduler;
+    init_npu_scheduler(&scheduler, 4, 100);
+    NPUJob* job = new_job(&clients[0], NPU_LANE_INTERACTIVE, 0);
+    enqueue_npu_job(&scheduler, job, NULL);
+    CHECK(job->cost_ms == 50);
+    CHECK(next_npu_job(&scheduler) == job);
+    complete_npu_job(&scheduler, job, 850);
+    free(job);
+    
+    job = new_job(&clients[0], NPU_LANE_INTERACTIVE, 0);
+    enqueue_npu_job(&scheduler, job, NULL);
+    CHECK(job->cost_ms == 150);
+    NPUJob* generation = new_job(&clients[0], NPU_LANE_INTERACTIVE, 1);
+    enqueue_npu_job(&scheduler, generation, NULL);
+    CHECK(generation->cost_ms == 2000);
+    while (run_next(&scheduler)) {
+    }
+}
+
+int main(void) {
+    test_round_robin();
+    test_batch_lane_not_starved();
+    test_bound_and_estimate();
+    test_service_estimate();
+    
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("NPU scheduler: all checks passed\n");
+    return 0;
+}
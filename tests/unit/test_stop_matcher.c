@@ -0,0 +1,120 @@
+#include "rkllm/manage_stop_matcher/manage_stop_matcher.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        failures++; \
+    } \
+} while (0)
+
+// Feeds tokens one by one and collects what the client would receive
+static int run_tokens(StopMatcher* matcher, const char* const* tokens, int count, char* out, size_t out_size) {
+    out[0] = '\0';
+    for (int i = 0; i < count; i++) {
+        const char* released = NULL;
+        int found = feed_stop_matcher(matcher, tokens[i], &released);
+        strncat(out, released ? released : "", out_size - strlen(out) - 1);
+        if (found >= 0) {
+            return found;
+        }
+    }
+    int found = -1;
+    const char* rest = finish_stop_matcher(matcher, NULL, &found);
+    strncat(out, rest ? rest : "", out_size - strlen(out) - 1);
+    return found;
+}
+
+// A stop sequence split over tokens is held back until it completes
+static void test_cross_token_hold_back(void) {
+    const char* patterns[] = { "</answer>" };
+    StopMatcher* matcher = create_stop_matcher(patterns, 1);
+    CHECK(matcher != NULL);
+    
+    const char* released = NULL;
+    CHECK(feed_stop_matcher(matcher, "42 </an", &released) == -1);
+    CHECK(strcmp(released, "42 ") == 0);
+    CHECK(feed_stop_matcher(matcher, "sw", &released) == -1);
+    CHECK(strcmp(released, "") == 0);
+    CHECK(feed_stop_matcher(matcher, "er> tail", &released) == 0);
+    CHECK(strcmp(released, "") == 0);
+    free_stop_matcher(matcher);
+}
+
+// Held text that diverges is released, including bytes that restart a match
+static void test_divergence_releases(void) {
+    const char* patterns[] = { "abc" };
+    StopMatcher* matcher = create_stop_matcher(patterns, 1);
+    const char* tokens[] = { "xa", "b", "ab", "d" };
+    char out[64];
+    CHECK(run_tokens(matcher, tokens, 4, out, sizeof(out)) == -1);
+    CHECK(strcmp(out, "xababd") == 0);
+    free_stop_matcher(matcher);
+    
+    matcher = create_stop_matcher(patterns, 1);
+    const char* overlap[] = { "a", "ab", "c!" };
+    CHECK(run_tokens(matcher, overlap, 3, out, sizeof(out)) == 0);
+    CHECK(strcmp(out, "a") == 0);
+    free_stop_matcher(matcher);
+}
+
+// A sequence inside a longer one is found through the failure links
+static void test_nested_patterns(void) {
+    const char* patterns[] = { "hello world", "lo w" };
+    StopMatcher* matcher = create_stop_matcher(patterns, 2);
+    const char* tokens[] = { "say hel", "lo wor" };
+    char out[64];
+    CHECK(run_tokens(matcher, tokens, 2, out, sizeof(out)) == 1);
+    CHECK(strcmp(out, "say hel") == 0);
+    free_stop_matcher(matcher);
+}
+
+// Multibyte characters delivered a byte at a time still match
+static void test_multibyte_split(void) {
+    const char* patterns[] = { "\xe4\xba\x94" };
+    StopMatcher* matcher = create_stop_matcher(patterns, 1);
+    const char* tokens[] = { "\xe5\x9b\x9b\xe3\x80\x81\xe4", "\xba", "\x94\xe3\x80\x81" };
+    char out[64];
+    CHECK(run_tokens(matcher, tokens, 3, out, sizeof(out)) == 0);
+    CHECK(strcmp(out, "\xe5\x9b\x9b\xe3\x80\x81") == 0);
+    free_stop_matcher(matcher);
+}
+
+// Text still held at the end of a run is flushed
+static void test_finish_flushes(void) {
+    const char* patterns[] = { "STOP" };
+    StopMatcher* matcher = create_stop_matcher(patterns, 1);
+    const char* released = NULL;
+    CHECK(feed_stop_matcher(matcher, "end ST", &released) == -1);
+    CHECK(strcmp(released, "end ") == 0);
+    int found = 0;
+    const char* rest = finish_stop_matcher(matcher, "O", &found);
+    CHECK(found == -1);
+    CHECK(rest && strcmp(rest, "STO") == 0);
+    free_stop_matcher(matcher);
+    
+    matcher = create_stop_matcher(patterns, 1);
+    CHECK(feed_stop_matcher(matcher, "ST", &released) == -1);
+    rest = finish_stop_matcher(matcher, "OP", &found);
+    CHECK(found == 0);
+    CHECK(rest && strcmp(rest, "") == 0);
+    free_stop_matcher(matcher);
+}
+
+int main(void) {
+    test_cross_token_hold_back();
+    test_divergence_releases();
+    test_nested_patterns();
+    test_multibyte_split();
+    test_finish_flushes();
+    
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("stop matcher: all checks passed\n");
+    return 0;
+}